@@ -50,3 +50,60 @@ void crc32(const void* data, u64 n_bytes, u32* crc)
     
     for(u64 i = n_accum*sizeof(accum_t); i < n_bytes; ++i) *crc = table[(u8)*crc ^ ((u8*)data)[i]] ^ *crc >> 8;
 }
+
+static u32 gf2_matrix_times(const u32 *mat, u32 vec)
+{
+    u32 sum = 0;
+    
+    while(vec)
+    {
+        if (vec & 1) sum ^= *mat;
+        vec >>= 1;
+        mat++;
+    }
+    
+    return sum;
+}
+
+static void gf2_matrix_square(u32 *square, const u32 *mat)
+{
+    for(int n = 0; n < 32; n++) square[n] = gf2_matrix_times(mat, mat[n]);
+}
+
+/* Returns the CRC32 checksum of the concatenation of two blocks, given the
+ * checksum of each one of them and the length of the second block.
+ * Based on crc32Combine() from zlib. Runs in O(log(len2)) time, which makes
+ * it possible to account for long runs of constant data without hashing them. */
+u32 crc32Combine(u32 crc1, u32 crc2, u64 len2)
+{
+    u32 even[32], odd[32], row = 1;
+    
+    if (!len2) return crc1;
+    
+    /* Operator for one zero bit in odd */
+    odd[0] = (u32)0xEDB88320L;
+    for(int n = 1; n < 32; n++)
+    {
+        odd[n] = row;
+        row <<= 1;
+    }
+    
+    /* Operator for two zero bits in even, then four zero bits in odd */
+    gf2_matrix_square(even, odd);
+    gf2_matrix_square(odd, even);
+    
+    /* Apply len2 zeros to crc1 (the first square puts the operator for one zero byte, eight zero bits, in even) */
+    do {
+        gf2_matrix_square(even, odd);
+        if (len2 & 1) crc1 = gf2_matrix_times(even, crc1);
+        len2 >>= 1;
+        
+        if (!len2) break;
+        
+        gf2_matrix_square(odd, even);
+        if (len2 & 1) crc1 = gf2_matrix_times(odd, crc1);
+        len2 >>= 1;
+    } while(len2);
+    
+    return (crc1 ^ crc2);
+}
@@ -6,5 +6,6 @@
 #include <switch/types.h>
 
 void crc32(const void* data, u64 n_bytes, u32* crc);
+u32 crc32Combine(u32 crc1, u32 crc2, u64 len2);
 
 #endif
\ No newline at end of file
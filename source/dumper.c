@@ -7,6 +7,7 @@
 #include <unistd.h>
 #include <math.h>
 #include <ctype.h>
+#include <stdarg.h>
 
 #include "crc32_fast.h"
 #include "dumper.h"
@@ -15,6 +16,7 @@
 #include "nca.h"
 #include "keys.h"
 #include "save.h"
+#include "fatfs/diskio.h"
 
 /* Extern variables */
 
@@ -62,6 +64,36 @@ static void dumpStartMsg()
     breaks++;
 }
 
+// Checks the size and SHA-256 checksum of a NCA store entry against its CNMT content record. "buf" must be able to hold DUMP_BUFFER_SIZE bytes
+static bool checkNcaStoreEntry(FILE *storeFile, u64 size, const u8 *record_hash, u8 *buf)
+{
+    if (!storeFile || !record_hash || !buf) return false;
+    
+    u64 offset;
+    size_t n;
+    
+    Sha256Context hash_ctx;
+    u8 hash[SHA256_HASH_SIZE];
+    
+    fseek(storeFile, 0, SEEK_END);
+    if ((u64)ftell(storeFile) != size) return false;
+    rewind(storeFile);
+    
+    sha256ContextCreate(&hash_ctx);
+    
+    for(offset = 0; offset < size; offset += n)
+    {
+        n = ((size - offset) > DUMP_BUFFER_SIZE ? DUMP_BUFFER_SIZE : (size_t)(size - offset));
+        if (fread(buf, 1, n, storeFile) != n) return false;
+        sha256ContextUpdate(&hash_ctx, buf, n);
+    }
+    
+    sha256ContextGetHash(&hash_ctx, hash);
+    rewind(storeFile);
+    
+    return !memcmp(hash, record_hash, SHA256_HASH_SIZE);
+}
+
 bool dumpNXCardImage(xciOptions *xciDumpCfg)
 {
     if (!xciDumpCfg)
@@ -89,6 +121,11 @@ bool dumpNXCardImage(xciOptions *xciDumpCfg)
     u8 splitIndex = 0;
     u32 certCrc = 0, certlessCrc = 0;
     
+    // Everything past the trimmed size is 0xFF padding, so untrimmed dumps don't need to read it
+    bool synthPadding = false, padChunk = false;
+    u64 dataSize, sampleSize;
+    u32 padChunkCrc = 0;
+    
     memset(dumpBuf, 0, DUMP_BUFFER_SIZE);
     
     progress_ctx_t progressCtx;
@@ -197,6 +234,8 @@ bool dumpNXCardImage(xciOptions *xciDumpCfg)
         progressCtx.totalSize = gameCardInfo.trimmedSize;
     } else {
         progressCtx.totalSize = xciDataSize;
+        
+        synthPadding = (gameCardInfo.trimmedSize > 0 && gameCardInfo.trimmedSize < xciDataSize);
     }
     
     convertSize(progressCtx.totalSize, progressCtx.totalSizeStr, MAX_CHARACTERS(progressCtx.totalSizeStr));
@@ -429,17 +468,71 @@ bool dumpNXCardImage(xciOptions *xciDumpCfg)
                 }
             }
             
-            result = readGameCardStoragePartition(partitionOffset, dumpBuf, n);
-            if (R_FAILED(result))
+            // Only read the data that precedes the padding
+            dataSize = n;
+            if (synthPadding && (progressCtx.curOffset + n) > gameCardInfo.trimmedSize) dataSize = (progressCtx.curOffset < gameCardInfo.trimmedSize ? (gameCardInfo.trimmedSize - progressCtx.curOffset) : 0);
+            
+            padChunk = false;
+            
+            if (dataSize)
             {
-                uiDrawString(STRING_X_POS, STRING_Y_POS(progressCtx.line_offset + 2), FONT_COLOR_ERROR_RGB, "%s: failed to read %lu bytes chunk at offset 0x%016lX from IStorage partition #%u! (0x%08X)", __func__, n, partitionOffset, partition, result);
-                proceed = false;
-                break;
+                result = readGameCardStoragePartition(partitionOffset, dumpBuf, dataSize);
+                if (R_FAILED(result))
+                {
+                    uiDrawString(STRING_X_POS, STRING_Y_POS(progressCtx.line_offset + 2), FONT_COLOR_ERROR_RGB, "%s: failed to read %lu bytes chunk at offset 0x%016lX from IStorage partition #%u! (0x%08X)", __func__, dataSize, partitionOffset, partition, result);
+                    proceed = false;
+                    break;
+                }
+            }
+            
+            if (dataSize < n)
+            {
+                // Read a single media unit from the padding to make sure it really is made of 0xFF bytes
+                sampleSize = ((n - dataSize) > MEDIA_UNIT_SIZE ? MEDIA_UNIT_SIZE : (n - dataSize));
+                
+                result = readGameCardStoragePartition(partitionOffset + dataSize, dumpBuf + dataSize, sampleSize);
+                if (R_FAILED(result))
+                {
+                    uiDrawString(STRING_X_POS, STRING_Y_POS(progressCtx.line_offset + 2), FONT_COLOR_ERROR_RGB, "%s: failed to read %lu bytes chunk at offset 0x%016lX from IStorage partition #%u! (0x%08X)", __func__, sampleSize, partitionOffset + dataSize, partition, result);
+                    proceed = false;
+                    break;
+                }
+                
+                u64 i;
+                for(i = 0; i < sampleSize && dumpBuf[dataSize + i] == 0xFF; i++);
+                
+                if (i == sampleSize)
+                {
+                    memset(dumpBuf + dataSize + sampleSize, 0xFF, n - dataSize - sampleSize);
+                    padChunk = (!dataSize && n == DUMP_BUFFER_SIZE);
+                } else {
+                    // Unexpected data past the trimmed size. Read everything from now on
+                    synthPadding = false;
+                    
+                    if ((dataSize + sampleSize) < n)
+                    {
+                        result = readGameCardStoragePartition(partitionOffset + dataSize + sampleSize, dumpBuf + dataSize + sampleSize, n - dataSize - sampleSize);
+                        if (R_FAILED(result))
+                        {
+                            uiDrawString(STRING_X_POS, STRING_Y_POS(progressCtx.line_offset + 2), FONT_COLOR_ERROR_RGB, "%s: failed to read %lu bytes chunk at offset 0x%016lX from IStorage partition #%u! (0x%08X)", __func__, n - dataSize - sampleSize, partitionOffset + dataSize + sampleSize, partition, result);
+                            proceed = false;
+                            break;
+                        }
+                    }
+                }
             }
             
             // Remove gamecard certificate
             if (progressCtx.curOffset == 0 && !keepCert) memset(dumpBuf + CERT_OFFSET, 0xFF, CERT_SIZE);
             
+            if (calcCrc && padChunk)
+            {
+                // Full padding chunks share the same checksum, so it only has to be calculated once
+                if (!padChunkCrc) crc32(dumpBuf, n, &padChunkCrc);
+                
+                if (keepCert) certCrc = crc32Combine(certCrc, padChunkCrc, n);
+                certlessCrc = crc32Combine(certlessCrc, padChunkCrc, n);
+            } else
             if (calcCrc)
             {
                 if (!trimDump)
@@ -768,19 +861,30 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
     u8 ncaHeader[NCA_FULL_HEADER_LENGTH] = {0};
     nca_header_t dec_nca_header;
     
+    nca_content_handle_t ncaContentHandle;
+    memset(&ncaContentHandle, 0, sizeof(nca_content_handle_t));
+    
+    nca_content_read_stats_t ncaContentReadStats;
+    memset(&ncaContentReadStats, 0, sizeof(nca_content_read_stats_t));
+    
     nca_cnmt_mod_data ncaCnmtMod;
     memset(&ncaCnmtMod, 0, sizeof(nca_cnmt_mod_data));
     
     u32 ncaProgramModCnt = 0;
     nca_program_mod_data *ncaProgramMod = NULL;
     
+    pfs0_hash_ctx_t *ncaPfs0HashCtx = NULL;
+    u8 ncaPfs0MasterHash[SHA256_HASH_SIZE];
+    u64 ncaPfs0FailedOffset = 0;
+    
     title_rights_ctx rights_info;
     memset(&rights_info, 0, sizeof(title_rights_ctx));
     
     u32 cnmtNcaIndex = 0;
     u8 *cnmtNcaBuf = NULL;
     bool cnmtFound = false;
-    char *cnmtXml = NULL;
+    xml_buffer_t cnmtXml = { NULL, 0, 0, false };
+    u64 cnmtXmlSize = 0;
     
     u32 xml_rec_cnt = 0;
     xml_record_info *xml_records = NULL, *tmp_xml_rec = NULL;
@@ -797,10 +901,28 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
     u64 fullPfs0HeaderSize = 0;
     
     u8 **nspPfs0FilePtrs = NULL;
+    nacp_icons_ctx **nspPfs0IconPtrs = NULL;
     
     Sha256Context nca_hash_ctx;
     sha256ContextCreate(&nca_hash_ctx);
     
+    // Streamed NACP icons are checked against the checksums calculated for the NACP XML
+    Sha256Context icon_hash_ctx;
+    u8 iconHash[SHA256_HASH_SIZE];
+    
+    // Content-addressed NCA store, keyed by the original hash from each CNMT content record
+    // Only used if its directory exists
+    bool useNcaStore = false, ncaStoreRead = false;
+    char ncaStorePath[NAME_BUF_LEN] = {'\0'}, ncaStoreTmpPath[NAME_BUF_LEN] = {'\0'};
+    char ncaStoreHashStr[(SHA256_HASH_SIZE * 2) + 1] = {'\0'};
+    FILE *ncaStoreFile = NULL;
+    u8 ncaStoreHash[SHA256_HASH_SIZE];
+    u32 ncaStoreHits = 0, ncaStoreAdds = 0;
+    u64 ncaStoreTmpSize = 0;
+    
+    Sha256Context nca_store_hash_ctx;
+    sha256ContextCreate(&nca_store_hash_ctx);
+    
     u64 n, fileOffset;
     FILE *outFile = NULL;
     u8 splitIndex = 0;
@@ -983,6 +1105,10 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
         goto out;
     }
     
+    // Content paths resolved through a previous storage session can't be reused
+    invalidateNcaContentPathCache();
+    resetNcaContentReadStats();
+    
     // Fill information for our CNMT XML
     memset(&xml_program_info, 0, sizeof(cnmt_xml_program_info));
     xml_program_info.type = (u8)metaType;
@@ -997,6 +1123,14 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
         goto out;
     }
     
+    // Used to verify the ExeFS PFS0 partition from Program NCAs while they're being dumped
+    ncaPfs0HashCtx = calloc(titleContentInfoCnt, sizeof(pfs0_hash_ctx_t));
+    if (!ncaPfs0HashCtx)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to allocate memory for the PFS0 hash contexts!", __func__);
+        goto out;
+    }
+    
     // Fill our CNMT XML content records, leaving the CNMT NCA at the end
     u32 titleContentInfoIndex;
     for(i = 0, titleContentInfoIndex = 0; titleContentInfoIndex < titleContentInfoCnt; i++, titleContentInfoIndex++)
@@ -1047,6 +1181,9 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
             break;
         }
         
+        // Save the original PFS0 master hash, since processProgramNca() replaces it
+        memcpy(ncaPfs0MasterHash, dec_nca_header.fs_headers[0].pfs0_superblock.master_hash, SHA256_HASH_SIZE);
+        
         // Check if this particular content has a populated Rights ID field
         bool has_rights_id = false;
         
@@ -1182,6 +1319,20 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
             }
         }
         
+        // Store the PFS0 hash table parameters from the Program NCA ExeFS section, now that the NCA key area is known
+        // The NCA key area can't be used if the titlekey couldn't be retrieved, so verification is skipped in that case
+        if (xml_content_info[i].type == NcmContentType_Program && dec_nca_header.fs_headers[0].partition_type == NCA_FS_HEADER_PARTITION_PFS0 && dec_nca_header.fs_headers[0].fs_type == NCA_FS_HEADER_FSTYPE_PFS0 && dec_nca_header.fs_headers[0].crypt_type == NCA_FS_HEADER_CRYPT_CTR)
+        {
+            if (!has_rights_id || rights_info.retrieved_tik)
+            {
+                setupPfs0HashContext(&(ncaPfs0HashCtx[i]), &dec_nca_header, 0, xml_content_info[i].decrypted_nca_keys);
+                memcpy(ncaPfs0HashCtx[i].master_hash, ncaPfs0MasterHash, SHA256_HASH_SIZE);
+            } else {
+                breaks++;
+                uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "Titlekey unavailable for Program NCA \"%s\". PFS0 verification will be skipped.", xml_content_info[i].nca_id_str);
+            }
+        }
+        
         if ((!has_rights_id || (has_rights_id && rights_info.retrieved_tik)) && (xml_content_info[i].type == NcmContentType_Program || xml_content_info[i].type == NcmContentType_Control || xml_content_info[i].type == NcmContentType_LegalInformation))
         {
             // Reallocate XML records
@@ -1294,15 +1445,21 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
     
     // Generate a placeholder CNMT XML. It's length will be used to calculate the final output dump size
     
-    // Make sure that the output buffer for our CNMT XML is big enough
-    cnmtXml = calloc(NSP_XML_BUFFER_SIZE, sizeof(char));
-    if (!cnmtXml)
+    if (!xmlBufferInit(&cnmtXml))
     {
         uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to allocate memory for the CNMT XML!", __func__);
         goto out;
     }
     
-    generateCnmtXml(&xml_program_info, xml_content_info, cnmtXml);
+    generateCnmtXml(&xml_program_info, xml_content_info, &cnmtXml);
+    
+    if (cnmtXml.error)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to reallocate memory for the CNMT XML!", __func__);
+        goto out;
+    }
+    
+    cnmtXmlSize = cnmtXml.size;
     
     bool includeTikAndCert = (rights_info.retrieved_tik && !tiklessDump);
     
@@ -1391,6 +1548,14 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
         goto out;
     }
     
+    // NACP icons don't have a data pointer. They're streamed from the Control NCA using this array instead
+    nspPfs0IconPtrs = calloc(nspPfs0Header.file_cnt - (titleContentInfoCnt - 1), sizeof(nacp_icons_ctx*));
+    if (!nspPfs0IconPtrs)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to allocate memory for the PFS0 NACP icon pointer array!", __func__);
+        goto out;
+    }
+    
     // Fill PFS0 entry table
     // PFS0 string table will be filled at a later time
     u64 curFileOffset = 0;
@@ -1412,9 +1577,9 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
             if (i == cnmtNcaIndex) nspPfs0FilePtrs[ptrIdx++] = cnmtNcaBuf;
         } else {
             // Reserve the entry right after our NCAs for the CNMT XML
-            entrySize = strlen(cnmtXml);
+            entrySize = cnmtXmlSize;
             entryFilenameSize = NSP_CNMT_FILENAME_LENGTH;
-            nspPfs0FilePtrs[ptrIdx++] = (u8*)cnmtXml;
+            nspPfs0FilePtrs[ptrIdx++] = (u8*)cnmtXml.data;
         }
         
         nspPfs0EntryTable[i].file_size = entrySize;
@@ -1436,7 +1601,7 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
             {
                 entrySize = xml_records[i].nacp_icons[j].icon_size;
                 entryFilenameSize = (u32)(strlen(xml_records[i].nacp_icons[j].filename) + 1); // This is the only entry type with variable filename length
-                nspPfs0FilePtrs[ptrIdx++] = xml_records[i].nacp_icons[j].icon_data;
+                nspPfs0IconPtrs[ptrIdx++] = &(xml_records[i].nacp_icons[j]);
                 
                 nspPfs0EntryTable[entryIdx].file_size = entrySize;
                 nspPfs0EntryTable[entryIdx].file_offset = curFileOffset;
@@ -1480,7 +1645,7 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
     // Calculate total dump size
     progressCtx.totalSize += fullPfs0HeaderSize;
     for(i = 0; i < titleContentInfoCnt; i++) progressCtx.totalSize += xml_content_info[i].size;
-    progressCtx.totalSize += strlen(cnmtXml);
+    progressCtx.totalSize += cnmtXmlSize;
     if (includeTikAndCert) progressCtx.totalSize += (ETICKET_TIK_FILE_SIZE + ETICKET_CERT_FILE_SIZE);
     
     convertSize(progressCtx.totalSize, progressCtx.totalSizeStr, MAX_CHARACTERS(progressCtx.totalSizeStr));
@@ -1811,6 +1976,9 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
     
     dumping = true;
     
+    // Sequential dumps can't resume reads from the NCA store, so they don't use it
+    useNcaStore = (!seqDumpMode && checkIfDirectoryExists(NCA_STORE_PATH));
+    
     u32 startFileIndex = (seqDumpMode ? seqNspCtx.fileIndex : 0);
     u64 startFileOffset;
     
@@ -1834,6 +2002,18 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
                 // Copy NCA ID
                 memcpy(ncaId.c, xml_content_info[i].nca_id, SHA256_HASH_SIZE / 2);
                 
+                // Resolve the content path only once for this NCA
+                breaks = (progressCtx.line_offset + 2);
+                
+                proceed = openNcaContentHandle(&ncmStorage, &ncaId, &ncaContentHandle);
+                if (!proceed)
+                {
+                    dumping = false;
+                    break;
+                }
+                
+                breaks = (progressCtx.line_offset - 4);
+                
                 // Reset SHA-256 context if necessary
                 if (!seqDumpMode || (seqDumpMode && i != seqNspCtx.fileIndex)) sha256ContextCreate(&nca_hash_ctx);
                 
@@ -1849,6 +2029,42 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
                         }
                     }
                 }
+                
+                // Read this NCA from the store if it's already there. Otherwise, add it while dumping
+                if (useNcaStore && (!isFat32 || xml_content_info[i].size <= FAT32_FILESIZE_LIMIT))
+                {
+                    convertDataToHexString(xml_content_info[i].record_hash, SHA256_HASH_SIZE, ncaStoreHashStr, (SHA256_HASH_SIZE * 2) + 1);
+                    snprintf(ncaStorePath, MAX_CHARACTERS(ncaStorePath), "%s%s.nca", NCA_STORE_PATH, ncaStoreHashStr);
+                    snprintf(ncaStoreTmpPath, MAX_CHARACTERS(ncaStoreTmpPath), "%s.tmp", ncaStorePath);
+                    
+                    ncaStoreFile = fopen(ncaStorePath, "rb");
+                    if (ncaStoreFile)
+                    {
+                        uiFill(0, ((progressCtx.line_offset - 2) * LINE_HEIGHT) + 8, FB_WIDTH, LINE_HEIGHT, BG_COLOR_RGB);
+                        uiDrawString(STRING_X_POS, STRING_Y_POS(progressCtx.line_offset - 2), FONT_COLOR_RGB, "Verifying stored NCA \"%s\"...", xml_content_info[i].nca_id_str);
+                        uiRefreshDisplay();
+                        
+                        // A bad store entry is removed and the NCA is dumped from its content storage as usual
+                        ncaStoreRead = checkNcaStoreEntry(ncaStoreFile, xml_content_info[i].size, xml_content_info[i].record_hash, dumpBuf);
+                        if (!ncaStoreRead)
+                        {
+                            fclose(ncaStoreFile);
+                            ncaStoreFile = NULL;
+                            remove(ncaStorePath);
+                        }
+                    }
+                    
+                    // New store entries take up additional space, so only create them if the rest of the NSP still fits alongside them
+                    if (!ncaStoreFile && (progressCtx.totalSize + ncaStoreTmpSize + xml_content_info[i].size) <= freeSpace)
+                    {
+                        ncaStoreFile = fopen(ncaStoreTmpPath, "wb");
+                        if (ncaStoreFile)
+                        {
+                            ncaStoreTmpSize += xml_content_info[i].size;
+                            sha256ContextCreate(&nca_store_hash_ctx);
+                        }
+                    }
+                }
             } else {
                 // Patch CNMT NCA
                 breaks = (progressCtx.line_offset + 2);
@@ -1863,7 +2079,17 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
                 breaks = (progressCtx.line_offset - 4);
                 
                 // Generate proper CNMT XML
-                generateCnmtXml(&xml_program_info, xml_content_info, cnmtXml);
+                // Its length must match the placeholder, which also guarantees the buffer isn't moved (its address is already in the PFS0 file data pointer array)
+                xmlBufferClear(&cnmtXml);
+                generateCnmtXml(&xml_program_info, xml_content_info, &cnmtXml);
+                
+                if (cnmtXml.error || cnmtXml.size != cnmtXmlSize)
+                {
+                    uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: CNMT XML size mismatch! (0x%016lX != 0x%016lX)", __func__, cnmtXml.size, cnmtXmlSize);
+                    proceed = false;
+                    dumping = false;
+                    break;
+                }
                 
                 // Fill PFS0 string table
                 // This is done here because we'll need to display filenames for the rest of the PFS0 entries starting with the next loop iteration
@@ -1929,7 +2155,7 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
             
             if (i < titleContentInfoCnt)
             {
-                uiDrawString(STRING_X_POS, STRING_Y_POS(progressCtx.line_offset - 2), FONT_COLOR_RGB, "Dumping NCA \"%s\" (%s)...", xml_content_info[i].nca_id_str, getContentType(xml_content_info[i].type));
+                uiDrawString(STRING_X_POS, STRING_Y_POS(progressCtx.line_offset - 2), FONT_COLOR_RGB, "Dumping NCA \"%s\" (%s)%s...", xml_content_info[i].nca_id_str, getContentType(xml_content_info[i].type), (ncaStoreRead ? " from the NCA store" : ""));
             } else {
                 uiDrawString(STRING_X_POS, STRING_Y_POS(progressCtx.line_offset - 2), FONT_COLOR_RGB, "Writing \"%s\"...", entryFilename);
             }
@@ -1958,13 +2184,60 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
             {
                 breaks = (progressCtx.line_offset + 2);
                 
-                proceed = readNcaDataByContentId(&ncmStorage, &ncaId, fileOffset, dumpBuf, n);
-                if (!proceed)
+                // Fall back to the content storage if the stored NCA can't be read
+                if (ncaStoreRead && fread(dumpBuf, 1, n, ncaStoreFile) != n)
                 {
-                    breaks++;
-                    uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: failed to read %lu bytes chunk at offset 0x%016lX from NCA \"%s\"!", __func__, n, fileOffset, xml_content_info[i].nca_id_str);
-                    dumping = false;
-                    break;
+                    fclose(ncaStoreFile);
+                    ncaStoreFile = NULL;
+                    ncaStoreRead = false;
+                    remove(ncaStorePath);
+                }
+                
+                if (!ncaStoreRead)
+                {
+                    proceed = readNcaContentHandle(&ncaContentHandle, fileOffset, dumpBuf, n);
+                    if (!proceed)
+                    {
+                        breaks++;
+                        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: failed to read %lu bytes chunk at offset 0x%016lX from NCA \"%s\"!", __func__, n, fileOffset, xml_content_info[i].nca_id_str);
+                        dumping = false;
+                        break;
+                    }
+                    
+                    // Adding the NCA to the store is optional, so a write failure just discards the new entry
+                    if (ncaStoreFile && fwrite(dumpBuf, 1, n, ncaStoreFile) != n)
+                    {
+                        fclose(ncaStoreFile);
+                        ncaStoreFile = NULL;
+                        remove(ncaStoreTmpPath);
+                        ncaStoreTmpSize -= xml_content_info[i].size;
+                    }
+                    
+                    // Hash the unmodified NCA data to validate the new store entry
+                    if (ncaStoreFile) sha256ContextUpdate(&nca_store_hash_ctx, dumpBuf, n);
+                }
+                
+                // Verify the ExeFS PFS0 partition from Program NCAs before replacing any data
+                if (ncaPfs0HashCtx[i].block_size)
+                {
+                    if (!ncaPfs0HashCtx[i].initialized)
+                    {
+                        proceed = initPfs0HashContext(&ncmStorage, &ncaId, &(ncaPfs0HashCtx[i]));
+                        if (!proceed)
+                        {
+                            dumping = false;
+                            break;
+                        }
+                    }
+                    
+                    if (!verifyPfs0SectionBlock(&ncmStorage, &ncaId, &(ncaPfs0HashCtx[i]), fileOffset, dumpBuf, n, true, &ncaPfs0FailedOffset))
+                    {
+                        breaks++;
+                        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: PFS0 verification failed for NCA \"%s\" at data block #%lu (NCA offset 0x%016lX)!", __func__, xml_content_info[i].nca_id_str, (ncaPfs0FailedOffset - ncaPfs0HashCtx[i].pfs0_offset) / ncaPfs0HashCtx[i].block_size, ncaPfs0FailedOffset);
+                        proceed = false;
+                        dumping = false;
+                        break;
+                    }
                 }
                 
                 breaks = (progressCtx.line_offset - 4);
@@ -2024,9 +2297,50 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
                 // Update SHA-256 calculation
                 sha256ContextUpdate(&nca_hash_ctx, dumpBuf, n);
             } else {
-                // Copy data using pointer array
                 u32 ptrIdx = (i - (titleContentInfoCnt - 1));
-                memcpy(dumpBuf, nspPfs0FilePtrs[ptrIdx] + fileOffset, n);
+                
+                if (nspPfs0IconPtrs[ptrIdx])
+                {
+                    // Read NACP icon data straight from the Control NCA
+                    nacp_icons_ctx *icon = nspPfs0IconPtrs[ptrIdx];
+                    
+                    breaks = (progressCtx.line_offset + 2);
+                    
+                    proceed = processNcaCtrSectionBlock(&ncmStorage, &(icon->nca_id), &(icon->aes_ctx), icon->icon_offset + fileOffset, dumpBuf, n, false);
+                    if (!proceed)
+                    {
+                        breaks++;
+                        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: failed to read %lu bytes chunk at offset 0x%016lX from NACP icon \"%s\"!", __func__, n, fileOffset, entryFilename);
+                        dumping = false;
+                        break;
+                    }
+                    
+                    // Icons are only verified if they're read from the start, which isn't the case if a sequential dump is resumed halfway through one
+                    if (!startFileOffset)
+                    {
+                        if (!fileOffset) sha256ContextCreate(&icon_hash_ctx);
+                        sha256ContextUpdate(&icon_hash_ctx, dumpBuf, n);
+                        
+                        if ((fileOffset + n) >= icon->icon_size)
+                        {
+                            sha256ContextGetHash(&icon_hash_ctx, iconHash);
+                            
+                            if (memcmp(iconHash, icon->icon_hash, SHA256_HASH_SIZE) != 0)
+                            {
+                                breaks++;
+                                uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: checksum mismatch for NACP icon \"%s\" read from the Control NCA!", __func__, entryFilename);
+                                proceed = false;
+                                dumping = false;
+                                break;
+                            }
+                        }
+                    }
+                    
+                    breaks = (progressCtx.line_offset - 4);
+                } else {
+                    // Copy data using pointer array
+                    memcpy(dumpBuf, nspPfs0FilePtrs[ptrIdx] + fileOffset, n);
+                }
             }
             
             if ((seqDumpMode || (!seqDumpMode && progressCtx.totalSize > FAT32_FILESIZE_LIMIT && isFat32)) && (progressCtx.curOffset + n) >= ((splitIndex + 1) * partSize))
@@ -2123,6 +2437,32 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
         // Check if we're not dealing with the CNMT NCA
         if (i < (titleContentInfoCnt - 1))
         {
+            // The hash table is no longer needed
+            freePfs0HashContext(&(ncaPfs0HashCtx[i]));
+            
+            // Stored NCAs were already validated before being used. New entries are validated against the CNMT content record
+            if (ncaStoreFile)
+            {
+                fclose(ncaStoreFile);
+                ncaStoreFile = NULL;
+                
+                if (ncaStoreRead)
+                {
+                    ncaStoreRead = false;
+                    ncaStoreHits++;
+                } else {
+                    sha256ContextGetHash(&nca_store_hash_ctx, ncaStoreHash);
+                    
+                    if (!memcmp(ncaStoreHash, xml_content_info[i].record_hash, SHA256_HASH_SIZE) && !rename(ncaStoreTmpPath, ncaStorePath))
+                    {
+                        ncaStoreAdds++;
+                    } else {
+                        remove(ncaStoreTmpPath);
+                        ncaStoreTmpSize -= xml_content_info[i].size;
+                    }
+                }
+            }
+            
             // Update content info
             sha256ContextGetHash(&nca_hash_ctx, xml_content_info[i].hash);
             convertDataToHexString(xml_content_info[i].hash, SHA256_HASH_SIZE, xml_content_info[i].hash_str, (SHA256_HASH_SIZE * 2) + 1);
@@ -2258,6 +2598,12 @@ int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleInde
 out:
     if (outFile) fclose(outFile);
     
+    if (ncaStoreFile)
+    {
+        fclose(ncaStoreFile);
+        if (!ncaStoreRead) remove(ncaStoreTmpPath);
+    }
+    
     if (ret >= 0)
     {
         if (seqDumpMode)
@@ -2319,6 +2665,16 @@ out:
             
             formatETAString(progressCtx.now, progressCtx.etaInfo, MAX_CHARACTERS(progressCtx.etaInfo));
             uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_SUCCESS_RGB, "Process successfully completed after %s!", progressCtx.etaInfo);
+            
+            getNcaContentReadStats(&ncaContentReadStats);
+            breaks++;
+            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "NCA reads: %lu | Content path lookups: %lu (%lu lookups saved).", ncaContentReadStats.reads, ncaContentReadStats.path_lookups, (ncaContentReadStats.reads > ncaContentReadStats.path_lookups ? (ncaContentReadStats.reads - ncaContentReadStats.path_lookups) : 0));
+            
+            if (useNcaStore)
+            {
+                breaks++;
+                uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "NCA store: %u NCA(s) read from the store, %u NCA(s) added to it.", ncaStoreHits, ncaStoreAdds);
+            }
             uiRefreshDisplay();
             
             // Only perform the checksum lookup if we have finished the dump process
@@ -2400,11 +2756,13 @@ out:
     
     if (nspPfs0FilePtrs) free(nspPfs0FilePtrs);
     
+    if (nspPfs0IconPtrs) free(nspPfs0IconPtrs);
+    
     if (nspPfs0StrTable) free(nspPfs0StrTable);
     
     if (nspPfs0EntryTable) free(nspPfs0EntryTable);
     
-    if (cnmtXml) free(cnmtXml);
+    xmlBufferFree(&cnmtXml);
     
     if (cnmtNcaBuf) free(cnmtNcaBuf);
     
@@ -2420,6 +2778,12 @@ out:
         free(ncaProgramMod);
     }
     
+    if (ncaPfs0HashCtx)
+    {
+        for(i = 0; i < titleContentInfoCnt; i++) freePfs0HashContext(&(ncaPfs0HashCtx[i]));
+        free(ncaPfs0HashCtx);
+    }
+    
     if (xml_records)
     {
         for(i = 0; i < xml_rec_cnt; i++)
@@ -2460,6 +2824,17 @@ int batchEntryCmp(const void *a, const void *b)
 	return strcasecmp(batchEntry1->nspFilename, batchEntry2->nspFilename);
 }
 
+int batchEntryDumpOrderCmp(const void *a, const void *b)
+{
+	batchEntry *batchEntry1 = *((batchEntry**)a);
+	batchEntry *batchEntry2 = *((batchEntry**)b);
+	
+	// Biggest titles go first
+	if (batchEntry1->contentSize != batchEntry2->contentSize) return (batchEntry1->contentSize > batchEntry2->contentSize ? -1 : 1);
+	
+	return strcasecmp(batchEntry1->nspFilename, batchEntry2->nspFilename);
+}
+
 int dumpNintendoSubmissionPackageBatch(batchOptions *batchDumpCfg)
 {
     int ret = -1;
@@ -2511,6 +2886,16 @@ int dumpNintendoSubmissionPackageBatch(batchOptions *batchDumpCfg)
     u32 maxEntryCount = 0, batchEntryIndex = 0, disabledEntryCount = 0;
     batchEntry *batchEntries = NULL, *tmpBatchEntries = NULL;
     
+    // The summary list is sorted by name, but titles are dumped by size
+    batchEntry **dumpOrder = NULL;
+    u64 batchTotalSize = 0, batchDumpedSize = 0;
+    char batchTotalSizeStr[32] = {'\0'}, batchDumpedSizeStr[32] = {'\0'};
+    
+    // Override files and previous dumps are looked up in directory listings retrieved once per batch run
+    dir_filename_index overrideIndex, dumpedIndex;
+    memset(&overrideIndex, 0, sizeof(dir_filename_index));
+    memset(&dumpedIndex, 0, sizeof(dir_filename_index));
+    
     bool proceed = true;
     
     // Generate NSP configuration struct
@@ -2537,6 +2922,13 @@ int dumpNintendoSubmissionPackageBatch(batchOptions *batchDumpCfg)
         return ret;
     }
     
+    if (!buildDirectoryFilenameIndex(BATCH_OVERRIDES_PATH, &overrideIndex) || (skipDumpedTitles && !buildDirectoryFilenameIndex(NSP_DUMP_PATH, &dumpedIndex)))
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to list previously dumped titles!", __func__);
+        breaks += 2;
+        goto out;
+    }
+    
     for(i = 0; i < 3; i++)
     {
         if ((i == 0 && !dumpAppTitles) || (i == 1 && !dumpPatchTitles) || (i == 2 && !dumpAddOnTitles)) continue;
@@ -2580,7 +2972,7 @@ int dumpNintendoSubmissionPackageBatch(batchOptions *batchDumpCfg)
             // Check if an override file already exists for this dump
             snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s%s.nsp", BATCH_OVERRIDES_PATH, dumpName);
             
-            if (checkIfFileExists(strbuf))
+            if (checkDirectoryFilenameIndex(&overrideIndex, strrchr(strbuf, '/') + 1))
             {
                 free(dumpName);
                 dumpName = NULL;
@@ -2611,7 +3003,7 @@ int dumpNintendoSubmissionPackageBatch(batchOptions *batchDumpCfg)
             free(dumpName);
             dumpName = NULL;
             
-            if (skipDumpedTitles && checkIfFileExists(strbuf)) continue;
+            if (skipDumpedTitles && checkDirectoryFilenameIndex(&dumpedIndex, strrchr(strbuf, '/') + 1)) continue;
             
             // Save title properties
             batchEntries[batchEntryIndex].enabled = true;
@@ -2637,6 +3029,9 @@ int dumpNintendoSubmissionPackageBatch(batchOptions *batchDumpCfg)
         }
     }
     
+    freeDirectoryFilenameIndex(&overrideIndex);
+    freeDirectoryFilenameIndex(&dumpedIndex);
+    
     // Calculate total title count
     totalTitleCount = (totalAppCount + totalPatchCount + totalAddOnCount);
     if (!totalTitleCount)
@@ -2921,12 +3316,31 @@ int dumpNintendoSubmissionPackageBatch(batchOptions *batchDumpCfg)
         goto out;
     }
     
-    // Calculate the disabled entry count
+    dumpOrder = calloc(totalTitleCount, sizeof(batchEntry*));
+    if (!dumpOrder)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to allocate memory for the batch dump order!", __func__);
+        breaks += 2;
+        goto out;
+    }
+    
+    // Calculate the disabled entry count and the total dump size
     for(i = 0; i < totalTitleCount; i++)
     {
-        if (!batchEntries[i].enabled) disabledEntryCount++;
+        if (!batchEntries[i].enabled)
+        {
+            disabledEntryCount++;
+            continue;
+        }
+        
+        dumpOrder[i - disabledEntryCount] = &(batchEntries[i]);
+        batchTotalSize += batchEntries[i].contentSize;
     }
     
+    qsort(dumpOrder, totalTitleCount - disabledEntryCount, sizeof(batchEntry*), batchEntryDumpOrderCmp);
+    
+    convertSize(batchTotalSize, batchTotalSizeStr, MAX_CHARACTERS(batchTotalSizeStr));
+    
     // Start dump process
     dumpStartMsg();
     uiRefreshDisplay();
@@ -2936,17 +3350,19 @@ int dumpNintendoSubmissionPackageBatch(batchOptions *batchDumpCfg)
     
     initial_breaks = breaks;
     
-    j = 0;
-    
-    for(i = 0; i < totalTitleCount; i++)
+    for(j = 0; j < (totalTitleCount - disabledEntryCount); j++)
     {
-        if (!batchEntries[i].enabled) continue;
+        batchEntry *curEntry = dumpOrder[j];
         
         breaks = initial_breaks;
         
         uiFill(0, 8 + (breaks * LINE_HEIGHT), FB_WIDTH, FB_HEIGHT - (8 + (breaks * LINE_HEIGHT)), BG_COLOR_RGB);
         
-        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "Title: %.*s [%u / %u].", strlen(batchEntries[i].nspFilename) - 4, batchEntries[i].nspFilename, j + 1, totalTitleCount - disabledEntryCount);
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "Title: %.*s [%u / %u].", strlen(curEntry->nspFilename) - 4, curEntry->nspFilename, j + 1, totalTitleCount - disabledEntryCount);
+        breaks++;
+        
+        convertSize(batchDumpedSize, batchDumpedSizeStr, MAX_CHARACTERS(batchDumpedSizeStr));
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "Batch progress: %s / %s (%.2f%%).", batchDumpedSizeStr, batchTotalSizeStr, (batchTotalSize ? (((double)batchDumpedSize * 100.0) / (double)batchTotalSize) : 0.0));
         breaks++;
         
         uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "Free SD card space: %s (%lu bytes).", freeSpaceStr, freeSpace);
@@ -2955,13 +3371,13 @@ int dumpNintendoSubmissionPackageBatch(batchOptions *batchDumpCfg)
         uiRefreshDisplay();
         
         // Dump title
-        int nspRet = dumpNintendoSubmissionPackage(batchEntries[i].titleType, batchEntries[i].titleIndex, &nspDumpCfg, true);
+        int nspRet = dumpNintendoSubmissionPackage(curEntry->titleType, curEntry->titleIndex, &nspDumpCfg, true);
         if (nspRet >= 0)
         {
             // Create override file if necessary
             if (rememberDumpedTitles)
             {
-                snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s%s", BATCH_OVERRIDES_PATH, batchEntries[i].nspFilename);
+                snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s%s", BATCH_OVERRIDES_PATH, curEntry->nspFilename);
                 FILE *overrideFile = fopen(strbuf, "wb");
                 if (overrideFile) fclose(overrideFile);
             }
@@ -2975,10 +3391,11 @@ int dumpNintendoSubmissionPackageBatch(batchOptions *batchDumpCfg)
             }
         }
         
+        // Titles that failed without halting the process are accounted for too
+        batchDumpedSize += curEntry->contentSize;
+        
         // Update free space
         updateFreeSpace();
-        
-        j++;
     }
     
     uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_SUCCESS_RGB, "Process successfully completed!");
@@ -2987,6 +3404,11 @@ int dumpNintendoSubmissionPackageBatch(batchOptions *batchDumpCfg)
     ret = 0;
     
 out:
+    freeDirectoryFilenameIndex(&overrideIndex);
+    freeDirectoryFilenameIndex(&dumpedIndex);
+    
+    if (dumpOrder) free(dumpOrder);
+    
     if (batchEntries) free(batchEntries);
     
     changeHomeButtonBlockStatus(false);
@@ -2994,7 +3416,81 @@ out:
     return ret;
 }
 
-bool dumpRawHfs0Partition(u32 partition, bool doSplitting)
+static void initHashFailureLog(hash_failure_log_t *failureLog, const char *dumpPath)
+{
+    memset(failureLog, 0, sizeof(hash_failure_log_t));
+    snprintf(failureLog->path, MAX_CHARACTERS(failureLog->path), "%s" HASH_FAILURE_LOG_SUFFIX, dumpPath);
+    
+    // Don't leave a log from a previous dump around
+    remove(failureLog->path);
+}
+
+static void addHashFailureLogEntry(hash_failure_log_t *failureLog, const char *fmt, ...)
+{
+    if (!failureLog) return;
+    
+    failureLog->cnt++;
+    
+    if (!failureLog->file) failureLog->file = fopen(failureLog->path, "w");
+    if (!failureLog->file) return;
+    
+    va_list args;
+    va_start(args, fmt);
+    vfprintf(failureLog->file, fmt, args);
+    va_end(args);
+    
+    fputc('\n', failureLog->file);
+}
+
+static void closeHashFailureLog(hash_failure_log_t *failureLog, bool discard)
+{
+    if (failureLog->file)
+    {
+        fclose(failureLog->file);
+        failureLog->file = NULL;
+    }
+    
+    if (discard) remove(failureLog->path);
+}
+
+static void printHashFailureLogSummary(hash_failure_log_t *failureLog, const char *hashType)
+{
+    breaks++;
+    uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "Warning: %u file(s) failed %s verification! The last one is shown below.", failureLog->cnt, hashType);
+    breaks++;
+    uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "All of them have been listed in \"%s\".", strrchr(failureLog->path, '/') + 1);
+    breaks++;
+}
+
+static void printHfs0HashResults(u32 partition, hfs0_hash_ctx_t *hashCtx)
+{
+    if (!gameCardInfo.hfs0Partitions[partition].header_hash_valid)
+    {
+        breaks++;
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s HFS0 partition header hash mismatch!", GAMECARD_PARTITION_NAME(gameCardInfo.hfs0PartitionCnt, partition));
+    }
+    
+    if (!hashCtx || !hashCtx->files) return;
+    
+    breaks++;
+    
+    if (hashCtx->failed_cnt)
+    {
+        hfs0_file_entry entry;
+        memcpy(&entry, gameCardInfo.hfs0Partitions[partition].header + sizeof(hfs0_header) + (hashCtx->first_failed_index * sizeof(hfs0_file_entry)), sizeof(hfs0_file_entry));
+        char *filename = (char*)(gameCardInfo.hfs0Partitions[partition].header + sizeof(hfs0_header) + (gameCardInfo.hfs0Partitions[partition].file_cnt * sizeof(hfs0_file_entry)) + entry.filename_offset);
+        
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "HFS0 hashed region mismatch in %u of %u file(s)! First bad file: \"%s\".", hashCtx->failed_cnt, hashCtx->file_cnt, filename);
+    } else
+    if (hashCtx->verified_cnt < hashCtx->file_cnt)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "HFS0 hashed regions only verified for %u of %u file(s).", hashCtx->verified_cnt, hashCtx->file_cnt);
+    } else {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_SUCCESS_RGB, "HFS0 hashed regions successfully verified for %u file(s).", hashCtx->verified_cnt);
+    }
+}
+
+bool dumpRawHfs0Partition(u32 partition, bool doSplitting, bool verifyHashes)
 {
     if (!gameCardInfo.rootHfs0Header || !gameCardInfo.hfs0PartitionCnt || partition >= gameCardInfo.hfs0PartitionCnt || !gameCardInfo.hfs0Partitions || !gameCardInfo.hfs0Partitions[partition].size)
     {
@@ -3012,6 +3508,9 @@ bool dumpRawHfs0Partition(u32 partition, bool doSplitting)
     u8 splitIndex = 0;
     openIStoragePartition storageIndex;
     
+    hfs0_hash_ctx_t hashCtx;
+    memset(&hashCtx, 0, sizeof(hfs0_hash_ctx_t));
+    
     memset(dumpBuf, 0, DUMP_BUFFER_SIZE);
     
     progress_ctx_t progressCtx;
@@ -3048,7 +3547,13 @@ bool dumpRawHfs0Partition(u32 partition, bool doSplitting)
         goto out;
     }
     
-    if (progressCtx.totalSize > FAT32_FILESIZE_LIMIT && doSplitting)
+    if (verifyHashes && gameCardInfo.hfs0Partitions[partition].file_cnt && !initHfs0HashContext(partition, &hashCtx))
+    {
+        breaks += 2;
+        goto out;
+    }
+    
+    if (progressCtx.totalSize > FAT32_FILESIZE_LIMIT && doSplitting)
     {
         snprintf(dumpPath, MAX_CHARACTERS(dumpPath), "%s%s - Partition %u (%s).hfs0.%02u", HFS0_DUMP_PATH, dumpName, partition, GAMECARD_PARTITION_NAME(gameCardInfo.hfs0PartitionCnt, partition), splitIndex);
     } else {
@@ -3112,6 +3617,8 @@ bool dumpRawHfs0Partition(u32 partition, bool doSplitting)
             break;
         }
         
+        if (verifyHashes) updateHfs0HashContext(&hashCtx, progressCtx.curOffset, dumpBuf, n);
+        
         if (progressCtx.totalSize > FAT32_FILESIZE_LIMIT && doSplitting && (progressCtx.curOffset + n) >= ((splitIndex + 1) * SPLIT_FILE_GENERIC_PART_SIZE))
         {
             u64 new_file_chunk_size = ((progressCtx.curOffset + n) - ((splitIndex + 1) * SPLIT_FILE_GENERIC_PART_SIZE));
@@ -3200,6 +3707,8 @@ bool dumpRawHfs0Partition(u32 partition, bool doSplitting)
         
         formatETAString(progressCtx.now, progressCtx.etaInfo, MAX_CHARACTERS(progressCtx.etaInfo));
         uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_SUCCESS_RGB, "Process successfully completed after %s!", progressCtx.etaInfo);
+        
+        if (verifyHashes) printHfs0HashResults(partition, &hashCtx);
     } else {
         setProgressBarError(&progressCtx);
         if (fat32_error) breaks += 2;
@@ -3208,6 +3717,8 @@ bool dumpRawHfs0Partition(u32 partition, bool doSplitting)
 out:
     if (outFile) fclose(outFile);
     
+    freeHfs0HashContext(&hashCtx);
+    
     if (!success)
     {
         if (progressCtx.totalSize > FAT32_FILESIZE_LIMIT && doSplitting)
@@ -3233,7 +3744,7 @@ out:
     return success;
 }
 
-bool copyFileFromHfs0Partition(u32 partition, const char *dest, const char *source, const u64 fileOffset, const u64 fileSize, progress_ctx_t *progressCtx, bool doSplitting)
+bool copyFileFromHfs0Partition(u32 partition, const char *dest, const char *source, const u64 fileOffset, const u64 fileSize, progress_ctx_t *progressCtx, bool doSplitting, hfs0_hash_ctx_t *hashCtx)
 {
     if (!gameCardInfo.rootHfs0Header || !gameCardInfo.hfs0PartitionCnt || partition >= gameCardInfo.hfs0PartitionCnt || !gameCardInfo.hfs0Partitions || !gameCardInfo.hfs0Partitions[partition].header || !gameCardInfo.hfs0Partitions[partition].header_size || !dest || !strlen(dest) || !source || !strlen(source) || !progressCtx)
     {
@@ -3298,6 +3809,9 @@ bool copyFileFromHfs0Partition(u32 partition, const char *dest, const char *sour
             break;
         }
         
+        // Hashed regions are relative to the start of the HFS0 partition
+        if (hashCtx) updateHfs0HashContext(hashCtx, (fileOffset - gameCardInfo.hfs0Partitions[partition].offset) + off, dumpBuf, n);
+        
         if (fileSize > FAT32_FILESIZE_LIMIT && doSplitting && (off + n) >= ((splitIndex + 1) * SPLIT_FILE_GENERIC_PART_SIZE))
         {
             u64 new_file_chunk_size = ((off + n) - ((splitIndex + 1) * SPLIT_FILE_GENERIC_PART_SIZE));
@@ -3406,7 +3920,7 @@ out:
     return success;
 }
 
-bool copyHfs0PartitionContents(u32 partition, progress_ctx_t *progressCtx, const char *dest, bool splitting)
+bool copyHfs0PartitionContents(u32 partition, progress_ctx_t *progressCtx, const char *dest, bool splitting, hfs0_hash_ctx_t *hashCtx)
 {
     if (!gameCardInfo.rootHfs0Header || !gameCardInfo.hfs0PartitionCnt || partition >= gameCardInfo.hfs0PartitionCnt || !gameCardInfo.hfs0Partitions || !gameCardInfo.hfs0Partitions[partition].header || !gameCardInfo.hfs0Partitions[partition].header_size || !progressCtx || !dest || !strlen(dest))
     {
@@ -3466,7 +3980,7 @@ bool copyHfs0PartitionContents(u32 partition, progress_ctx_t *progressCtx, const
         
         u64 fileOffset = (gameCardInfo.hfs0Partitions[partition].offset + gameCardInfo.hfs0Partitions[partition].header_size + entry.file_offset);
         
-        success = copyFileFromHfs0Partition(partition, dbuf, filename, fileOffset, entry.file_size, progressCtx, splitting);
+        success = copyFileFromHfs0Partition(partition, dbuf, filename, fileOffset, entry.file_size, progressCtx, splitting, hashCtx);
         if (!success) break;
     }
     
@@ -3475,7 +3989,7 @@ bool copyHfs0PartitionContents(u32 partition, progress_ctx_t *progressCtx, const
     return success;
 }
 
-bool dumpHfs0PartitionData(u32 partition, bool doSplitting)
+bool dumpHfs0PartitionData(u32 partition, bool doSplitting, bool verifyHashes)
 {
     if (!gameCardInfo.rootHfs0Header || !gameCardInfo.hfs0PartitionCnt || partition >= gameCardInfo.hfs0PartitionCnt || !gameCardInfo.hfs0Partitions || !gameCardInfo.hfs0Partitions[partition].header)
     {
@@ -3498,6 +4012,9 @@ bool dumpHfs0PartitionData(u32 partition, bool doSplitting)
     progress_ctx_t progressCtx;
     memset(&progressCtx, 0, sizeof(progress_ctx_t));
     
+    hfs0_hash_ctx_t hashCtx;
+    memset(&hashCtx, 0, sizeof(hfs0_hash_ctx_t));
+    
     bool success = false;
     
     char *dumpName = generateGameCardDumpName(false);
@@ -3528,6 +4045,12 @@ bool dumpHfs0PartitionData(u32 partition, bool doSplitting)
     
     snprintf(dumpPath, MAX_CHARACTERS(dumpPath), "%s%s - Partition %u (%s)", HFS0_DUMP_PATH, dumpName, partition, GAMECARD_PARTITION_NAME(gameCardInfo.hfs0PartitionCnt, partition));
     
+    if (verifyHashes && !initHfs0HashContext(partition, &hashCtx))
+    {
+        breaks += 2;
+        goto out;
+    }
+    
     // Start dump process
     dumpStartMsg();
     appletModeOperationWarning();
@@ -3538,7 +4061,7 @@ bool dumpHfs0PartitionData(u32 partition, bool doSplitting)
     
     progressCtx.line_offset = (breaks + 4);
     
-    success = copyHfs0PartitionContents(partition, &progressCtx, dumpPath, doSplitting);
+    success = copyHfs0PartitionContents(partition, &progressCtx, dumpPath, doSplitting, (verifyHashes ? &hashCtx : NULL));
     
     if (success)
     {
@@ -3549,11 +4072,15 @@ bool dumpHfs0PartitionData(u32 partition, bool doSplitting)
         
         formatETAString(progressCtx.now, progressCtx.etaInfo, MAX_CHARACTERS(progressCtx.etaInfo));
         uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_SUCCESS_RGB, "Process successfully completed after %s!", progressCtx.etaInfo);
+        
+        if (verifyHashes) printHfs0HashResults(partition, &hashCtx);
     } else {
         removeDirectoryWithVerbose(dumpPath, "Deleting output directory. Please wait...");
     }
     
 out:
+    freeHfs0HashContext(&hashCtx);
+    
     free(dumpName);
     
     breaks += 2;
@@ -3666,7 +4193,7 @@ bool dumpFileFromHfs0Partition(u32 partition, u32 fileIndex, char *filename, boo
     progressCtx.line_offset = (breaks + 4);
     timeGetCurrentTime(TimeType_LocalSystemClock, &(progressCtx.start));
     
-    success = copyFileFromHfs0Partition(partition, destCopyPath, filename, fileOffset, progressCtx.totalSize, &progressCtx, doSplitting);
+    success = copyFileFromHfs0Partition(partition, destCopyPath, filename, fileOffset, progressCtx.totalSize, &progressCtx, doSplitting, NULL);
     
     closeGameCardStoragePartition();
     
@@ -3704,6 +4231,7 @@ bool dumpExeFsSectionData(u32 titleIndex, bool usePatch, ncaFsOptions *exeFsDump
     
     bool isFat32 = exeFsDumpCfg->isFat32;
     bool useLayeredFSDir = exeFsDumpCfg->useLayeredFSDir;
+    bool verifyHashes = exeFsDumpCfg->verifyHashes;
     
     u32 i;
     u64 n = 0, offset = 0;
@@ -3712,6 +4240,10 @@ bool dumpExeFsSectionData(u32 titleIndex, bool usePatch, ncaFsOptions *exeFsDump
     size_t write_res;
     bool proceed = true, success = false, fat32_error = false;
     
+    hash_failure_log_t failureLog;
+    bool pfs0Failed = false;
+    u64 pfs0FailedOffset = 0;
+    
     char tmp_idx[5] = {'\0'};
     char *dumpName = NULL;
     char dumpPath[NAME_BUF_LEN] = {'\0'}, curDumpPath[NAME_BUF_LEN * 2] = {'\0'};
@@ -3757,6 +4289,9 @@ bool dumpExeFsSectionData(u32 titleIndex, bool usePatch, ncaFsOptions *exeFsDump
     // Calculate total dump size
     if (!calculateExeFsExtractedDataSize(&(progressCtx.totalSize))) goto out;
     
+    // Load the PFS0 hash table if we need to verify the extracted data
+    if (verifyHashes && !initPfs0HashContext(&(exeFsContext.ncmStorage), &(exeFsContext.ncaId), &(exeFsContext.hash_ctx))) goto out;
+    
     convertSize(progressCtx.totalSize, progressCtx.totalSizeStr, MAX_CHARACTERS(progressCtx.totalSizeStr));
     uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "Extracted ExeFS dump size: %s (%lu bytes).", progressCtx.totalSizeStr, progressCtx.totalSize);
     uiRefreshDisplay();
@@ -3802,11 +4337,14 @@ bool dumpExeFsSectionData(u32 titleIndex, bool usePatch, ncaFsOptions *exeFsDump
     progressCtx.line_offset = (breaks + 4);
     timeGetCurrentTime(TimeType_LocalSystemClock, &(progressCtx.start));
     
+    initHashFailureLog(&failureLog, dumpPath);
+    
     for(i = 0; i < exeFsContext.exefs_header.file_cnt; i++)
     {
         n = DUMP_BUFFER_SIZE;
         outFile = NULL;
         splitIndex = 0;
+        pfs0Failed = false;
         
         char *exeFsFilename = (exeFsContext.exefs_str_table + exeFsContext.exefs_entries[i].filename_offset);
         
@@ -3854,6 +4392,15 @@ bool dumpExeFsSectionData(u32 titleIndex, bool usePatch, ncaFsOptions *exeFsDump
             
             if (!proceed) break;
             
+            if (verifyHashes && !pfs0Failed && !verifyPfs0SectionBlock(&(exeFsContext.ncmStorage), &(exeFsContext.ncaId), &(exeFsContext.hash_ctx), exeFsContext.exefs_data_offset + exeFsContext.exefs_entries[i].file_offset + offset, dumpBuf, n, false, &pfs0FailedOffset))
+            {
+                pfs0Failed = true;
+                addHashFailureLogEntry(&failureLog, "exefs:/%s: PFS0 verification failed at data block #%lu (PFS0 offset 0x%016lX).", exeFsFilename, (pfs0FailedOffset - exeFsContext.hash_ctx.pfs0_offset) / exeFsContext.hash_ctx.block_size, pfs0FailedOffset - exeFsContext.hash_ctx.pfs0_offset);
+                
+                uiFill(0, ((progressCtx.line_offset + 4) * LINE_HEIGHT) + 8, FB_WIDTH, LINE_HEIGHT, BG_COLOR_RGB);
+                uiDrawString(STRING_X_POS, STRING_Y_POS(progressCtx.line_offset + 4), FONT_COLOR_ERROR_RGB, "PFS0 verification failed for \"exefs:/%s\" at data block #%lu (PFS0 offset 0x%016lX)!", exeFsFilename, (pfs0FailedOffset - exeFsContext.hash_ctx.pfs0_offset) / exeFsContext.hash_ctx.block_size, pfs0FailedOffset - exeFsContext.hash_ctx.pfs0_offset);
+            }
+            
             if (exeFsContext.exefs_entries[i].file_size > FAT32_FILESIZE_LIMIT && isFat32 && (offset + n) >= ((splitIndex + 1) * SPLIT_FILE_GENERIC_PART_SIZE))
             {
                 u64 new_file_chunk_size = ((offset + n) - ((splitIndex + 1) * SPLIT_FILE_GENERIC_PART_SIZE));
@@ -3932,6 +4479,22 @@ bool dumpExeFsSectionData(u32 titleIndex, bool usePatch, ncaFsOptions *exeFsDump
         
         if (!proceed) break;
         
+        // Verify the last data block from this file right away, unless the next file picks up where this one ends
+        if (verifyHashes && !pfs0Failed && ((i + 1) >= exeFsContext.exefs_header.file_cnt || exeFsContext.exefs_entries[i + 1].file_offset != (exeFsContext.exefs_entries[i].file_offset + exeFsContext.exefs_entries[i].file_size)))
+        {
+            breaks = (progressCtx.line_offset + 2);
+            
+            if (!finishPfs0SectionVerification(&(exeFsContext.ncmStorage), &(exeFsContext.ncaId), &(exeFsContext.hash_ctx), &pfs0FailedOffset))
+            {
+                addHashFailureLogEntry(&failureLog, "exefs:/%s: PFS0 verification failed at data block #%lu (PFS0 offset 0x%016lX).", exeFsFilename, (pfs0FailedOffset - exeFsContext.hash_ctx.pfs0_offset) / exeFsContext.hash_ctx.block_size, pfs0FailedOffset - exeFsContext.hash_ctx.pfs0_offset);
+                
+                uiFill(0, ((progressCtx.line_offset + 4) * LINE_HEIGHT) + 8, FB_WIDTH, LINE_HEIGHT, BG_COLOR_RGB);
+                uiDrawString(STRING_X_POS, STRING_Y_POS(progressCtx.line_offset + 4), FONT_COLOR_ERROR_RGB, "PFS0 verification failed for \"exefs:/%s\" at data block #%lu (PFS0 offset 0x%016lX)!", exeFsFilename, (pfs0FailedOffset - exeFsContext.hash_ctx.pfs0_offset) / exeFsContext.hash_ctx.block_size, pfs0FailedOffset - exeFsContext.hash_ctx.pfs0_offset);
+            }
+            
+            breaks = (progressCtx.line_offset - 4);
+        }
+        
         // Support empty files
         if (!exeFsContext.exefs_entries[i].file_size)
         {
@@ -3972,7 +4535,11 @@ bool dumpExeFsSectionData(u32 titleIndex, bool usePatch, ncaFsOptions *exeFsDump
         
         formatETAString(progressCtx.now, progressCtx.etaInfo, MAX_CHARACTERS(progressCtx.etaInfo));
         uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_SUCCESS_RGB, "Process successfully completed after %s!", progressCtx.etaInfo);
+        
+        closeHashFailureLog(&failureLog, false);
+        if (failureLog.cnt) printHashFailureLogSummary(&failureLog, "PFS0");
     } else {
+        closeHashFailureLog(&failureLog, true);
         setProgressBarError(&progressCtx);
         if (fat32_error) breaks += 2;
         removeDirectoryWithVerbose(dumpPath, "Deleting output directory. Please wait...");
@@ -4001,6 +4568,7 @@ bool dumpFileFromExeFsSection(u32 titleIndex, u32 fileIndex, bool usePatch, ncaF
     
     bool isFat32 = exeFsDumpCfg->isFat32;
     bool useLayeredFSDir = exeFsDumpCfg->useLayeredFSDir;
+    bool verifyHashes = exeFsDumpCfg->verifyHashes;
     
     if (!exeFsContext.exefs_header.file_cnt || fileIndex > (exeFsContext.exefs_header.file_cnt - 1) || !exeFsContext.exefs_entries || !exeFsContext.exefs_str_table || exeFsContext.exefs_data_offset <= exeFsContext.exefs_offset || (!usePatch && titleIndex > (titleAppCount - 1)) || (usePatch && titleIndex > (titlePatchCount - 1)))
     {
@@ -4015,6 +4583,9 @@ bool dumpFileFromExeFsSection(u32 titleIndex, u32 fileIndex, bool usePatch, ncaF
     size_t write_res;
     bool proceed = true, success = false, fat32_error = false, removeFile = true;
     
+    bool pfs0Failed = false;
+    u64 pfs0FailedOffset = 0;
+    
     char tmp_idx[5];
     char *dumpName = NULL;
     char dumpPath[NAME_BUF_LEN] = {'\0'};
@@ -4102,6 +4673,19 @@ bool dumpFileFromExeFsSection(u32 titleIndex, u32 fileIndex, bool usePatch, ncaF
         }
     }
     
+    // The PFS0 hash table is kept in memory while browsing the ExeFS section
+    if (verifyHashes)
+    {
+        if (!exeFsContext.hash_ctx.initialized && !initPfs0HashContext(&(exeFsContext.ncmStorage), &(exeFsContext.ncaId), &(exeFsContext.hash_ctx)))
+        {
+            removeFile = false;
+            goto out;
+        }
+        
+        // Discard any data block left over from a previous dump
+        exeFsContext.hash_ctx.cur_block_active = false;
+    }
+    
     if (progressCtx.totalSize > FAT32_FILESIZE_LIMIT && isFat32)
     {
         // Since we may actually be dealing with an existing directory with the archive bit set or unset, let's try both
@@ -4153,6 +4737,8 @@ bool dumpFileFromExeFsSection(u32 titleIndex, u32 fileIndex, bool usePatch, ncaF
         
         if (!proceed) break;
         
+        if (verifyHashes && !pfs0Failed && !verifyPfs0SectionBlock(&(exeFsContext.ncmStorage), &(exeFsContext.ncaId), &(exeFsContext.hash_ctx), exeFsContext.exefs_data_offset + exeFsContext.exefs_entries[fileIndex].file_offset + progressCtx.curOffset, dumpBuf, n, false, &pfs0FailedOffset)) pfs0Failed = true;
+        
         if (progressCtx.totalSize > FAT32_FILESIZE_LIMIT && isFat32 && (progressCtx.curOffset + n) >= ((splitIndex + 1) * SPLIT_FILE_GENERIC_PART_SIZE))
         {
             u64 new_file_chunk_size = ((progressCtx.curOffset + n) - ((splitIndex + 1) * SPLIT_FILE_GENERIC_PART_SIZE));
@@ -4224,6 +4810,12 @@ bool dumpFileFromExeFsSection(u32 titleIndex, u32 fileIndex, bool usePatch, ncaF
     
     if (progressCtx.curOffset >= progressCtx.totalSize) success = true;
     
+    if (success && verifyHashes && !pfs0Failed)
+    {
+        breaks = (progressCtx.line_offset + 2);
+        if (!finishPfs0SectionVerification(&(exeFsContext.ncmStorage), &(exeFsContext.ncaId), &(exeFsContext.hash_ctx), &pfs0FailedOffset)) pfs0Failed = true;
+    }
+    
     // Support empty files
     if (!progressCtx.totalSize)
     {
@@ -4245,6 +4837,12 @@ bool dumpFileFromExeFsSection(u32 titleIndex, u32 fileIndex, bool usePatch, ncaF
         
         formatETAString(progressCtx.now, progressCtx.etaInfo, MAX_CHARACTERS(progressCtx.etaInfo));
         uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_SUCCESS_RGB, "Process successfully completed after %s!", progressCtx.etaInfo);
+        
+        if (pfs0Failed)
+        {
+            breaks++;
+            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "Warning: PFS0 verification failed at data block #%lu (PFS0 offset 0x%016lX)!", (pfs0FailedOffset - exeFsContext.hash_ctx.pfs0_offset) / exeFsContext.hash_ctx.block_size, pfs0FailedOffset - exeFsContext.hash_ctx.pfs0_offset);
+        }
     } else {
         setProgressBarError(&progressCtx);
         if (fat32_error) breaks += 2;
@@ -4278,7 +4876,7 @@ out:
     return success;
 }
 
-bool recursiveDumpRomFsFile(u32 file_offset, char *romfs_path, char *output_path, progress_ctx_t *progressCtx, bool usePatch, bool isFat32)
+bool recursiveDumpRomFsFile(u32 file_offset, char *romfs_path, char *output_path, progress_ctx_t *progressCtx, bool usePatch, bool isFat32, bool verifyHashes, hash_failure_log_t *failureLog)
 {
     if ((!usePatch && (!romFsContext.romfs_filetable_size || file_offset > romFsContext.romfs_filetable_size || !romFsContext.romfs_file_entries)) || (usePatch && (!bktrContext.romfs_filetable_size || file_offset > bktrContext.romfs_filetable_size || !bktrContext.romfs_file_entries)) || !romfs_path || !output_path || !progressCtx)
     {
@@ -4306,6 +4904,9 @@ bool recursiveDumpRomFsFile(u32 file_offset, char *romfs_path, char *output_path
     
     char tmp_idx[16];
     
+    bool ivfcFailed = false;
+    u64 ivfcFailedOffset = 0;
+    
     memset(dumpBuf, 0, DUMP_BUFFER_SIZE);
     
     while(romfs_file_offset != ROMFS_ENTRY_EMPTY)
@@ -4315,6 +4916,7 @@ bool recursiveDumpRomFsFile(u32 file_offset, char *romfs_path, char *output_path
         
         n = DUMP_BUFFER_SIZE;
         splitIndex = 0;
+        ivfcFailed = false;
         
         entry = (!usePatch ? (romfs_file*)((u8*)romFsContext.romfs_file_entries + romfs_file_offset) : (romfs_file*)((u8*)bktrContext.romfs_file_entries + romfs_file_offset));
         
@@ -4408,6 +5010,16 @@ bool recursiveDumpRomFsFile(u32 file_offset, char *romfs_path, char *output_path
             
             if (!proceed) break;
             
+            // Verify the data we just read against the IVFC hash tree. Mismatches are reported per file, but the file is still written
+            if (verifyHashes && !ivfcFailed && !verifyRomFsSectionBlock(usePatch, (!usePatch ? romFsContext.romfs_filedata_offset : bktrContext.romfs_filedata_offset) + entry->dataOff + off, dumpBuf, n, &ivfcFailedOffset))
+            {
+                ivfcFailed = true;
+                addHashFailureLogEntry(failureLog, "romfs:%s: IVFC verification failed at offset 0x%016lX.", romfs_path, ivfcFailedOffset - ((!usePatch ? romFsContext.romfs_filedata_offset : bktrContext.romfs_filedata_offset) + entry->dataOff));
+                
+                uiFill(0, ((progressCtx->line_offset + 4) * LINE_HEIGHT) + 8, FB_WIDTH, LINE_HEIGHT, BG_COLOR_RGB);
+                uiDrawString(STRING_X_POS, STRING_Y_POS(progressCtx->line_offset + 4), FONT_COLOR_ERROR_RGB, "IVFC verification failed for \"romfs:%s\" at offset 0x%016lX!", romfs_path, ivfcFailedOffset - ((!usePatch ? romFsContext.romfs_filedata_offset : bktrContext.romfs_filedata_offset) + entry->dataOff));
+            }
+            
             if (entry->dataSize > FAT32_FILESIZE_LIMIT && isFat32 && (off + n) >= ((splitIndex + 1) * SPLIT_FILE_GENERIC_PART_SIZE))
             {
                 u64 new_file_chunk_size = ((off + n) - ((splitIndex + 1) * SPLIT_FILE_GENERIC_PART_SIZE));
@@ -4526,7 +5138,7 @@ bool recursiveDumpRomFsFile(u32 file_offset, char *romfs_path, char *output_path
     return success;
 }
 
-bool recursiveDumpRomFsDir(u32 dir_offset, char *romfs_path, char *output_path, progress_ctx_t *progressCtx, bool usePatch, bool dumpSiblingDir, bool isFat32)
+bool recursiveDumpRomFsDir(u32 dir_offset, char *romfs_path, char *output_path, progress_ctx_t *progressCtx, bool usePatch, bool dumpSiblingDir, bool isFat32, bool verifyHashes, hash_failure_log_t *failureLog)
 {
     if ((!usePatch && (!romFsContext.romfs_dirtable_size || dir_offset > romFsContext.romfs_dirtable_size || !romFsContext.romfs_dir_entries || !romFsContext.romfs_filetable_size || !romFsContext.romfs_file_entries)) || (usePatch && (!bktrContext.romfs_dirtable_size || dir_offset > bktrContext.romfs_dirtable_size || !bktrContext.romfs_dir_entries || !bktrContext.romfs_filetable_size || !bktrContext.romfs_file_entries)) || !romfs_path || !output_path || !progressCtx)
     {
@@ -4566,7 +5178,7 @@ bool recursiveDumpRomFsDir(u32 dir_offset, char *romfs_path, char *output_path,
     
     if (entry->childFile != ROMFS_ENTRY_EMPTY)
     {
-        if (!recursiveDumpRomFsFile(entry->childFile, romfs_path, output_path, progressCtx, usePatch, isFat32))
+        if (!recursiveDumpRomFsFile(entry->childFile, romfs_path, output_path, progressCtx, usePatch, isFat32, verifyHashes, failureLog))
         {
             romfs_path[orig_romfs_path_len] = '\0';
             output_path[orig_output_path_len] = '\0';
@@ -4576,7 +5188,7 @@ bool recursiveDumpRomFsDir(u32 dir_offset, char *romfs_path, char *output_path,
     
     if (entry->childDir != ROMFS_ENTRY_EMPTY)
     {
-        if (!recursiveDumpRomFsDir(entry->childDir, romfs_path, output_path, progressCtx, usePatch, true, isFat32))
+        if (!recursiveDumpRomFsDir(entry->childDir, romfs_path, output_path, progressCtx, usePatch, true, isFat32, verifyHashes, failureLog))
         {
             romfs_path[orig_romfs_path_len] = '\0';
             output_path[orig_output_path_len] = '\0';
@@ -4589,7 +5201,7 @@ bool recursiveDumpRomFsDir(u32 dir_offset, char *romfs_path, char *output_path,
     
     if (dumpSiblingDir && entry->sibling != ROMFS_ENTRY_EMPTY)
     {
-        if (!recursiveDumpRomFsDir(entry->sibling, romfs_path, output_path, progressCtx, usePatch, true, isFat32)) return false;
+        if (!recursiveDumpRomFsDir(entry->sibling, romfs_path, output_path, progressCtx, usePatch, true, isFat32, verifyHashes, failureLog)) return false;
     }
     
     return true;
@@ -4606,6 +5218,7 @@ bool dumpRomFsSectionData(u32 titleIndex, selectedRomFsType curRomFsType, ncaFsO
     
     bool isFat32 = romFsDumpCfg->isFat32;
     bool useLayeredFSDir = romFsDumpCfg->useLayeredFSDir;
+    bool verifyHashes = romFsDumpCfg->verifyHashes;
     
     progress_ctx_t progressCtx;
     memset(&progressCtx, 0, sizeof(progress_ctx_t));
@@ -4614,6 +5227,7 @@ bool dumpRomFsSectionData(u32 titleIndex, selectedRomFsType curRomFsType, ncaFsO
     char romFsPath[NAME_BUF_LEN * 2] = {'\0'}, dumpPath[NAME_BUF_LEN * 2] = {'\0'};
     
     bool success = false;
+    hash_failure_log_t failureLog;
     
     if ((curRomFsType == ROMFS_TYPE_APP && !titleAppCount) || (curRomFsType == ROMFS_TYPE_PATCH && !titlePatchCount) || (curRomFsType == ROMFS_TYPE_ADDON && !titleAddOnCount))
     {
@@ -4651,6 +5265,9 @@ bool dumpRomFsSectionData(u32 titleIndex, selectedRomFsType curRomFsType, ncaFsO
     // Calculate total dump size
     if (!calculateRomFsFullExtractedSize((curRomFsType == ROMFS_TYPE_PATCH), &(progressCtx.totalSize))) goto out;
     
+    // Load and verify the upper IVFC hash levels
+    if (verifyHashes && !initRomFsIvfcContext(curRomFsType == ROMFS_TYPE_PATCH)) goto out;
+    
     convertSize(progressCtx.totalSize, progressCtx.totalSizeStr, MAX_CHARACTERS(progressCtx.totalSizeStr));
     uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "Extracted RomFS dump size: %s (%lu bytes).", progressCtx.totalSizeStr, progressCtx.totalSize);
     uiRefreshDisplay();
@@ -4700,7 +5317,9 @@ bool dumpRomFsSectionData(u32 titleIndex, selectedRomFsType curRomFsType, ncaFsO
     progressCtx.line_offset = (breaks + 4);
     timeGetCurrentTime(TimeType_LocalSystemClock, &(progressCtx.start));
     
-    success = recursiveDumpRomFsDir(0, romFsPath, dumpPath, &progressCtx, (curRomFsType == ROMFS_TYPE_PATCH), true, isFat32);
+    initHashFailureLog(&failureLog, dumpPath);
+    
+    success = recursiveDumpRomFsDir(0, romFsPath, dumpPath, &progressCtx, (curRomFsType == ROMFS_TYPE_PATCH), true, isFat32, verifyHashes, &failureLog);
     
     if (success)
     {
@@ -4711,7 +5330,11 @@ bool dumpRomFsSectionData(u32 titleIndex, selectedRomFsType curRomFsType, ncaFsO
         
         formatETAString(progressCtx.now, progressCtx.etaInfo, MAX_CHARACTERS(progressCtx.etaInfo));
         uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_SUCCESS_RGB, "Process successfully completed after %s!", progressCtx.etaInfo);
+        
+        closeHashFailureLog(&failureLog, false);
+        if (failureLog.cnt) printHashFailureLogSummary(&failureLog, "IVFC");
     } else {
+        closeHashFailureLog(&failureLog, true);
         setProgressBarError(&progressCtx);
         removeDirectoryWithVerbose(dumpPath, "Deleting output directory. Please wait...");
     }
@@ -4741,6 +5364,7 @@ bool dumpFileFromRomFsSection(u32 titleIndex, u32 file_offset, selectedRomFsType
     
     bool isFat32 = romFsDumpCfg->isFat32;
     bool useLayeredFSDir = romFsDumpCfg->useLayeredFSDir;
+    bool verifyHashes = romFsDumpCfg->verifyHashes;
     
     if ((curRomFsType != ROMFS_TYPE_PATCH && (!romFsContext.romfs_filetable_size || file_offset > romFsContext.romfs_filetable_size || !romFsContext.romfs_file_entries)) || (curRomFsType == ROMFS_TYPE_PATCH && (!bktrContext.romfs_filetable_size || file_offset > bktrContext.romfs_filetable_size || !bktrContext.romfs_file_entries)) || (curRomFsType == ROMFS_TYPE_APP && titleIndex > (titleAppCount - 1)) || (curRomFsType == ROMFS_TYPE_PATCH && titleIndex > (titlePatchCount - 1)) || (curRomFsType == ROMFS_TYPE_ADDON && titleIndex > (titleAddOnCount - 1)))
     {
@@ -4762,6 +5386,9 @@ bool dumpFileFromRomFsSection(u32 titleIndex, u32 file_offset, selectedRomFsType
     progress_ctx_t progressCtx;
     memset(&progressCtx, 0, sizeof(progress_ctx_t));
     
+    bool ivfcFailed = false;
+    u64 ivfcFailedOffset = 0;
+    
     memset(dumpBuf, 0, DUMP_BUFFER_SIZE);
     
     romfs_file *entry = (curRomFsType != ROMFS_TYPE_PATCH ? (romfs_file*)((u8*)romFsContext.romfs_file_entries + file_offset) : (romfs_file*)((u8*)bktrContext.romfs_file_entries + file_offset));
@@ -4892,6 +5519,9 @@ bool dumpFileFromRomFsSection(u32 titleIndex, u32 file_offset, selectedRomFsType
         strcat(dumpPath, tmp_idx);
     }
     
+    // Load and verify the upper IVFC hash levels
+    if (verifyHashes && !initRomFsIvfcContext(curRomFsType == ROMFS_TYPE_PATCH)) goto out;
+    
     // Start dump process
     dumpStartMsg();
     appletModeOperationWarning();
@@ -4942,6 +5572,12 @@ bool dumpFileFromRomFsSection(u32 titleIndex, u32 file_offset, selectedRomFsType
         
         if (!proceed) break;
         
+        if (verifyHashes && !ivfcFailed && !verifyRomFsSectionBlock((curRomFsType == ROMFS_TYPE_PATCH), (curRomFsType != ROMFS_TYPE_PATCH ? romFsContext.romfs_filedata_offset : bktrContext.romfs_filedata_offset) + entry->dataOff + progressCtx.curOffset, dumpBuf, n, &ivfcFailedOffset))
+        {
+            ivfcFailed = true;
+            ivfcFailedOffset -= ((curRomFsType != ROMFS_TYPE_PATCH ? romFsContext.romfs_filedata_offset : bktrContext.romfs_filedata_offset) + entry->dataOff);
+        }
+        
         if (progressCtx.totalSize > FAT32_FILESIZE_LIMIT && isFat32 && (progressCtx.curOffset + n) >= ((splitIndex + 1) * SPLIT_FILE_GENERIC_PART_SIZE))
         {
             u64 new_file_chunk_size = ((progressCtx.curOffset + n) - ((splitIndex + 1) * SPLIT_FILE_GENERIC_PART_SIZE));
@@ -5034,6 +5670,12 @@ bool dumpFileFromRomFsSection(u32 titleIndex, u32 file_offset, selectedRomFsType
         
         formatETAString(progressCtx.now, progressCtx.etaInfo, MAX_CHARACTERS(progressCtx.etaInfo));
         uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_SUCCESS_RGB, "Process successfully completed after %s!", progressCtx.etaInfo);
+        
+        if (ivfcFailed)
+        {
+            breaks++;
+            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "Warning: IVFC verification failed at file offset 0x%016lX!", ivfcFailedOffset);
+        }
     } else {
         setProgressBarError(&progressCtx);
         if (fat32_error) breaks += 2;
@@ -5078,6 +5720,7 @@ bool dumpCurrentDirFromRomFsSection(u32 titleIndex, selectedRomFsType curRomFsTy
     
     bool isFat32 = romFsDumpCfg->isFat32;
     bool useLayeredFSDir = romFsDumpCfg->useLayeredFSDir;
+    bool verifyHashes = romFsDumpCfg->verifyHashes;
     
     progress_ctx_t progressCtx;
     memset(&progressCtx, 0, sizeof(progress_ctx_t));
@@ -5086,6 +5729,7 @@ bool dumpCurrentDirFromRomFsSection(u32 titleIndex, selectedRomFsType curRomFsTy
     char romFsPath[NAME_BUF_LEN * 2] = {'\0'}, dumpPath[NAME_BUF_LEN * 2] = {'\0'};
     
     bool success = false;
+    hash_failure_log_t failureLog;
     
     if ((curRomFsType == ROMFS_TYPE_APP && !titleAppCount) || (curRomFsType == ROMFS_TYPE_PATCH && !titlePatchCount) || (curRomFsType == ROMFS_TYPE_ADDON && !titleAddOnCount))
     {
@@ -5115,6 +5759,9 @@ bool dumpCurrentDirFromRomFsSection(u32 titleIndex, selectedRomFsType curRomFsTy
     // Calculate total dump size
     if (!calculateRomFsExtractedDirSize(curRomFsDirOffset, (curRomFsType == ROMFS_TYPE_PATCH), &(progressCtx.totalSize))) goto out;
     
+    // Load and verify the upper IVFC hash levels
+    if (verifyHashes && !initRomFsIvfcContext(curRomFsType == ROMFS_TYPE_PATCH)) goto out;
+    
     convertSize(progressCtx.totalSize, progressCtx.totalSizeStr, MAX_CHARACTERS(progressCtx.totalSizeStr));
     uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "Extracted RomFS directory size: %s (%lu bytes).", progressCtx.totalSizeStr, progressCtx.totalSize);
     uiRefreshDisplay();
@@ -5205,7 +5852,9 @@ bool dumpCurrentDirFromRomFsSection(u32 titleIndex, selectedRomFsType curRomFsTy
     progressCtx.line_offset = (breaks + 4);
     timeGetCurrentTime(TimeType_LocalSystemClock, &(progressCtx.start));
     
-    success = recursiveDumpRomFsDir(curRomFsDirOffset, romFsPath, dumpPath, &progressCtx, (curRomFsType == ROMFS_TYPE_PATCH), false, isFat32);
+    initHashFailureLog(&failureLog, dumpPath);
+    
+    success = recursiveDumpRomFsDir(curRomFsDirOffset, romFsPath, dumpPath, &progressCtx, (curRomFsType == ROMFS_TYPE_PATCH), false, isFat32, verifyHashes, &failureLog);
     
     if (success)
     {
@@ -5216,7 +5865,11 @@ bool dumpCurrentDirFromRomFsSection(u32 titleIndex, selectedRomFsType curRomFsTy
         
         formatETAString(progressCtx.now, progressCtx.etaInfo, MAX_CHARACTERS(progressCtx.etaInfo));
         uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_SUCCESS_RGB, "Process successfully completed after %s!", progressCtx.etaInfo);
+        
+        closeHashFailureLog(&failureLog, false);
+        if (failureLog.cnt) printHashFailureLogSummary(&failureLog, "IVFC");
     } else {
+        closeHashFailureLog(&failureLog, true);
         setProgressBarError(&progressCtx);
         removeDirectoryWithVerbose(dumpPath, "Deleting output directory. Please wait...");
     }
@@ -5231,6 +5884,305 @@ out:
     return success;
 }
 
+bool verifyRomFsSectionData(u32 titleIndex, selectedRomFsType curRomFsType)
+{
+    progress_ctx_t progressCtx;
+    memset(&progressCtx, 0, sizeof(progress_ctx_t));
+    
+    bool usePatch = (curRomFsType == ROMFS_TYPE_PATCH);
+    bool proceed = true, success = false;
+    
+    u64 n = DUMP_BUFFER_SIZE;
+    u64 romfs_offset, failedOffset = 0, firstFailedOffset = 0;
+    u32 failedChunkCnt = 0;
+    u64 startTick = 0, elapsedNs = 0;
+    
+    if ((curRomFsType == ROMFS_TYPE_APP && (!titleAppCount || titleIndex > (titleAppCount - 1))) || (curRomFsType == ROMFS_TYPE_PATCH && (!titlePatchCount || titleIndex > (titlePatchCount - 1))) || (curRomFsType == ROMFS_TYPE_ADDON && (!titleAddOnCount || titleIndex > (titleAddOnCount - 1))))
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: invalid title index!", __func__);
+        breaks += 2;
+        return false;
+    }
+    
+    // Retrieve RomFS from Program NCA
+    if (readNcaRomFsSection(titleIndex, curRomFsType, -1) != 0)
+    {
+        breaks += 2;
+        return false;
+    }
+    
+    changeHomeButtonBlockStatus(true);
+    
+    // The upper hash levels are verified by this call
+    if (!initRomFsIvfcContext(usePatch)) goto out;
+    
+    romfs_offset = (!usePatch ? romFsContext.romfs_offset : bktrContext.romfs_offset);
+    progressCtx.totalSize = (!usePatch ? romFsContext.romfs_size : bktrContext.romfs_size);
+    
+    convertSize(progressCtx.totalSize, progressCtx.totalSizeStr, MAX_CHARACTERS(progressCtx.totalSizeStr));
+    uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "RomFS section size: %s (%lu bytes).", progressCtx.totalSizeStr, progressCtx.totalSize);
+    breaks += 2;
+    
+    uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "Verifying RomFS section data against its IVFC hash tree...");
+    uiRefreshDisplay();
+    breaks += 2;
+    
+    progressCtx.line_offset = (breaks + 2);
+    timeGetCurrentTime(TimeType_LocalSystemClock, &(progressCtx.start));
+    startTick = armGetSystemTick();
+    
+    // The dump buffer size is always a multiple of the IVFC block size, so every chunk is made of full blocks
+    for(progressCtx.curOffset = 0; progressCtx.curOffset < progressCtx.totalSize; progressCtx.curOffset += n)
+    {
+        if (n > (progressCtx.totalSize - progressCtx.curOffset)) n = (progressCtx.totalSize - progressCtx.curOffset);
+        
+        breaks = (progressCtx.line_offset + 2);
+        
+        if (!usePatch)
+        {
+            proceed = processNcaCtrSectionBlock(&(romFsContext.ncmStorage), &(romFsContext.ncaId), &(romFsContext.aes_ctx), romfs_offset + progressCtx.curOffset, dumpBuf, n, false);
+        } else {
+            proceed = readBktrSectionBlock(romfs_offset + progressCtx.curOffset, dumpBuf, n);
+        }
+        
+        if (!proceed) break;
+        
+        if (!verifyRomFsSectionBlock(usePatch, romfs_offset + progressCtx.curOffset, dumpBuf, n, &failedOffset))
+        {
+            if (!failedChunkCnt) firstFailedOffset = (failedOffset - romfs_offset);
+            failedChunkCnt++;
+        }
+        
+        printProgressBar(&progressCtx, true, n);
+        
+        if ((progressCtx.curOffset + n) < progressCtx.totalSize && cancelProcessCheck(&progressCtx))
+        {
+            uiDrawString(STRING_X_POS, STRING_Y_POS(progressCtx.line_offset + 2), FONT_COLOR_ERROR_RGB, "Process canceled.");
+            proceed = false;
+            break;
+        }
+    }
+    
+    elapsedNs = armTicksToNs(armGetSystemTick() - startTick);
+    
+    breaks = (progressCtx.line_offset + 2);
+    
+    if (!proceed || progressCtx.curOffset < progressCtx.totalSize)
+    {
+        setProgressBarError(&progressCtx);
+        goto out;
+    }
+    
+    if (!failedChunkCnt)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_SUCCESS_RGB, "RomFS section successfully verified!");
+        success = true;
+    } else {
+        setProgressBarError(&progressCtx);
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "IVFC verification failed for %u data chunk(s)! First bad block at RomFS offset 0x%016lX.", failedChunkCnt, firstFailedOffset);
+    }
+    
+    breaks++;
+    
+    // Bytes per nanosecond equals GB/s
+    uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "Read + verification speed: %.3lf GB/s (%lu bytes in %.3lf seconds).", (elapsedNs ? ((double)progressCtx.totalSize / (double)elapsedNs) : 0.0), progressCtx.totalSize, (double)elapsedNs / 1000000000.0);
+    
+out:
+    if (curRomFsType == ROMFS_TYPE_PATCH) freeBktrContext();
+    
+    freeRomFsContext();
+    
+    breaks += 2;
+    
+    changeHomeButtonBlockStatus(false);
+    
+    return success;
+}
+
+bool verifyGameCardHfs0Partitions()
+{
+    if (!gameCardInfo.rootHfs0Header || !gameCardInfo.hfs0PartitionCnt || !gameCardInfo.hfs0Partitions)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: invalid gamecard HFS0 partition data!", __func__);
+        breaks += 2;
+        return false;
+    }
+    
+    Result result;
+    u32 i, j;
+    u64 off, n;
+    hfs0_file_entry entry;
+    bool proceed = true, success = false, headersValid = false;
+    u32 failedFileCnt = 0;
+    
+    progress_ctx_t progressCtx;
+    memset(&progressCtx, 0, sizeof(progress_ctx_t));
+    
+    hfs0_hash_ctx_t *hashCtxs = calloc(gameCardInfo.hfs0PartitionCnt, sizeof(hfs0_hash_ctx_t));
+    if (!hashCtxs)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to allocate memory for the HFS0 hash contexts!", __func__);
+        breaks += 2;
+        return false;
+    }
+    
+    changeHomeButtonBlockStatus(true);
+    
+    uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "Checking HFS0 headers...");
+    uiRefreshDisplay();
+    breaks++;
+    
+    // Read the headers from the gamecard again instead of trusting the ones we got when it was inserted
+    headersValid = checkHfs0HeaderHashes(true);
+    
+    if (gameCardInfo.rootHfs0HeaderHashValid)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_SUCCESS_RGB, "Root HFS0 header: OK.");
+    } else {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "Root HFS0 header: hash mismatch!");
+    }
+    
+    breaks++;
+    
+    for(i = 0; i < gameCardInfo.hfs0PartitionCnt; i++)
+    {
+        if (gameCardInfo.hfs0Partitions[i].header_hash_valid)
+        {
+            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_SUCCESS_RGB, "%s HFS0 partition header: OK.", GAMECARD_PARTITION_NAME(gameCardInfo.hfs0PartitionCnt, i));
+        } else {
+            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s HFS0 partition header: hash mismatch!", GAMECARD_PARTITION_NAME(gameCardInfo.hfs0PartitionCnt, i));
+        }
+        
+        breaks++;
+        
+        if (!gameCardInfo.hfs0Partitions[i].file_cnt) continue;
+        
+        if (!initHfs0HashContext(i, &(hashCtxs[i])))
+        {
+            breaks += 2;
+            goto out;
+        }
+        
+        // Calculate total size
+        for(j = 0; j < gameCardInfo.hfs0Partitions[i].file_cnt; j++)
+        {
+            memcpy(&entry, gameCardInfo.hfs0Partitions[i].header + sizeof(hfs0_header) + (j * sizeof(hfs0_file_entry)), sizeof(hfs0_file_entry));
+            progressCtx.totalSize += entry.hashed_region_size;
+        }
+    }
+    
+    breaks++;
+    
+    convertSize(progressCtx.totalSize, progressCtx.totalSizeStr, MAX_CHARACTERS(progressCtx.totalSizeStr));
+    uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "Verifying HFS0 hashed regions (%s)...", progressCtx.totalSizeStr);
+    uiRefreshDisplay();
+    breaks += 2;
+    
+    progressCtx.line_offset = (breaks + 2);
+    timeGetCurrentTime(TimeType_LocalSystemClock, &(progressCtx.start));
+    
+    for(i = 0; i < gameCardInfo.hfs0PartitionCnt && proceed; i++)
+    {
+        if (!gameCardInfo.hfs0Partitions[i].file_cnt) continue;
+        
+        openIStoragePartition storageIndex = (openIStoragePartition)(HFS0_TO_ISTORAGE_IDX(gameCardInfo.hfs0PartitionCnt, i) + 1);
+        
+        result = openGameCardStoragePartition(storageIndex);
+        if (R_FAILED(result))
+        {
+            uiDrawString(STRING_X_POS, STRING_Y_POS(progressCtx.line_offset + 2), FONT_COLOR_ERROR_RGB, "%s: failed to open IStorage partition #%u! (0x%08X)", __func__, storageIndex - 1, result);
+            proceed = false;
+            break;
+        }
+        
+        for(j = 0; j < gameCardInfo.hfs0Partitions[i].file_cnt && proceed; j++)
+        {
+            memcpy(&entry, gameCardInfo.hfs0Partitions[i].header + sizeof(hfs0_header) + (j * sizeof(hfs0_file_entry)), sizeof(hfs0_file_entry));
+            
+            u64 regionOffset = (gameCardInfo.hfs0Partitions[i].header_size + entry.file_offset);
+            n = DUMP_BUFFER_SIZE;
+            
+            for(off = 0; off < entry.hashed_region_size; off += n, progressCtx.curOffset += n)
+            {
+                if (n > (entry.hashed_region_size - off)) n = (entry.hashed_region_size - off);
+                
+                result = readGameCardStoragePartition(gameCardInfo.hfs0Partitions[i].offset + regionOffset + off, dumpBuf, n);
+                if (R_FAILED(result))
+                {
+                    uiDrawString(STRING_X_POS, STRING_Y_POS(progressCtx.line_offset + 2), FONT_COLOR_ERROR_RGB, "%s: failed to read %lu bytes chunk at offset 0x%016lX from IStorage partition #%u! (0x%08X)", __func__, n, gameCardInfo.hfs0Partitions[i].offset + regionOffset + off, storageIndex - 1, result);
+                    proceed = false;
+                    break;
+                }
+                
+                updateHfs0HashContext(&(hashCtxs[i]), regionOffset + off, dumpBuf, n);
+                
+                printProgressBar(&progressCtx, true, n);
+                
+                if ((progressCtx.curOffset + n) < progressCtx.totalSize && cancelProcessCheck(&progressCtx))
+                {
+                    uiDrawString(STRING_X_POS, STRING_Y_POS(progressCtx.line_offset + 2), FONT_COLOR_ERROR_RGB, "Process canceled.");
+                    proceed = false;
+                    break;
+                }
+            }
+        }
+    }
+    
+    breaks = (progressCtx.line_offset + 2);
+    
+    if (!proceed)
+    {
+        setProgressBarError(&progressCtx);
+        goto out;
+    }
+    
+    // Support partitions without hashed regions
+    if (!progressCtx.totalSize)
+    {
+        progressCtx.progress = 100;
+        printProgressBar(&progressCtx, false, 0);
+    }
+    
+    for(i = 0; i < gameCardInfo.hfs0PartitionCnt; i++)
+    {
+        if (!hashCtxs[i].files) continue;
+        
+        failedFileCnt += hashCtxs[i].failed_cnt;
+        
+        if (hashCtxs[i].failed_cnt)
+        {
+            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s HFS0 partition: hashed region mismatch in %u of %u file(s)!", GAMECARD_PARTITION_NAME(gameCardInfo.hfs0PartitionCnt, i), hashCtxs[i].failed_cnt, hashCtxs[i].file_cnt);
+        } else {
+            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_SUCCESS_RGB, "%s HFS0 partition: %u file(s) verified.", GAMECARD_PARTITION_NAME(gameCardInfo.hfs0PartitionCnt, i), hashCtxs[i].verified_cnt);
+        }
+        
+        breaks++;
+    }
+    
+    breaks++;
+    
+    if (headersValid && !failedFileCnt)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_SUCCESS_RGB, "Gamecard HFS0 partitions successfully verified!");
+        success = true;
+    } else {
+        setProgressBarError(&progressCtx);
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "Gamecard HFS0 verification failed! If it succeeds after reinserting the gamecard, the gamecard slot is producing bad reads.");
+    }
+    
+out:
+    for(i = 0; i < gameCardInfo.hfs0PartitionCnt; i++) freeHfs0HashContext(&(hashCtxs[i]));
+    free(hashCtxs);
+    
+    closeGameCardStoragePartition();
+    
+    breaks += 2;
+    
+    changeHomeButtonBlockStatus(false);
+    
+    return success;
+}
+
 bool dumpGameCardCertificate()
 {
     u32 crc = 0;
@@ -5476,6 +6428,9 @@ bool dumpTicketFromTitle(u32 titleIndex, selectedTicketType curTikType, ticketOp
         goto out;
     }
     
+    // Content paths resolved through a previous storage session can't be reused
+    invalidateNcaContentPathCache();
+    
     for(i = 0; i < titleContentInfoCnt; i++)
     {
         memcpy(&ncaId, &(titleContentInfos[i].content_id), sizeof(NcmContentId));
@@ -5575,3 +6530,195 @@ out:
     
     return success;
 }
+
+bool dumpSystemSaveData(bool verifyHashes)
+{
+    FRESULT fr = FR_OK;
+    FDIR *saveDir = NULL;
+    FILINFO fno;
+    FIL *saveFile = NULL;
+    save_ctx_t *save_ctx = NULL;
+    save_extract_stats_t stats, saveStats;
+    diskio_stats diskStatsStart, diskStatsEnd;
+    char dumpPath[NAME_BUF_LEN] = {'\0'};
+    char totalSizeStr[32] = {'\0'};
+    u32 saveCnt = 0, failedSaveCnt = 0;
+    u64 startTick = 0, elapsedNs = 0;
+    bool proceed = true, success = false;
+    progress_ctx_t progressCtx;
+    
+    memset(&stats, 0, sizeof(save_extract_stats_t));
+    memset(&progressCtx, 0, sizeof(progress_ctx_t));
+    
+    saveDir = calloc(1, sizeof(FDIR));
+    saveFile = calloc(1, sizeof(FIL));
+    save_ctx = calloc(1, sizeof(save_ctx_t));
+    
+    if (!saveDir || !saveFile || !save_ctx)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to allocate memory for savefile contexts!", __func__);
+        goto out;
+    }
+    
+    // FatFs is used to read the savefiles from the BIS System partition, which avoids 0xE02 (file already in use) errors
+    fr = f_opendir(saveDir, BIS_SAVE_DIR_NAME);
+    if (fr != FR_OK)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: failed to open \"%s\" directory! (%u)", __func__, BIS_SAVE_DIR_NAME, fr);
+        free(saveDir);
+        saveDir = NULL;
+        goto out;
+    }
+    
+    uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "Output directory: \"%s\".", SAVE_DUMP_PATH);
+    breaks++;
+    
+    uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "IVFC hash verification: %s.", (verifyHashes ? "enabled" : "disabled"));
+    breaks++;
+    
+    appletModeOperationWarning();
+    breaks += 2;
+    
+    uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "Hold %s to cancel.", NINTENDO_FONT_B);
+    breaks += 2;
+    
+    progressCtx.line_offset = breaks;
+    
+    uiRefreshDisplay();
+    
+    changeHomeButtonBlockStatus(true);
+    
+    mkdir(SAVE_DUMP_PATH, 0744);
+    
+    disk_get_stats(&diskStatsStart);
+    
+    startTick = armGetSystemTick();
+    
+    while(true)
+    {
+        fr = f_readdir(saveDir, &fno);
+        if (fr != FR_OK || !fno.fname[0]) break;
+        
+        if (fno.fattrib & AM_DIR) continue;
+        
+        saveCnt++;
+        
+        breaks = progressCtx.line_offset;
+        
+        uiFill(0, 8 + (breaks * LINE_HEIGHT), FB_WIDTH, LINE_HEIGHT * 3, BG_COLOR_RGB);
+        
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "Savefile: %s [%u].", fno.fname, saveCnt);
+        breaks++;
+        
+        convertSize(stats.total_size, totalSizeStr, MAX_CHARACTERS(totalSizeStr));
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "Extracted so far: %u file(s), %u directory(ies), %s.", stats.file_cnt, stats.dir_cnt, totalSizeStr);
+        breaks++;
+        
+        uiRefreshDisplay();
+        
+        snprintf(dumpPath, MAX_CHARACTERS(dumpPath), "%s/%s", BIS_SAVE_DIR_NAME, fno.fname);
+        
+        // Drop cached sectors first, since the system may have written to the savefile since the last access
+        disk_cache_reset();
+        
+        fr = f_open(saveFile, dumpPath, FA_READ | FA_OPEN_EXISTING);
+        if (fr != FR_OK)
+        {
+            snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: failed to open \"%s\" savefile! (%u)", __func__, dumpPath, fr);
+            proceed = false;
+        } else {
+            memset(save_ctx, 0, sizeof(save_ctx_t));
+            memset(&saveStats, 0, sizeof(save_extract_stats_t));
+            
+            save_ctx->file = saveFile;
+            save_ctx->tool_ctx.action = (verifyHashes ? ACTION_VERIFY : 0);
+            
+            proceed = save_process(save_ctx);
+            if (proceed)
+            {
+                snprintf(dumpPath, MAX_CHARACTERS(dumpPath), "%s%s", SAVE_DUMP_PATH, fno.fname);
+                
+                proceed = save_extract_filesystem(save_ctx, dumpPath, MAX_CHARACTERS(dumpPath), dumpBuf, DUMP_BUFFER_SIZE, &saveStats);
+                if (!proceed)
+                {
+                    // Don't leave a partially extracted savefile behind
+                    snprintf(dumpPath, MAX_CHARACTERS(dumpPath), "%s%s", SAVE_DUMP_PATH, fno.fname);
+                    fsdevDeleteDirectoryRecursively(dumpPath);
+                }
+                
+                save_free_contexts(save_ctx);
+            }
+            
+            f_close(saveFile);
+            
+            stats.file_cnt += saveStats.file_cnt;
+            stats.dir_cnt += saveStats.dir_cnt;
+            stats.total_size += saveStats.total_size;
+        }
+        
+        // Keep going with the rest of the savefiles, but leave the last error on screen
+        if (!proceed)
+        {
+            failedSaveCnt++;
+            uiFill(0, 8 + ((progressCtx.line_offset + 3) * LINE_HEIGHT), FB_WIDTH, FB_HEIGHT - (8 + ((progressCtx.line_offset + 3) * LINE_HEIGHT)), BG_COLOR_RGB);
+            uiDrawString(STRING_X_POS, STRING_Y_POS(progressCtx.line_offset + 3), FONT_COLOR_ERROR_RGB, strbuf);
+        }
+        
+        if (cancelProcessCheck(&progressCtx))
+        {
+            breaks = (progressCtx.line_offset + 2);
+            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "Process canceled.");
+            breaks += 2;
+            goto out;
+        }
+    }
+    
+    elapsedNs = armTicksToNs(armGetSystemTick() - startTick);
+    
+    disk_get_stats(&diskStatsEnd);
+    
+    breaks = (progressCtx.line_offset + 2);
+    if (failedSaveCnt) breaks += 4;
+    
+    if (fr != FR_OK)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: failed to read \"%s\" directory! (%u)", __func__, BIS_SAVE_DIR_NAME, fr);
+        breaks += 2;
+    }
+    
+    if (!failedSaveCnt && fr == FR_OK)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_SUCCESS_RGB, "Successfully extracted %u savefile(s)!", saveCnt);
+        success = true;
+    } else {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "Failed to extract %u out of %u savefile(s).", failedSaveCnt, saveCnt);
+    }
+    
+    breaks++;
+    
+    convertSize(stats.total_size, totalSizeStr, MAX_CHARACTERS(totalSizeStr));
+    uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "Extracted %u file(s) and %u directory(ies) (%s) in %.3lf seconds.", stats.file_cnt, stats.dir_cnt, totalSizeStr, (double)elapsedNs / 1000000000.0);
+    breaks++;
+    
+    uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "Throughput: %.2lf MiB/s, %.2lf files/s.", (elapsedNs ? (((double)stats.total_size / 1048576.0) / ((double)elapsedNs / 1000000000.0)) : 0.0), (elapsedNs ? ((double)stats.file_cnt / ((double)elapsedNs / 1000000000.0)) : 0.0));
+    breaks++;
+    
+    convertSize(diskStatsEnd.storage_bytes - diskStatsStart.storage_bytes, totalSizeStr, MAX_CHARACTERS(totalSizeStr));
+    uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_RGB, "BIS sector cache: %lu read request(s), %lu cache hit(s), %lu storage read(s) (%s).", diskStatsEnd.requests - diskStatsStart.requests, diskStatsEnd.cache_hits - diskStatsStart.cache_hits, diskStatsEnd.storage_reads - diskStatsStart.storage_reads, totalSizeStr);
+    breaks += 2;
+    
+out:
+    if (saveDir)
+    {
+        f_closedir(saveDir);
+        free(saveDir);
+    }
+    
+    if (saveFile) free(saveFile);
+    
+    if (save_ctx) free(save_ctx);
+    
+    changeHomeButtonBlockStatus(false);
+    
+    return success;
+}
@@ -13,6 +13,8 @@
 #define SPLIT_FILE_GENERIC_PART_SIZE    SPLIT_FILE_NSP_PART_SIZE
 #define SPLIT_FILE_SEQUENTIAL_SIZE      (u64)0x40000000             // 1 GiB (used for sequential dumps when there's not enough storage space available)
 
+#define HASH_FAILURE_LOG_SUFFIX         " - hash failures.txt"       // Appended to the output directory path
+
 #define CERT_OFFSET                     0x7000
 #define CERT_SIZE                       0x200
 
@@ -54,18 +56,28 @@ typedef struct {
     char truncatedNspFilename[NAME_BUF_LEN];
 } batchEntry;
 
+// Every file that fails hash verification while extracting ExeFS / RomFS data is written to this log, which is only created if needed
+typedef struct {
+    char path[NAME_BUF_LEN * 2];
+    FILE *file;
+    u32 cnt;
+} hash_failure_log_t;
+
 bool dumpNXCardImage(xciOptions *xciDumpCfg);
 int dumpNintendoSubmissionPackage(nspDumpType selectedNspDumpType, u32 titleIndex, nspOptions *nspDumpCfg, bool batch);
 int dumpNintendoSubmissionPackageBatch(batchOptions *batchDumpCfg);
-bool dumpRawHfs0Partition(u32 partition, bool doSplitting);
-bool dumpHfs0PartitionData(u32 partition, bool doSplitting);
+bool dumpRawHfs0Partition(u32 partition, bool doSplitting, bool verifyHashes);
+bool dumpHfs0PartitionData(u32 partition, bool doSplitting, bool verifyHashes);
 bool dumpFileFromHfs0Partition(u32 partition, u32 fileIndex, char *filename, bool doSplitting);
 bool dumpExeFsSectionData(u32 titleIndex, bool usePatch, ncaFsOptions *exeFsDumpCfg);
 bool dumpFileFromExeFsSection(u32 titleIndex, u32 fileIndex, bool usePatch, ncaFsOptions *exeFsDumpCfg);
 bool dumpRomFsSectionData(u32 titleIndex, selectedRomFsType curRomFsType, ncaFsOptions *romFsDumpCfg);
 bool dumpFileFromRomFsSection(u32 titleIndex, u32 file_offset, selectedRomFsType curRomFsType, ncaFsOptions *romFsDumpCfg);
 bool dumpCurrentDirFromRomFsSection(u32 titleIndex, selectedRomFsType curRomFsType, ncaFsOptions *romFsDumpCfg);
+bool verifyRomFsSectionData(u32 titleIndex, selectedRomFsType curRomFsType);
+bool verifyGameCardHfs0Partitions();
 bool dumpGameCardCertificate();
 bool dumpTicketFromTitle(u32 titleIndex, selectedTicketType curTikType, ticketOptions *tikDumpCfg);
+bool dumpSystemSaveData(bool verifyHashes);
 
 #endif
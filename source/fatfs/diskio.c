@@ -10,10 +10,98 @@
 #include "ff.h"			/* Obtains integer types */
 #include "diskio.h"		/* Declarations of disk functions */
 
+#include <string.h>
 #include <switch.h>
 
 extern FsStorage fatFsStorage;
 
+/* Small reads (FAT sectors, directory entries, partial clusters) are served from aligned
+   blocks that are read in a single storage call. Bigger reads go straight to the storage.
+   The system keeps writing to the BIS System partition while it's mounted, so callers must
+   invalidate the cache with disk_cache_reset() before each savefile access. */
+#define DISKIO_CACHE_BLOCK_SECTORS	64
+#define DISKIO_CACHE_BLOCK_SIZE		(DISKIO_CACHE_BLOCK_SECTORS * FF_MAX_SS)
+#define DISKIO_CACHE_LINE_CNT		8
+
+typedef struct {
+    BYTE valid;
+    DWORD block;		/* Block index (start sector / DISKIO_CACHE_BLOCK_SECTORS) */
+    QWORD last_used;
+    BYTE data[DISKIO_CACHE_BLOCK_SIZE];
+} diskio_cache_line;
+
+static diskio_cache_line diskioCache[DISKIO_CACHE_LINE_CNT];
+static QWORD diskioCacheTick = 0;
+static QWORD diskioStorageSize = 0;
+static diskio_stats diskioStats;
+
+/* Statistics aren't cleared, so they keep accumulating while the volume stays mounted */
+void disk_cache_reset (void)
+{
+    memset(diskioCache, 0, sizeof(diskioCache));
+    diskioCacheTick = 0;
+    diskioStorageSize = 0;
+}
+
+void disk_get_stats (diskio_stats *out)
+{
+    if (out) memcpy(out, &diskioStats, sizeof(diskio_stats));
+}
+
+static diskio_cache_line *disk_cache_get_line (DWORD block)
+{
+    UINT i;
+    diskio_cache_line *line = NULL, *victim = &(diskioCache[0]);
+    
+    for(i = 0; i < DISKIO_CACHE_LINE_CNT; i++)
+    {
+        if (diskioCache[i].valid && diskioCache[i].block == block)
+        {
+            line = &(diskioCache[i]);
+            line->last_used = ++diskioCacheTick;
+            diskioStats.cache_hits++;
+            return line;
+        }
+        
+        if (!diskioCache[i].valid)
+        {
+            if (victim->valid) victim = &(diskioCache[i]);
+        } else
+        if (victim->valid && diskioCache[i].last_used < victim->last_used)
+        {
+            victim = &(diskioCache[i]);
+        }
+    }
+    
+    /* Retrieve the storage size only once, the last block may be shorter than the others */
+    if (!diskioStorageSize)
+    {
+        s64 size = 0;
+        if (R_FAILED(fsStorageGetSize(&fatFsStorage, &size)) || size <= 0) return NULL;
+        diskioStorageSize = (QWORD)size;
+    }
+    
+    QWORD offset = ((QWORD)block * DISKIO_CACHE_BLOCK_SIZE);
+    if (offset >= diskioStorageSize) return NULL;
+    
+    QWORD size = (diskioStorageSize - offset);
+    if (size > DISKIO_CACHE_BLOCK_SIZE) size = DISKIO_CACHE_BLOCK_SIZE;
+    
+    victim->valid = 0;
+    
+    Result rc = fsStorageRead(&fatFsStorage, offset, victim->data, size);
+    diskioStats.storage_reads++;
+    if (R_FAILED(rc)) return NULL;
+    
+    diskioStats.storage_bytes += size;
+    
+    victim->valid = 1;
+    victim->block = block;
+    victim->last_used = ++diskioCacheTick;
+    
+    return victim;
+}
+
 /*-----------------------------------------------------------------------*/
 /* Get Drive Status                                                      */
 /*-----------------------------------------------------------------------*/
@@ -56,12 +144,37 @@ DRESULT disk_read (
 )
 {
     (void)pdrv;
-    (void)buff;
-    (void)sector;
-    (void)count;
     
-    Result rc = fsStorageRead(&fatFsStorage, FF_MAX_SS * sector, buff, FF_MAX_SS * count);
-    if (R_FAILED(rc)) return RES_ERROR;
+    diskioStats.requests++;
+    diskioStats.requested_sectors += count;
+    
+    if (count >= DISKIO_CACHE_BLOCK_SECTORS)
+    {
+        Result rc = fsStorageRead(&fatFsStorage, (QWORD)FF_MAX_SS * sector, buff, (QWORD)FF_MAX_SS * count);
+        diskioStats.storage_reads++;
+        if (R_FAILED(rc)) return RES_ERROR;
+        
+        diskioStats.storage_bytes += ((QWORD)FF_MAX_SS * count);
+        
+        return RES_OK;
+    }
+    
+    while(count)
+    {
+        DWORD block = (sector / DISKIO_CACHE_BLOCK_SECTORS);
+        UINT block_sector = (UINT)(sector % DISKIO_CACHE_BLOCK_SECTORS);
+        UINT sector_cnt = (DISKIO_CACHE_BLOCK_SECTORS - block_sector);
+        if (sector_cnt > count) sector_cnt = count;
+        
+        diskio_cache_line *line = disk_cache_get_line(block);
+        if (!line) return RES_ERROR;
+        
+        memcpy(buff, line->data + (block_sector * FF_MAX_SS), sector_cnt * FF_MAX_SS);
+        
+        buff += (sector_cnt * FF_MAX_SS);
+        sector += sector_cnt;
+        count -= sector_cnt;
+    }
     
     return RES_OK;
 }
@@ -32,6 +32,18 @@ DRESULT disk_read (BYTE pdrv, BYTE* buff, DWORD sector, UINT count);
 DRESULT disk_write (BYTE pdrv, const BYTE* buff, DWORD sector, UINT count);
 DRESULT disk_ioctl (BYTE pdrv, BYTE cmd, void* buff);
 
+/* Sector cache statistics */
+typedef struct {
+	QWORD requests;				/* disk_read() calls */
+	QWORD requested_sectors;	/* Sectors requested by FatFs */
+	QWORD cache_hits;			/* Cached blocks reused */
+	QWORD storage_reads;		/* Storage read calls */
+	QWORD storage_bytes;		/* Bytes read from the storage */
+} diskio_stats;
+
+void disk_cache_reset (void);
+void disk_get_stats (diskio_stats *out);
+
 
 /* Disk Status Bits (DSTATUS) */
 
@@ -4,6 +4,7 @@
 #include <errno.h>
 
 #include "fatfs/ff.h"
+#include "fatfs/diskio.h"
 #include "keys.h"
 #include "util.h"
 #include "ui.h"
@@ -995,6 +996,9 @@ int retrieveNcaTikTitleKey(nca_header_t *dec_nca_header, u8 *out_tik, u8 *out_en
     }
     
     // FatFs is used to mount the BIS System partition and read the ES savedata files to avoid 0xE02 (file already in use) errors
+    // Drop cached sectors first, since the system may have written to the savefile since the last access
+    disk_cache_reset();
+    
     fr = f_open(eTicketSave, (rightsIdType == 1 ? BIS_COMMON_TIK_SAVE_NAME : BIS_PERSONALIZED_TIK_SAVE_NAME), FA_READ | FA_OPEN_EXISTING);
     if (fr)
     {
@@ -66,6 +66,9 @@ int main(int argc, char *argv[])
             case resultDumpHfs0PartitionData:
                 uiSetState(stateDumpHfs0PartitionData);
                 break;
+            case resultVerifyGameCardHfs0Partitions:
+                uiSetState(stateVerifyGameCardHfs0Partitions);
+                break;
             case resultShowHfs0BrowserMenu:
                 uiSetState(stateHfs0BrowserMenu);
                 break;
@@ -108,6 +111,9 @@ int main(int argc, char *argv[])
             case resultDumpRomFsSectionData:
                 uiSetState(stateDumpRomFsSectionData);
                 break;
+            case resultVerifyRomFsSectionData:
+                uiSetState(stateVerifyRomFsSectionData);
+                break;
             case resultShowRomFsSectionBrowserMenu:
                 uiSetState(stateRomFsSectionBrowserMenu);
                 break;
@@ -150,6 +156,12 @@ int main(int argc, char *argv[])
             case resultDumpTicket:
                 uiSetState(stateDumpTicket);
                 break;
+            case resultShowSystemSaveMenu:
+                uiSetState(stateSystemSaveMenu);
+                break;
+            case resultDumpSystemSave:
+                uiSetState(stateDumpSystemSave);
+                break;
             case resultShowUpdateMenu:
                 uiSetState(stateUpdateMenu);
                 break;
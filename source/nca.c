@@ -22,6 +22,18 @@ extern nca_keyset_t nca_keyset;
 
 extern u8 *ncaCtrBuf;
 
+extern gamecard_ctx_t gameCardInfo;
+
+/* Statically allocated variables */
+
+// Last opened NCA content handle, used by readNcaDataByContentId()
+// Dumps read the same NCA in chunks, so this avoids resolving the content path for every single chunk
+static bool lastNcaContentHandleValid = false;
+static NcmContentStorage lastNcaContentStorage;
+static nca_content_handle_t lastNcaContentHandle;
+
+static nca_content_read_stats_t ncaContentReadStats;
+
 char *getTitleType(u8 type)
 {
     char *out = NULL;
@@ -124,66 +136,60 @@ char *getReferenceTitleIDType(u8 type)
     return out;
 }
 
-void generateCnmtXml(cnmt_xml_program_info *xml_program_info, cnmt_xml_content_info *xml_content_info, char *out)
+void generateCnmtXml(cnmt_xml_program_info *xml_program_info, cnmt_xml_content_info *xml_content_info, xml_buffer_t *out)
 {
     if (!xml_program_info || !xml_content_info || !xml_program_info->nca_cnt || !out) return;
     
     u32 i;
-    char tmp[NAME_BUF_LEN] = {'\0'};
     
-    sprintf(out, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n" \
-                 "<ContentMeta>\n" \
-                 "  <Type>%s</Type>\n" \
-                 "  <Id>0x%016lx</Id>\n" \
-                 "  <Version>%u</Version>\n" \
-                 "  <RequiredDownloadSystemVersion>%u</RequiredDownloadSystemVersion>\n", \
-                 getTitleType(xml_program_info->type), \
-                 xml_program_info->title_id, \
-                 xml_program_info->version, \
-                 xml_program_info->required_dl_sysver);
+    xmlBufferAppendFormatted(out, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n" \
+                                  "<ContentMeta>\n" \
+                                  "  <Type>%s</Type>\n" \
+                                  "  <Id>0x%016lx</Id>\n" \
+                                  "  <Version>%u</Version>\n" \
+                                  "  <RequiredDownloadSystemVersion>%u</RequiredDownloadSystemVersion>\n", \
+                                  getTitleType(xml_program_info->type), \
+                                  xml_program_info->title_id, \
+                                  xml_program_info->version, \
+                                  xml_program_info->required_dl_sysver);
     
     for(i = 0; i < xml_program_info->nca_cnt; i++)
     {
-        sprintf(tmp, "  <Content>\n" \
-                     "    <Type>%s</Type>\n" \
-                     "    <Id>%s</Id>\n" \
-                     "    <Size>%lu</Size>\n" \
-                     "    <Hash>%s</Hash>\n" \
-                     "    <KeyGeneration>%u</KeyGeneration>\n" \
-                     "    <IdOffset>%u</IdOffset>\n" \
-                     "  </Content>\n",
-                     getContentType(xml_content_info[i].type), \
-                     xml_content_info[i].nca_id_str, \
-                     xml_content_info[i].size, \
-                     xml_content_info[i].hash_str, \
-                     xml_content_info[i].keyblob, \
-                     xml_content_info[i].id_offset);
-        
-        strcat(out, tmp);
-    }
-    
-    sprintf(tmp, "  <Digest>%s</Digest>\n" \
-                 "  <KeyGenerationMin>%u</KeyGenerationMin>\n" \
-                 "  <%s>%u</%s>\n" \
-                 "  <%s>0x%016lx</%s>\n", \
-                 xml_program_info->digest_str, \
-                 xml_program_info->min_keyblob, \
-                 getRequiredMinTitleType(xml_program_info->type), \
-                 xml_program_info->min_sysver, \
-                 getRequiredMinTitleType(xml_program_info->type), \
-                 getReferenceTitleIDType(xml_program_info->type), \
-                 xml_program_info->patch_tid, \
-                 getReferenceTitleIDType(xml_program_info->type));
-    
-    strcat(out, tmp);
+        xmlBufferAppendFormatted(out, "  <Content>\n" \
+                                      "    <Type>%s</Type>\n" \
+                                      "    <Id>%s</Id>\n" \
+                                      "    <Size>%lu</Size>\n" \
+                                      "    <Hash>%s</Hash>\n" \
+                                      "    <KeyGeneration>%u</KeyGeneration>\n" \
+                                      "    <IdOffset>%u</IdOffset>\n" \
+                                      "  </Content>\n",
+                                      getContentType(xml_content_info[i].type), \
+                                      xml_content_info[i].nca_id_str, \
+                                      xml_content_info[i].size, \
+                                      xml_content_info[i].hash_str, \
+                                      xml_content_info[i].keyblob, \
+                                      xml_content_info[i].id_offset);
+    }
+    
+    xmlBufferAppendFormatted(out, "  <Digest>%s</Digest>\n" \
+                                  "  <KeyGenerationMin>%u</KeyGenerationMin>\n" \
+                                  "  <%s>%u</%s>\n" \
+                                  "  <%s>0x%016lx</%s>\n", \
+                                  xml_program_info->digest_str, \
+                                  xml_program_info->min_keyblob, \
+                                  getRequiredMinTitleType(xml_program_info->type), \
+                                  xml_program_info->min_sysver, \
+                                  getRequiredMinTitleType(xml_program_info->type), \
+                                  getReferenceTitleIDType(xml_program_info->type), \
+                                  xml_program_info->patch_tid, \
+                                  getReferenceTitleIDType(xml_program_info->type));
     
     if (xml_program_info->type == NcmContentMetaType_Application)
     {
-        sprintf(tmp, "  <RequiredApplicationVersion>%u</RequiredApplicationVersion>\n", xml_program_info->min_appver);
-        strcat(out, tmp);
+        xmlBufferAppendFormatted(out, "  <RequiredApplicationVersion>%u</RequiredApplicationVersion>\n", xml_program_info->min_appver);
     }
     
-    strcat(out, "</ContentMeta>");
+    xmlBufferAppend(out, "</ContentMeta>");
 }
 
 void convertNcaSizeToU64(const u8 size[0x6], u64 *out)
@@ -295,44 +301,131 @@ static void nca_update_bktr_ctr(unsigned char *ctr, u32 ctr_val, u64 ofs)
     }
 }
 
-bool readNcaDataByContentId(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, u64 offset, void *outBuf, size_t bufSize)
+void invalidateNcaContentPathCache()
 {
-    if (!ncmStorage || !ncaId || !outBuf || !bufSize)
+    lastNcaContentHandleValid = false;
+    memset(&lastNcaContentStorage, 0, sizeof(NcmContentStorage));
+    memset(&lastNcaContentHandle, 0, sizeof(nca_content_handle_t));
+}
+
+void resetNcaContentReadStats()
+{
+    memset(&ncaContentReadStats, 0, sizeof(nca_content_read_stats_t));
+}
+
+void getNcaContentReadStats(nca_content_read_stats_t *out)
+{
+    if (out) memcpy(out, &ncaContentReadStats, sizeof(nca_content_read_stats_t));
+}
+
+bool openNcaContentHandle(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, nca_content_handle_t *handle)
+{
+    if (!ncmStorage || !ncaId || !handle)
     {
-        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: invalid parameters to read data from NCA!", __func__);
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: invalid parameters to open NCA content handle!", __func__);
         return false;
     }
     
-    Result result = 0;
-    bool success = false;
+    Result result;
+    char nca_path[0x301] = {'\0'};
+    char *nca_filename = NULL;
+    hfs0_file_entry entry;
     
-    char nca_id[SHA256_HASH_SIZE + 1] = {'\0'}, nca_path[0x301] = {'\0'};
-    convertDataToHexString(ncaId->c, SHA256_HASH_SIZE / 2, nca_id, SHA256_HASH_SIZE + 1);
+    memset(handle, 0, sizeof(nca_content_handle_t));
+    
+    handle->ncmStorage = ncmStorage;
+    memcpy(&(handle->ncaId), ncaId, sizeof(NcmContentId));
+    convertDataToHexString(ncaId->c, SHA256_HASH_SIZE / 2, handle->nca_id_str, SHA256_HASH_SIZE + 1);
+    
+    ncaContentReadStats.path_lookups++;
     
     result = ncmContentStorageGetPath(ncmStorage, nca_path, MAX_CHARACTERS(nca_path), ncaId);
     if (R_FAILED(result) || !strlen(nca_path))
     {
-        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: failed to retrieve content path for NCA \"%s\"! (0x%08X)", __func__, nca_id, result);
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: failed to retrieve content path for NCA \"%s\"! (0x%08X)", __func__, handle->nca_id_str, result);
         return false;
     }
     
     // Check if we're dealing with a gamecard NCA
-    if (!strncmp(nca_path, "@Gc", 3))
+    handle->gamecard = !strncmp(nca_path, "@Gc", 3);
+    if (!handle->gamecard) return true;
+    
+    nca_filename = strrchr(nca_path, '/');
+    nca_filename = (nca_filename ? (nca_filename + 1) : nca_path);
+    
+    if (!getSecureHfs0FileEntryByName(nca_filename, &entry) || !entry.file_size)
     {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to find file \"%s\" in Secure HFS0 partition!", __func__, nca_filename);
+        return false;
+    }
+    
+    handle->gamecard_offset = (gameCardInfo.hfs0Partitions[gameCardInfo.hfs0PartitionCnt - 1].header_size + entry.file_offset);
+    handle->gamecard_size = entry.file_size;
+    
+    return true;
+}
+
+bool readNcaContentHandle(nca_content_handle_t *handle, u64 offset, void *outBuf, size_t bufSize)
+{
+    if (!handle || !handle->ncmStorage || !outBuf || !bufSize)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: invalid parameters to read data from NCA!", __func__);
+        return false;
+    }
+    
+    Result result;
+    
+    ncaContentReadStats.reads++;
+    
+    if (handle->gamecard)
+    {
+        if ((offset + bufSize) > handle->gamecard_size)
+        {
+            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: read request exceeds the size for NCA \"%s\"!", __func__, handle->nca_id_str);
+            return false;
+        }
+        
         // Retrieve NCA data using raw IStorage reads
         // Fixes NCA access problems with gamecards under low HOS versions when using ncmContentStorageReadContentIdFile()
-        success = readFileFromSecureHfs0PartitionByName(strrchr(nca_path, '/') + 1, offset, outBuf, bufSize);
-        if (!success) breaks++;
+        result = readGameCardStoragePartition(handle->gamecard_offset + offset, outBuf, bufSize);
     } else {
         // Retrieve NCA data normally
         // This strips NAX0 encryption from SD card NCAs (not used with eMMC NCAs)
-        result = ncmContentStorageReadContentIdFile(ncmStorage, outBuf, bufSize, ncaId, offset);
-        success = R_SUCCEEDED(result);
+        result = ncmContentStorageReadContentIdFile(handle->ncmStorage, outBuf, bufSize, &(handle->ncaId), offset);
+    }
+    
+    if (R_FAILED(result))
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: failed to read %lu bytes block at offset 0x%016lX from NCA \"%s\"! (0x%08X)", __func__, bufSize, offset, handle->nca_id_str, result);
+        return false;
+    }
+    
+    return true;
+}
+
+bool readNcaDataByContentId(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, u64 offset, void *outBuf, size_t bufSize)
+{
+    if (!ncmStorage || !ncaId || !outBuf || !bufSize)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: invalid parameters to read data from NCA!", __func__);
+        return false;
     }
     
-    if (!success) uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: failed to read %lu bytes block at offset 0x%016lX from NCA \"%s\"! (0x%08X)", __func__, bufSize, offset, nca_id, result);
+    // Only open a new content handle if this NCA wasn't the last one we read from
+    if (!lastNcaContentHandleValid || memcmp(&lastNcaContentStorage, ncmStorage, sizeof(NcmContentStorage)) != 0 || memcmp(&(lastNcaContentHandle.ncaId), ncaId, sizeof(NcmContentId)) != 0)
+    {
+        invalidateNcaContentPathCache();
+        
+        if (!openNcaContentHandle(ncmStorage, ncaId, &lastNcaContentHandle)) return false;
+        
+        memcpy(&lastNcaContentStorage, ncmStorage, sizeof(NcmContentStorage));
+        lastNcaContentHandleValid = true;
+    }
     
-    return success;
+    // The caller's storage pointer may differ from the one used to open the handle
+    lastNcaContentHandle.ncmStorage = ncmStorage;
+    
+    return readNcaContentHandle(&lastNcaContentHandle, offset, outBuf, bufSize);
 }
 
 bool processNcaCtrSectionBlock(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, Aes128CtrContext *ctx, u64 offset, void *outBuf, size_t bufSize, bool encrypt)
@@ -643,6 +736,507 @@ bool readBktrSectionBlock(u64 offset, void *outBuf, size_t bufSize)
     return true;
 }
 
+static bool readRomFsSectionRawBlock(bool usePatch, u64 offset, void *outBuf, size_t bufSize)
+{
+    // "offset" is always relative to section start here
+    if (!usePatch) return processNcaCtrSectionBlock(&(romFsContext.ncmStorage), &(romFsContext.ncaId), &(romFsContext.aes_ctx), romFsContext.section_offset + offset, outBuf, bufSize, false);
+    
+    return readBktrSectionBlock(offset, outBuf, bufSize);
+}
+
+void freeIvfcContext(ivfc_ctx_t *ctx)
+{
+    if (!ctx) return;
+    
+    u32 i;
+    
+    for(i = 0; i < (IVFC_MAX_LEVEL - 2); i++)
+    {
+        if (ctx->upper_levels[i]) free(ctx->upper_levels[i]);
+    }
+    
+    if (ctx->hash_cache) free(ctx->hash_cache);
+    
+    if (ctx->block_buf) free(ctx->block_buf);
+    
+    memset(ctx, 0, sizeof(ivfc_ctx_t));
+}
+
+bool initRomFsIvfcContext(bool usePatch)
+{
+    ivfc_hdr_t *ivfc_header = (!usePatch ? &(romFsContext.ivfc_header) : &(bktrContext.superblock.ivfc_header));
+    ivfc_ctx_t *ctx = (!usePatch ? &(romFsContext.ivfc_ctx) : &(bktrContext.ivfc_ctx));
+    u64 section_size = (!usePatch ? romFsContext.section_size : bktrContext.section_size);
+    
+    if (ctx->initialized) return true;
+    
+    if (!section_size || __builtin_bswap32(ivfc_header->magic) != IVFC_MAGIC || ivfc_header->master_hash_size != SHA256_HASH_SIZE)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: invalid IVFC header for NCA RomFS section!", __func__);
+        return false;
+    }
+    
+    u32 i;
+    u64 j, block_cnt;
+    u8 block_hash[SHA256_HASH_SIZE];
+    u64 max_block_size = 0;
+    
+    for(i = 0; i < IVFC_MAX_LEVEL; i++)
+    {
+        ctx->level_offset[i] = ivfc_header->level_headers[i].logical_offset;
+        ctx->level_size[i] = ivfc_header->level_headers[i].hash_data_size;
+        ctx->level_block_size[i] = (ivfc_header->level_headers[i].block_size < 32 ? ((u64)1 << ivfc_header->level_headers[i].block_size) : 0);
+        
+        if (!ctx->level_size[i] || ctx->level_block_size[i] < SHA256_HASH_SIZE || ctx->level_block_size[i] > NCA_CTR_BUFFER_SIZE || (ctx->level_offset[i] + ctx->level_size[i]) > section_size)
+        {
+            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: invalid IVFC level #%u header for NCA RomFS section!", __func__, i + 1);
+            return false;
+        }
+        
+        // The master hash only covers a single level 1 block
+        if (i == 0 && ctx->level_size[0] > ctx->level_block_size[0])
+        {
+            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: IVFC level #1 spans more than a single block!", __func__);
+            return false;
+        }
+        
+        // Each hash level must be big enough to hold the hashes for all the blocks from the next level
+        if (i > 0 && ((round_up(ctx->level_size[i], ctx->level_block_size[i]) / ctx->level_block_size[i]) * SHA256_HASH_SIZE) > ctx->level_size[i - 1])
+        {
+            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: IVFC level #%u is too small to hold the hashes for level #%u!", __func__, i, i + 1);
+            return false;
+        }
+        
+        if (ctx->level_block_size[i] > max_block_size) max_block_size = ctx->level_block_size[i];
+    }
+    
+    // Levels 1 - 4 are read in full and verified top-down against the master hash
+    for(i = 0; i < (IVFC_MAX_LEVEL - 2); i++)
+    {
+        ctx->upper_levels[i] = calloc(1, round_up(ctx->level_size[i], ctx->level_block_size[i]));
+        if (!ctx->upper_levels[i])
+        {
+            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to allocate memory for IVFC level #%u!", __func__, i + 1);
+            goto out;
+        }
+        
+        if (!readRomFsSectionRawBlock(usePatch, ctx->level_offset[i], ctx->upper_levels[i], ctx->level_size[i]))
+        {
+            breaks++;
+            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: failed to read IVFC level #%u!", __func__, i + 1);
+            goto out;
+        }
+        
+        block_cnt = (round_up(ctx->level_size[i], ctx->level_block_size[i]) / ctx->level_block_size[i]);
+        
+        // Already checked while parsing the level headers, but the parent hashes must never be read out of bounds
+        if (i > 0 && (block_cnt * SHA256_HASH_SIZE) > ctx->level_size[i - 1])
+        {
+            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: IVFC level #%u is too small to hold the hashes for level #%u!", __func__, i, i + 1);
+            goto out;
+        }
+        
+        for(j = 0; j < block_cnt; j++)
+        {
+            // IVFC hashes are always calculated over full blocks (zero padded)
+            sha256CalculateHash(block_hash, ctx->upper_levels[i] + (j * ctx->level_block_size[i]), ctx->level_block_size[i]);
+            
+            if (memcmp(block_hash, (i == 0 ? ivfc_header->master_hash : (ctx->upper_levels[i - 1] + (j * SHA256_HASH_SIZE))), SHA256_HASH_SIZE) != 0)
+            {
+                uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: IVFC level #%u hash mismatch at block #%lu!", __func__, i + 1, j);
+                goto out;
+            }
+        }
+    }
+    
+    ctx->hash_cache = malloc(IVFC_HASH_CACHE_SLOTS * ctx->level_block_size[IVFC_MAX_LEVEL - 2]);
+    ctx->block_buf = malloc(max_block_size);
+    
+    if (!ctx->hash_cache || !ctx->block_buf)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to allocate memory for the IVFC hash cache!", __func__);
+        goto out;
+    }
+    
+    ctx->initialized = true;
+    
+out:
+    if (!ctx->initialized) freeIvfcContext(ctx);
+    
+    return ctx->initialized;
+}
+
+static const u8 *getIvfcDataBlockHash(bool usePatch, u64 block_idx)
+{
+    ivfc_ctx_t *ctx = (!usePatch ? &(romFsContext.ivfc_ctx) : &(bktrContext.ivfc_ctx));
+    
+    u64 hash_block_size = ctx->level_block_size[IVFC_MAX_LEVEL - 2];
+    u64 hash_offset = (block_idx * SHA256_HASH_SIZE);
+    u64 hash_block_idx = (hash_offset / hash_block_size);
+    u32 slot = (u32)(hash_block_idx % IVFC_HASH_CACHE_SLOTS);
+    u8 *hash_block = (ctx->hash_cache + ((u64)slot * hash_block_size));
+    u8 hash_block_hash[SHA256_HASH_SIZE];
+    
+    if (hash_offset >= ctx->level_size[IVFC_MAX_LEVEL - 2]) return NULL;
+    
+    if (!ctx->hash_cache_valid[slot] || ctx->hash_cache_tags[slot] != hash_block_idx)
+    {
+        u64 hash_block_offset = (hash_block_idx * hash_block_size);
+        u64 read_size = (ctx->level_size[IVFC_MAX_LEVEL - 2] - hash_block_offset);
+        if (read_size > hash_block_size) read_size = hash_block_size;
+        
+        ctx->hash_cache_valid[slot] = false;
+        
+        if (read_size < hash_block_size) memset(hash_block + read_size, 0, hash_block_size - read_size);
+        
+        if (!readRomFsSectionRawBlock(usePatch, ctx->level_offset[IVFC_MAX_LEVEL - 2] + hash_block_offset, hash_block, read_size)) return NULL;
+        
+        // Verify the level 5 hash block against level 4 before caching it
+        sha256CalculateHash(hash_block_hash, hash_block, hash_block_size);
+        if (memcmp(hash_block_hash, ctx->upper_levels[IVFC_MAX_LEVEL - 3] + (hash_block_idx * SHA256_HASH_SIZE), SHA256_HASH_SIZE) != 0) return NULL;
+        
+        ctx->hash_cache_tags[slot] = hash_block_idx;
+        ctx->hash_cache_valid[slot] = true;
+    }
+    
+    return (hash_block + (hash_offset % hash_block_size));
+}
+
+bool verifyRomFsSectionBlock(bool usePatch, u64 offset, const u8 *data, u64 size, u64 *out_failed_offset)
+{
+    ivfc_ctx_t *ctx = (!usePatch ? &(romFsContext.ivfc_ctx) : &(bktrContext.ivfc_ctx));
+    u64 romfs_offset = (!usePatch ? romFsContext.romfs_offset : bktrContext.romfs_offset);
+    
+    if (!ctx->initialized || offset < romfs_offset || !data || !size || !out_failed_offset) return false;
+    
+    u64 block_size = ctx->level_block_size[IVFC_MAX_LEVEL - 1];
+    u64 data_level_size = ctx->level_size[IVFC_MAX_LEVEL - 1];
+    
+    // Offset relative to the start of the level 6 data
+    u64 rel_offset = (offset - romfs_offset);
+    if ((rel_offset + size) > data_level_size) return false;
+    
+    u64 block_idx = (rel_offset / block_size);
+    u64 last_block_idx = ((rel_offset + size - 1) / block_size);
+    
+    u8 block_hash[SHA256_HASH_SIZE];
+    const u8 *expected_hash = NULL;
+    
+    for(; block_idx <= last_block_idx; block_idx++)
+    {
+        u64 block_offset = (block_idx * block_size);
+        u64 block_data_size = (data_level_size - block_offset);
+        if (block_data_size > block_size) block_data_size = block_size;
+        
+        // Report the first byte from this block that's actually part of the provided data
+        *out_failed_offset = (offset + (block_offset > rel_offset ? (block_offset - rel_offset) : 0));
+        
+        expected_hash = getIvfcDataBlockHash(usePatch, block_idx);
+        if (!expected_hash) return false;
+        
+        if (block_offset >= rel_offset && (block_offset + block_size) <= (rel_offset + size))
+        {
+            // Full block within the provided data: hash it in place
+            sha256CalculateHash(block_hash, data + (block_offset - rel_offset), block_size);
+            if (memcmp(block_hash, expected_hash, SHA256_HASH_SIZE) != 0) return false;
+        } else {
+            // Partial block (either at the edges of the provided data or at the end of the RomFS section)
+            // Read it in full, verify it and compare the overlapping region
+            // The last block read this way is kept around, since consecutive reads will usually share it
+            if (!ctx->block_buf_valid || ctx->block_buf_idx != block_idx)
+            {
+                ctx->block_buf_valid = false;
+                
+                if (block_data_size < block_size) memset(ctx->block_buf + block_data_size, 0, block_size - block_data_size);
+                
+                if (!readRomFsSectionRawBlock(usePatch, ctx->level_offset[IVFC_MAX_LEVEL - 1] + block_offset, ctx->block_buf, block_data_size)) return false;
+                
+                sha256CalculateHash(block_hash, ctx->block_buf, block_size);
+                if (memcmp(block_hash, expected_hash, SHA256_HASH_SIZE) != 0) return false;
+                
+                ctx->block_buf_idx = block_idx;
+                ctx->block_buf_valid = true;
+            }
+            
+            u64 overlap_start = (block_offset > rel_offset ? block_offset : rel_offset);
+            u64 overlap_end = ((block_offset + block_data_size) < (rel_offset + size) ? (block_offset + block_data_size) : (rel_offset + size));
+            
+            if (memcmp(ctx->block_buf + (overlap_start - block_offset), data + (overlap_start - rel_offset), overlap_end - overlap_start) != 0) return false;
+        }
+    }
+    
+    return true;
+}
+
+void setupPfs0HashContext(pfs0_hash_ctx_t *ctx, nca_header_t *dec_nca_header, u8 section_index, u8 *decrypted_nca_keys)
+{
+    if (!ctx) return;
+    
+    freePfs0HashContext(ctx);
+    memset(ctx, 0, sizeof(pfs0_hash_ctx_t));
+    
+    if (!dec_nca_header || section_index >= 4 || !decrypted_nca_keys) return;
+    
+    u32 i;
+    pfs0_superblock_t *superblock = &(dec_nca_header->fs_headers[section_index].pfs0_superblock);
+    u64 section_offset = ((u64)dec_nca_header->section_entries[section_index].media_start_offset * (u64)MEDIA_UNIT_SIZE);
+    
+    // Generate initial CTR
+    unsigned char ctr[0x10];
+    u64 ofs = (section_offset >> 4);
+    
+    for(i = 0; i < 0x8; i++)
+    {
+        ctr[i] = dec_nca_header->fs_headers[section_index].section_ctr[0x08 - i - 1];
+        ctr[0x10 - i - 1] = (unsigned char)(ofs & 0xFF);
+        ofs >>= 8;
+    }
+    
+    u8 ctr_key[NCA_KEY_AREA_KEY_SIZE];
+    memcpy(ctr_key, decrypted_nca_keys + (NCA_KEY_AREA_KEY_SIZE * 2), NCA_KEY_AREA_KEY_SIZE);
+    aes128CtrContextCreate(&(ctx->aes_ctx), ctr_key, ctr);
+    
+    ctx->hash_table_offset = (section_offset + superblock->hash_table_offset);
+    ctx->hash_table_size = superblock->hash_table_size;
+    ctx->pfs0_offset = (section_offset + superblock->pfs0_offset);
+    ctx->pfs0_size = superblock->pfs0_size;
+    ctx->block_size = (u64)superblock->block_size;
+    memcpy(ctx->master_hash, superblock->master_hash, SHA256_HASH_SIZE);
+}
+
+bool initPfs0HashContext(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, pfs0_hash_ctx_t *ctx)
+{
+    if (!ncmStorage || !ncaId || !ctx)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: invalid parameters to initialize PFS0 hash context!", __func__);
+        return false;
+    }
+    
+    freePfs0HashContext(ctx);
+    
+    u64 block_cnt = (ctx->block_size ? ((ctx->pfs0_size + ctx->block_size - 1) / ctx->block_size) : 0);
+    
+    if (!ctx->block_size || ctx->block_size > NCA_CTR_BUFFER_SIZE || !ctx->pfs0_size || !ctx->hash_table_size || (block_cnt * SHA256_HASH_SIZE) > ctx->hash_table_size || ctx->hash_table_offset < NCA_FULL_HEADER_LENGTH || ctx->pfs0_offset < (ctx->hash_table_offset + ctx->hash_table_size))
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: invalid PFS0 hash table parameters!", __func__);
+        return false;
+    }
+    
+    u8 table_hash[SHA256_HASH_SIZE];
+    
+    ctx->hash_table = malloc(ctx->hash_table_size);
+    ctx->block_buf = malloc(ctx->block_size);
+    
+    if (!ctx->hash_table || !ctx->block_buf)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to allocate memory for the PFS0 hash table!", __func__);
+        freePfs0HashContext(ctx);
+        return false;
+    }
+    
+    if (!processNcaCtrSectionBlock(ncmStorage, ncaId, &(ctx->aes_ctx), ctx->hash_table_offset, ctx->hash_table, ctx->hash_table_size, false))
+    {
+        breaks++;
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: failed to read PFS0 hash table!", __func__);
+        freePfs0HashContext(ctx);
+        return false;
+    }
+    
+    sha256CalculateHash(table_hash, ctx->hash_table, ctx->hash_table_size);
+    
+    if (memcmp(table_hash, ctx->master_hash, SHA256_HASH_SIZE) != 0)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: PFS0 hash table doesn't match the master hash from the NCA section header!", __func__);
+        freePfs0HashContext(ctx);
+        return false;
+    }
+    
+    ctx->cur_block_active = false;
+    ctx->initialized = true;
+    
+    return true;
+}
+
+void freePfs0HashContext(pfs0_hash_ctx_t *ctx)
+{
+    if (!ctx) return;
+    
+    if (ctx->hash_table)
+    {
+        free(ctx->hash_table);
+        ctx->hash_table = NULL;
+    }
+    
+    if (ctx->block_buf)
+    {
+        free(ctx->block_buf);
+        ctx->block_buf = NULL;
+    }
+    
+    ctx->cur_block_active = false;
+    ctx->initialized = false;
+}
+
+static void decryptPfs0SectionData(pfs0_hash_ctx_t *ctx, u64 offset, u8 *data, u64 size)
+{
+    unsigned char ctr[0x10];
+    u8 skip[0x10] = {0};
+    
+    u64 block_start_offset = (offset - (offset % 0x10));
+    
+    memcpy(ctr, ctx->aes_ctx.ctr, 0x10);
+    nca_update_ctr(ctr, block_start_offset);
+    aes128CtrContextResetCtr(&(ctx->aes_ctx), ctr);
+    
+    // Discard the keystream bytes preceding our offset
+    if (offset != block_start_offset) aes128CtrCrypt(&(ctx->aes_ctx), skip, skip, offset - block_start_offset);
+    
+    aes128CtrCrypt(&(ctx->aes_ctx), data, data, size);
+}
+
+// Feeds decrypted data to the running hash, verifying each data block as soon as it's complete
+static bool updatePfs0HashContext(pfs0_hash_ctx_t *ctx, const u8 *data, u64 size, u64 *out_failed_offset)
+{
+    u8 block_hash[SHA256_HASH_SIZE];
+    
+    while(size > 0)
+    {
+        u64 block_offset = (ctx->cur_block_idx * ctx->block_size);
+        
+        // The last block is hashed using its actual size
+        u64 block_data_size = (ctx->pfs0_size - block_offset);
+        if (block_data_size > ctx->block_size) block_data_size = ctx->block_size;
+        
+        u64 chunk_size = (block_data_size - ctx->cur_block_fill);
+        if (chunk_size > size) chunk_size = size;
+        
+        sha256ContextUpdate(&(ctx->sha_ctx), data, chunk_size);
+        
+        ctx->cur_block_fill += chunk_size;
+        data += chunk_size;
+        size -= chunk_size;
+        
+        if (ctx->cur_block_fill < block_data_size) break;
+        
+        sha256ContextGetHash(&(ctx->sha_ctx), block_hash);
+        
+        if (memcmp(block_hash, ctx->hash_table + (ctx->cur_block_idx * SHA256_HASH_SIZE), SHA256_HASH_SIZE) != 0)
+        {
+            *out_failed_offset = (ctx->pfs0_offset + block_offset);
+            ctx->cur_block_active = false;
+            return false;
+        }
+        
+        ctx->cur_block_idx++;
+        ctx->cur_block_fill = 0;
+        sha256ContextCreate(&(ctx->sha_ctx));
+        
+        if ((block_offset + block_data_size) >= ctx->pfs0_size) ctx->cur_block_active = false;
+    }
+    
+    return true;
+}
+
+// Reads and hashes "size" bytes located right after the last byte fed to the current data block
+static bool updatePfs0HashContextFromNca(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, pfs0_hash_ctx_t *ctx, u64 size, u64 *out_failed_offset)
+{
+    u64 block_offset = (ctx->cur_block_idx * ctx->block_size);
+    
+    *out_failed_offset = (ctx->pfs0_offset + block_offset);
+    
+    if (!processNcaCtrSectionBlock(ncmStorage, ncaId, &(ctx->aes_ctx), ctx->pfs0_offset + block_offset + ctx->cur_block_fill, ctx->block_buf, size, false))
+    {
+        ctx->cur_block_active = false;
+        return false;
+    }
+    
+    return updatePfs0HashContext(ctx, ctx->block_buf, size, out_failed_offset);
+}
+
+bool verifyPfs0SectionBlock(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, pfs0_hash_ctx_t *ctx, u64 offset, const u8 *data, u64 size, bool encrypted, u64 *out_failed_offset)
+{
+    if (!ncmStorage || !ncaId || !ctx || !ctx->initialized || !data || !size || !out_failed_offset) return false;
+    
+    u64 pfs0_end_offset = (ctx->pfs0_offset + ctx->pfs0_size);
+    
+    // Skip data outside the PFS0 partition
+    if ((offset + size) <= ctx->pfs0_offset || offset >= pfs0_end_offset) return true;
+    
+    if (offset < ctx->pfs0_offset)
+    {
+        data += (ctx->pfs0_offset - offset);
+        size -= (ctx->pfs0_offset - offset);
+        offset = ctx->pfs0_offset;
+    }
+    
+    if ((offset + size) > pfs0_end_offset) size = (pfs0_end_offset - offset);
+    
+    u64 rel_offset = (offset - ctx->pfs0_offset);
+    
+    // Restart the running hash if this data isn't contiguous to the previously fed data
+    if (!ctx->cur_block_active || rel_offset != ((ctx->cur_block_idx * ctx->block_size) + ctx->cur_block_fill))
+    {
+        if (ctx->cur_block_active && !finishPfs0SectionVerification(ncmStorage, ncaId, ctx, out_failed_offset)) return false;
+        
+        ctx->cur_block_idx = (rel_offset / ctx->block_size);
+        ctx->cur_block_fill = 0;
+        sha256ContextCreate(&(ctx->sha_ctx));
+        ctx->cur_block_active = true;
+        
+        // Hash the bytes from the start of this data block up to our offset
+        if (rel_offset % ctx->block_size)
+        {
+            if (!updatePfs0HashContextFromNca(ncmStorage, ncaId, ctx, rel_offset % ctx->block_size, out_failed_offset)) return false;
+        }
+    }
+    
+    if (!encrypted) return updatePfs0HashContext(ctx, data, size, out_failed_offset);
+    
+    // Decrypt the provided data in chunks using the NCA AES-CTR buffer
+    u64 chunk_size;
+    
+    while(size > 0)
+    {
+        chunk_size = (size > NCA_CTR_BUFFER_SIZE ? NCA_CTR_BUFFER_SIZE : size);
+        
+        memcpy(ncaCtrBuf, data, chunk_size);
+        decryptPfs0SectionData(ctx, offset, ncaCtrBuf, chunk_size);
+        
+        if (!updatePfs0HashContext(ctx, ncaCtrBuf, chunk_size, out_failed_offset)) return false;
+        
+        data += chunk_size;
+        offset += chunk_size;
+        size -= chunk_size;
+    }
+    
+    return true;
+}
+
+bool finishPfs0SectionVerification(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, pfs0_hash_ctx_t *ctx, u64 *out_failed_offset)
+{
+    if (!ncmStorage || !ncaId || !ctx || !ctx->initialized || !out_failed_offset) return false;
+    
+    if (!ctx->cur_block_active) return true;
+    
+    if (!ctx->cur_block_fill)
+    {
+        // Nothing has been fed to the current data block yet
+        ctx->cur_block_active = false;
+        return true;
+    }
+    
+    u64 block_offset = (ctx->cur_block_idx * ctx->block_size);
+    
+    u64 block_data_size = (ctx->pfs0_size - block_offset);
+    if (block_data_size > ctx->block_size) block_data_size = ctx->block_size;
+    
+    if (!updatePfs0HashContextFromNca(ncmStorage, ncaId, ctx, block_data_size - ctx->cur_block_fill, out_failed_offset)) return false;
+    
+    ctx->cur_block_active = false;
+    
+    return true;
+}
+
 bool encryptNcaHeader(nca_header_t *input, u8 *outBuf, u64 outBufSize)
 {
     if (!input || !outBuf || !outBufSize || outBufSize < NCA_FULL_HEADER_LENGTH || (__builtin_bswap32(input->magic) != NCA3_MAGIC && __builtin_bswap32(input->magic) != NCA2_MAGIC))
@@ -1414,8 +2008,9 @@ bool retrieveCnmtNcaData(NcmStorageId curStorageId, u8 *ncaBuf, cnmt_xml_program
             
             if (memcmp(xml_content_info[i].nca_id, cnt_record.nca_id, SHA256_HASH_SIZE / 2) != 0) continue;
             
-            // Save content record offset
+            // Save content record offset and original hash
             xml_content_info[i].cnt_record_offset = (j * sizeof(cnmt_content_record));
+            memcpy(xml_content_info[i].record_hash, cnt_record.hash, SHA256_HASH_SIZE);
             
             // Empty CNMT content record
             memset(section_data + title_cnmt_offset + sizeof(cnmt_header) + (u64)title_cnmt_header.extended_header_size + (j * sizeof(cnmt_content_record)), 0, sizeof(cnmt_content_record));
@@ -1690,6 +2285,9 @@ bool parseExeFsEntryFromNca(NcmContentStorage *ncmStorage, const NcmContentId *n
     exeFsContext.exefs_str_table = nca_pfs0_str_table;
     exeFsContext.exefs_data_offset = nca_pfs0_data_offset;
     
+    // Only store the PFS0 hash table parameters here. The hash table itself is only read if needed
+    setupPfs0HashContext(&(exeFsContext.hash_ctx), dec_nca_header, exefs_index, decrypted_nca_keys);
+    
     return true;
 }
 
@@ -1861,6 +2459,7 @@ int parseRomFsEntryFromNca(NcmContentStorage *ncmStorage, const NcmContentId *nc
     memcpy(&(romFsContext.aes_ctx), &aes_ctx, sizeof(Aes128CtrContext));
     romFsContext.section_offset = section_offset;
     romFsContext.section_size = section_size;
+    memcpy(&(romFsContext.ivfc_header), &(dec_nca_header->fs_headers[romfs_index].romfs_superblock.ivfc_header), sizeof(ivfc_hdr_t));
     romFsContext.romfs_offset = romfs_offset;
     romFsContext.romfs_size = romfs_size;
     romFsContext.romfs_dirtable_offset = romfs_dirtable_offset;
@@ -2185,8 +2784,7 @@ bool generateProgramInfoXml(NcmContentStorage *ncmStorage, const NcmContentId *n
     
     Aes128CtrContext aes_ctx;
     
-    char *programInfoXml = NULL;
-    char tmp[NAME_BUF_LEN] = {'\0'};
+    xml_buffer_t programInfoXml = { NULL, 0, 0, false };
     
     u32 npdmEntry = 0;
     npdm_t npdm_header;
@@ -2272,17 +2870,16 @@ bool generateProgramInfoXml(NcmContentStorage *ncmStorage, const NcmContentId *n
     
     nca_pfs0_data_offset = (nca_pfs0_str_table_offset + (u64)nca_pfs0_header.str_table_size);
     
-    // Allocate memory for the programinfo.xml contents, making sure there's enough space
-    programInfoXml = calloc(NSP_XML_BUFFER_SIZE, sizeof(char));
-    if (!programInfoXml)
+    // Allocate memory for the programinfo.xml contents. The buffer grows as needed
+    if (!xmlBufferInit(&programInfoXml))
     {
         uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to allocate memory for the \"programinfo.xml\" contents!", __func__);
         goto out;
     }
     
-    sprintf(programInfoXml, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n" \
-                            "<ProgramInfo>\n" \
-                            "  <SdkVersion>%u_%u_%u</SdkVersion>\n", dec_nca_header->sdk_major, dec_nca_header->sdk_minor, dec_nca_header->sdk_micro);
+    xmlBufferAppendFormatted(&programInfoXml, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n" \
+                                              "<ProgramInfo>\n" \
+                                              "  <SdkVersion>%u_%u_%u</SdkVersion>\n", dec_nca_header->sdk_major, dec_nca_header->sdk_minor, dec_nca_header->sdk_micro);
     
     // Retrieve the main.npdm contents
     bool found_npdm = false;
@@ -2336,11 +2933,10 @@ bool generateProgramInfoXml(NcmContentStorage *ncmStorage, const NcmContentId *n
     // If we're dealing with a gamecard title, replace the ACID public key with the patched one
     if (useCustomAcidRsaPubKey) memcpy(npdm_acid_section + (u64)NPDM_SIGNATURE_SIZE, rsa_get_public_key(), (u64)NPDM_SIGNATURE_SIZE);
     
-    sprintf(tmp, "  <BuildTarget>%u</BuildTarget>\n", ((npdm_header.mmu_flags & 0x01) ? 64 : 32));
-    strcat(programInfoXml, tmp);
+    xmlBufferAppendFormatted(&programInfoXml, "  <BuildTarget>%u</BuildTarget>\n", ((npdm_header.mmu_flags & 0x01) ? 64 : 32));
     
     // Default this one to Release
-    strcat(programInfoXml, "  <BuildType>Release</BuildType>\n");
+    xmlBufferAppend(&programInfoXml, "  <BuildType>Release</BuildType>\n");
     
     // Retrieve the Base64 conversion length for the whole ACID section
     mbedtls_base64_encode(NULL, 0, &npdm_acid_section_b64_size, npdm_acid_section, (u64)npdm_header.acid_size);
@@ -2364,26 +2960,24 @@ bool generateProgramInfoXml(NcmContentStorage *ncmStorage, const NcmContentId *n
         goto out;
     }
     
-    strcat(programInfoXml, "  <Desc>");
-    strcat(programInfoXml, npdm_acid_section_b64);
-    strcat(programInfoXml, "</Desc>\n");
+    xmlBufferAppend(&programInfoXml, "  <Desc>");
+    xmlBufferAppend(&programInfoXml, npdm_acid_section_b64);
+    xmlBufferAppend(&programInfoXml, "</Desc>\n");
     
     // TO-DO: Add more ACID flags?
     
     acid_flags = *((u32*)(&(npdm_acid_section[0x20C])));
     
-    strcat(programInfoXml, "  <DescFlags>\n");
+    xmlBufferAppend(&programInfoXml, "  <DescFlags>\n");
     
-    sprintf(tmp, "    <Production>%s</Production>\n", ((acid_flags & 0x01) ? "true" : "false"));
-    strcat(programInfoXml, tmp);
+    xmlBufferAppendFormatted(&programInfoXml, "    <Production>%s</Production>\n", ((acid_flags & 0x01) ? "true" : "false"));
     
-    sprintf(tmp, "    <UnqualifiedApproval>%s</UnqualifiedApproval>\n", ((acid_flags & 0x02) ? "true" : "false"));
-    strcat(programInfoXml, tmp);
+    xmlBufferAppendFormatted(&programInfoXml, "    <UnqualifiedApproval>%s</UnqualifiedApproval>\n", ((acid_flags & 0x02) ? "true" : "false"));
     
-    strcat(programInfoXml, "  </DescFlags>\n");
+    xmlBufferAppend(&programInfoXml, "  </DescFlags>\n");
     
     // Middleware list
-    strcat(programInfoXml, "  <MiddlewareList>\n");
+    xmlBufferAppend(&programInfoXml, "  <MiddlewareList>\n");
     
     for(i = 0; i < nca_pfs0_header.file_cnt; i++)
     {
@@ -2403,7 +2997,7 @@ bool generateProgramInfoXml(NcmContentStorage *ncmStorage, const NcmContentId *n
         if (__builtin_bswap32(nsoHeader.magic) != NSO_MAGIC) continue;
         
         // Retrieve middleware list from this NSO
-        if (!retrieveMiddlewareListFromNso(ncmStorage, ncaId, &aes_ctx, curFilename, curFileOffset, &nsoHeader, programInfoXml))
+        if (!retrieveMiddlewareListFromNso(ncmStorage, ncaId, &aes_ctx, curFilename, curFileOffset, &nsoHeader, &programInfoXml))
         {
             proceed = false;
             break;
@@ -2412,14 +3006,14 @@ bool generateProgramInfoXml(NcmContentStorage *ncmStorage, const NcmContentId *n
     
     if (!proceed) goto out;
     
-    strcat(programInfoXml, "  </MiddlewareList>\n");
+    xmlBufferAppend(&programInfoXml, "  </MiddlewareList>\n");
     
     // Leave these fields empty (for now)
-    strcat(programInfoXml, "  <DebugApiList />\n");
-    strcat(programInfoXml, "  <PrivateApiList />\n");
+    xmlBufferAppend(&programInfoXml, "  <DebugApiList />\n");
+    xmlBufferAppend(&programInfoXml, "  <PrivateApiList />\n");
     
     // Symbols list from main NSO
-    strcat(programInfoXml, "  <UnresolvedApiList>\n");
+    xmlBufferAppend(&programInfoXml, "  <UnresolvedApiList>\n");
     
     for(i = 0; i < nca_pfs0_header.file_cnt; i++)
     {
@@ -2439,31 +3033,39 @@ bool generateProgramInfoXml(NcmContentStorage *ncmStorage, const NcmContentId *n
         if (strlen(curFilename) != 4 || strncmp(curFilename, "main", 4) != 0 || __builtin_bswap32(nsoHeader.magic) != NSO_MAGIC) continue;
         
         // Retrieve symbols list from main NSO
-        if (!retrieveSymbolsListFromNso(ncmStorage, ncaId, &aes_ctx, curFilename, curFileOffset, &nsoHeader, programInfoXml)) proceed = false;
+        if (!retrieveSymbolsListFromNso(ncmStorage, ncaId, &aes_ctx, curFilename, curFileOffset, &nsoHeader, &programInfoXml)) proceed = false;
         
         break;
     }
     
     if (!proceed) goto out;
     
-    strcat(programInfoXml, "  </UnresolvedApiList>\n");
+    xmlBufferAppend(&programInfoXml, "  </UnresolvedApiList>\n");
     
     // Leave this field empty (for now)
-    strcat(programInfoXml, "  <FsAccessControlData />\n");
+    xmlBufferAppend(&programInfoXml, "  <FsAccessControlData />\n");
     
-    strcat(programInfoXml, "</ProgramInfo>");
+    xmlBufferAppend(&programInfoXml, "</ProgramInfo>");
     
-    *outBuf = programInfoXml;
-    *outBufSize = strlen(programInfoXml);
+    if (programInfoXml.error)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to reallocate memory for the \"programinfo.xml\" contents!", __func__);
+        goto out;
+    }
+    
+    *outBuf = xmlBufferDetach(&programInfoXml, outBufSize);
     
     success = true;
     
 out:
+    // Decoded NSOs are only shared within a single programinfo.xml generation
+    freeNsoImageCache();
+    
     if (npdm_acid_section_b64) free(npdm_acid_section_b64);
     
     if (npdm_acid_section) free(npdm_acid_section);
     
-    if (!success && programInfoXml) free(programInfoXml);
+    xmlBufferFree(&programInfoXml);
     
     if (nca_pfs0_str_table) free(nca_pfs0_str_table);
     
@@ -2926,7 +3528,7 @@ bool retrieveNacpDataFromNca(NcmContentStorage *ncmStorage, const NcmContentId *
     bool found_nacp = false, success = false;
     
     nacp_t controlNacp;
-    char *nacpXml = NULL;
+    xml_buffer_t nacpXml = { NULL, 0, 0, false };
     
     u8 i = 0, j = 0;
     char tmp[NAME_BUF_LEN] = {'\0'};
@@ -2936,9 +3538,12 @@ bool retrieveNacpDataFromNca(NcmContentStorage *ncmStorage, const NcmContentId *
     nacp_icons_ctx *nacpIcons = NULL;
     
     bool found_icon = false;
-    u8 languageIconHash[SHA256_HASH_SIZE];
     char languageIconHashStr[SHA256_HASH_SIZE + 1] = {'\0'};
     
+    u8 *iconBuf = NULL, *tmpIconBuf = NULL;
+    u64 iconBufSize = 0;
+    u8 k;
+    
     char ncaIdStr[SHA256_HASH_SIZE + 1] = {'\0'};
     convertDataToHexString(ncaId->c, 0x10, ncaIdStr, 0x21);
     
@@ -2978,147 +3583,130 @@ bool retrieveNacpDataFromNca(NcmContentStorage *ncmStorage, const NcmContentId *
         goto out;
     }
     
-    // Make sure that the output buffer for our NACP XML is big enough
-    nacpXml = calloc(NSP_XML_BUFFER_SIZE, sizeof(char));
-    if (!nacpXml)
+    // Allocate memory for the NACP XML. The buffer grows as needed
+    if (!xmlBufferInit(&nacpXml))
     {
         uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to allocate memory for the NACP XML!", __func__);
         goto out;
     }
     
-    sprintf(nacpXml, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n" \
-                     "<Application>\n");
+    xmlBufferAppend(&nacpXml, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n" \
+                              "<Application>\n");
     
     for(i = 0; i < 0x10; i++)
     {
         if (strlen(controlNacp.titles[i].name) || strlen(controlNacp.titles[i].publisher))
         {
-            sprintf(tmp, "  <Title>\n" \
-                         "    <Language>%s</Language>\n" \
-                         "    <Name>%s</Name>\n" \
-                         "    <Publisher>%s</Publisher>\n" \
-                         "  </Title>\n", \
-                         getNacpLangName(i), \
-                         controlNacp.titles[i].name, \
-                         controlNacp.titles[i].publisher);
+            xmlBufferAppendFormatted(&nacpXml, "  <Title>\n" \
+                                               "    <Language>%s</Language>\n" \
+                                               "    <Name>", \
+                                               getNacpLangName(i));
             
-            strcat(nacpXml, tmp);
+            xmlBufferAppendEscaped(&nacpXml, controlNacp.titles[i].name, sizeof(controlNacp.titles[i].name));
+            xmlBufferAppend(&nacpXml, "</Name>\n" \
+                                      "    <Publisher>");
+            xmlBufferAppendEscaped(&nacpXml, controlNacp.titles[i].publisher, sizeof(controlNacp.titles[i].publisher));
+            xmlBufferAppend(&nacpXml, "</Publisher>\n" \
+                                      "  </Title>\n");
         }
     }
     
     if (strlen(controlNacp.isbn))
     {
-        sprintf(tmp, "  <Isbn>%s</Isbn>\n", controlNacp.isbn);
-        strcat(nacpXml, tmp);
+        xmlBufferAppend(&nacpXml, "  <Isbn>");
+        xmlBufferAppendEscaped(&nacpXml, controlNacp.isbn, sizeof(controlNacp.isbn));
+        xmlBufferAppend(&nacpXml, "</Isbn>\n");
     } else {
-        strcat(nacpXml, "  <Isbn />\n");
+        xmlBufferAppend(&nacpXml, "  <Isbn />\n");
     }
     
-    sprintf(tmp, "  <StartupUserAccount>%s</StartupUserAccount>\n", getNacpStartupUserAccount(controlNacp.startup_user_account));
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <StartupUserAccount>%s</StartupUserAccount>\n", getNacpStartupUserAccount(controlNacp.startup_user_account));
     
-    sprintf(tmp, "  <UserAccountSwitchLock>%s</UserAccountSwitchLock>\n", getNacpUserAccountSwitchLock(controlNacp.user_account_switch_lock));
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <UserAccountSwitchLock>%s</UserAccountSwitchLock>\n", getNacpUserAccountSwitchLock(controlNacp.user_account_switch_lock));
     
-    strcat(nacpXml, "  <ParentalControl>");
+    xmlBufferAppend(&nacpXml, "  <ParentalControl>");
     
     memcpy(&flag, &(controlNacp.parental_control_flag), sizeof(u32));
     if (flag != 0)
     {
-        if (controlNacp.parental_control_flag.ParentalControlFlag_FreeCommunication) strcat(nacpXml, "FreeCommunication");
+        if (controlNacp.parental_control_flag.ParentalControlFlag_FreeCommunication) xmlBufferAppend(&nacpXml, "FreeCommunication");
     } else {
-        strcat(nacpXml, "None");
+        xmlBufferAppend(&nacpXml, "None");
     }
     
-    strcat(nacpXml, "</ParentalControl>\n");
+    xmlBufferAppend(&nacpXml, "</ParentalControl>\n");
     
     for(i = 0; i < 0x10; i++)
     {
         char *str = getNacpSupportedLanguageFlag(&(controlNacp.supported_language_flag), i);
         if (!str) continue;
         
-        sprintf(tmp, "  <SupportedLanguage>%s</SupportedLanguage>\n", str);
-        strcat(nacpXml, tmp);
+        xmlBufferAppendFormatted(&nacpXml, "  <SupportedLanguage>%s</SupportedLanguage>\n", str);
         
         nacpIconCnt++;
     }
     
-    sprintf(tmp, "  <Screenshot>%s</Screenshot>\n", getNacpScreenshot(controlNacp.screenshot));
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <Screenshot>%s</Screenshot>\n", getNacpScreenshot(controlNacp.screenshot));
     
-    sprintf(tmp, "  <VideoCapture>%s</VideoCapture>\n", getNacpVideoCapture(controlNacp.video_capture));
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <VideoCapture>%s</VideoCapture>\n", getNacpVideoCapture(controlNacp.video_capture));
     
-    sprintf(tmp, "  <PresenceGroupId>0x%016lx</PresenceGroupId>\n", controlNacp.presence_group_id);
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <PresenceGroupId>0x%016lx</PresenceGroupId>\n", controlNacp.presence_group_id);
     
-    sprintf(tmp, "  <DisplayVersion>%s</DisplayVersion>\n", controlNacp.display_version);
-    strcat(nacpXml, tmp);
+    xmlBufferAppend(&nacpXml, "  <DisplayVersion>");
+    xmlBufferAppendEscaped(&nacpXml, controlNacp.display_version, sizeof(controlNacp.display_version));
+    xmlBufferAppend(&nacpXml, "</DisplayVersion>\n");
     
     for(i = 0; i < 0x20; i++)
     {
         u8 *ptr = ((u8*)(&(controlNacp.rating_ages)) + i);
         if (*ptr == 0xFF) continue;
         
-        sprintf(tmp, "  <Rating>\n" \
-                     "    <Organization>%s</Organization>\n" \
-                     "    <Age>%u</Age>\n" \
-                     "  </Rating>\n", \
-                     getNacpRatingAgeOrganization(i), \
-                     *ptr);
-        
-        strcat(nacpXml, tmp);
+        xmlBufferAppendFormatted(&nacpXml, "  <Rating>\n" \
+                                           "    <Organization>%s</Organization>\n" \
+                                           "    <Age>%u</Age>\n" \
+                                           "  </Rating>\n", \
+                                           getNacpRatingAgeOrganization(i), \
+                                           *ptr);
     }
     
-    sprintf(tmp, "  <DataLossConfirmation>%s</DataLossConfirmation>\n", getNacpDataLossConfirmation(controlNacp.data_loss_confirmation));
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <DataLossConfirmation>%s</DataLossConfirmation>\n", getNacpDataLossConfirmation(controlNacp.data_loss_confirmation));
     
-    sprintf(tmp, "  <PlayLogPolicy>%s</PlayLogPolicy>\n", getNacpPlayLogPolicy(controlNacp.play_log_policy));
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <PlayLogPolicy>%s</PlayLogPolicy>\n", getNacpPlayLogPolicy(controlNacp.play_log_policy));
     
-    sprintf(tmp, "  <SaveDataOwnerId>0x%016lx</SaveDataOwnerId>\n", controlNacp.save_data_owner_id);
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <SaveDataOwnerId>0x%016lx</SaveDataOwnerId>\n", controlNacp.save_data_owner_id);
     
-    sprintf(tmp, "  <UserAccountSaveDataSize>0x%016lx</UserAccountSaveDataSize>\n", controlNacp.user_account_save_data_size);
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <UserAccountSaveDataSize>0x%016lx</UserAccountSaveDataSize>\n", controlNacp.user_account_save_data_size);
     
-    sprintf(tmp, "  <UserAccountSaveDataJournalSize>0x%016lx</UserAccountSaveDataJournalSize>\n", controlNacp.user_account_save_data_journal_size);
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <UserAccountSaveDataJournalSize>0x%016lx</UserAccountSaveDataJournalSize>\n", controlNacp.user_account_save_data_journal_size);
     
-    sprintf(tmp, "  <DeviceSaveDataSize>0x%016lx</DeviceSaveDataSize>\n", controlNacp.device_save_data_size);
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <DeviceSaveDataSize>0x%016lx</DeviceSaveDataSize>\n", controlNacp.device_save_data_size);
     
-    sprintf(tmp, "  <DeviceSaveDataJournalSize>0x%016lx</DeviceSaveDataJournalSize>\n", controlNacp.device_save_data_journal_size);
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <DeviceSaveDataJournalSize>0x%016lx</DeviceSaveDataJournalSize>\n", controlNacp.device_save_data_journal_size);
     
-    sprintf(tmp, "  <BcatDeliveryCacheStorageSize>0x%016lx</BcatDeliveryCacheStorageSize>\n", controlNacp.bcat_delivery_cache_storage_size);
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <BcatDeliveryCacheStorageSize>0x%016lx</BcatDeliveryCacheStorageSize>\n", controlNacp.bcat_delivery_cache_storage_size);
     
     if (strlen(controlNacp.application_error_code_category))
     {
-        sprintf(tmp, "  <ApplicationErrorCodeCategory>%s</ApplicationErrorCodeCategory>\n", controlNacp.application_error_code_category);
-        strcat(nacpXml, tmp);
+        xmlBufferAppend(&nacpXml, "  <ApplicationErrorCodeCategory>");
+        xmlBufferAppendEscaped(&nacpXml, controlNacp.application_error_code_category, sizeof(controlNacp.application_error_code_category));
+        xmlBufferAppend(&nacpXml, "</ApplicationErrorCodeCategory>\n");
     } else {
-        strcat(nacpXml, "  <ApplicationErrorCodeCategory />\n");
+        xmlBufferAppend(&nacpXml, "  <ApplicationErrorCodeCategory />\n");
     }
     
-    sprintf(tmp, "  <AddOnContentBaseId>0x%016lx</AddOnContentBaseId>\n", controlNacp.add_on_content_base_id);
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <AddOnContentBaseId>0x%016lx</AddOnContentBaseId>\n", controlNacp.add_on_content_base_id);
     
-    sprintf(tmp, "  <LogoType>%s</LogoType>\n", getNacpLogoType(controlNacp.logo_type));
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <LogoType>%s</LogoType>\n", getNacpLogoType(controlNacp.logo_type));
     
     for(i = 0; i < 0x8; i++)
     {
         if (controlNacp.local_communication_ids[i] != 0)
         {
-            sprintf(tmp, "  <LocalCommunicationId>0x%016lx</LocalCommunicationId>\n", controlNacp.local_communication_ids[i]);
-            strcat(nacpXml, tmp);
+            xmlBufferAppendFormatted(&nacpXml, "  <LocalCommunicationId>0x%016lx</LocalCommunicationId>\n", controlNacp.local_communication_ids[i]);
         }
     }
     
-    sprintf(tmp, "  <LogoHandling>%s</LogoHandling>\n", getNacpLogoHandling(controlNacp.logo_handling));
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <LogoHandling>%s</LogoHandling>\n", getNacpLogoHandling(controlNacp.logo_handling));
     
     if (nacpIconCnt)
     {
@@ -3137,7 +3725,6 @@ bool retrieveNacpDataFromNca(NcmContentStorage *ncmStorage, const NcmContentId *
             // Retrieve the icon file for this language and calculate its SHA-256 checksum
             found_icon = false;
             
-            memset(languageIconHash, 0, SHA256_HASH_SIZE);
             memset(languageIconHashStr, 0, SHA256_HASH_SIZE + 1);
             
             entryOffset = 0;
@@ -3162,155 +3749,166 @@ bool retrieveNacpDataFromNca(NcmContentStorage *ncmStorage, const NcmContentId *
                 continue;
             }
             
-            strcat(nacpXml, "  <Icon>\n");
+            xmlBufferAppend(&nacpXml, "  <Icon>\n");
             
-            sprintf(tmp, "    <Language>%s</Language>\n", getNacpLangName(i));
-            strcat(nacpXml, tmp);
+            xmlBufferAppendFormatted(&nacpXml, "    <Language>%s</Language>\n", getNacpLangName(i));
             
             // Fill details for our NACP icon context
             sprintf(nacpIcons[j].filename, "%s.nx.%s.jpg", ncaIdStr, getNacpLangName(i)); // Temporary, the NCA ID is subject to change
+            memcpy(&(nacpIcons[j].nca_id), ncaId, sizeof(NcmContentId));
+            memcpy(&(nacpIcons[j].aes_ctx), &(romFsContext.aes_ctx), sizeof(Aes128CtrContext));
+            nacpIcons[j].icon_offset = (romFsContext.romfs_filedata_offset + entry->dataOff);
             nacpIcons[j].icon_size = entry->dataSize;
             
-            if (!processNcaCtrSectionBlock(ncmStorage, ncaId, &(romFsContext.aes_ctx), romFsContext.romfs_filedata_offset + entry->dataOff, nacpIcons[j].icon_data, nacpIcons[j].icon_size, false))
+            // Most languages share the same icon, which the RomFS stores only once
+            // Reuse the checksum from a previous language if this one points to the same data
+            for(k = 0; k < j; k++)
             {
-                breaks++;
-                uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: failed to read \"%s\" from RomFS section in Control NCA!", __func__, tmp);
-                goto out;
+                if (nacpIcons[k].icon_offset == nacpIcons[j].icon_offset && nacpIcons[k].icon_size == nacpIcons[j].icon_size) break;
             }
             
-            sha256CalculateHash(languageIconHash, nacpIcons[j].icon_data, nacpIcons[j].icon_size);
+            if (k < j)
+            {
+                memcpy(nacpIcons[j].icon_hash, nacpIcons[k].icon_hash, SHA256_HASH_SIZE);
+            } else {
+                // Use a temporary buffer to calculate the checksum. It only grows if a bigger icon is found
+                if (nacpIcons[j].icon_size > iconBufSize)
+                {
+                    tmpIconBuf = realloc(iconBuf, nacpIcons[j].icon_size);
+                    if (!tmpIconBuf)
+                    {
+                        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to allocate memory for \"%s\" from RomFS section in Control NCA!", __func__, tmp);
+                        goto out;
+                    }
+                    
+                    iconBuf = tmpIconBuf;
+                    tmpIconBuf = NULL;
+                    iconBufSize = nacpIcons[j].icon_size;
+                }
+                
+                if (!processNcaCtrSectionBlock(ncmStorage, ncaId, &(romFsContext.aes_ctx), nacpIcons[j].icon_offset, iconBuf, nacpIcons[j].icon_size, false))
+                {
+                    breaks++;
+                    uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: failed to read \"%s\" from RomFS section in Control NCA!", __func__, tmp);
+                    goto out;
+                }
+                
+                sha256CalculateHash(nacpIcons[j].icon_hash, iconBuf, nacpIcons[j].icon_size);
+            }
             
             // Only retrieve the first half from the SHA-256 checksum
-            convertDataToHexString(languageIconHash, SHA256_HASH_SIZE / 2, languageIconHashStr, SHA256_HASH_SIZE + 1);
+            convertDataToHexString(nacpIcons[j].icon_hash, SHA256_HASH_SIZE / 2, languageIconHashStr, SHA256_HASH_SIZE + 1);
             
             // Now print the hash
-            sprintf(tmp, "    <NxIconHash>%s</NxIconHash>\n", languageIconHashStr);
-            strcat(nacpXml, tmp);
+            xmlBufferAppendFormatted(&nacpXml, "    <NxIconHash>%s</NxIconHash>\n", languageIconHashStr);
             
-            strcat(nacpXml, "  </Icon>\n");
+            xmlBufferAppend(&nacpXml, "  </Icon>\n");
             
             j++;
         }
     }
     
-    sprintf(tmp, "  <SeedForPseudoDeviceId>0x%016lx</SeedForPseudoDeviceId>\n", controlNacp.seed_for_pseudo_device_id);
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <SeedForPseudoDeviceId>0x%016lx</SeedForPseudoDeviceId>\n", controlNacp.seed_for_pseudo_device_id);
     
     if (strlen(controlNacp.bcat_passphrase))
     {
-        sprintf(tmp, "  <BcatPassphrase>%s</BcatPassphrase>\n", controlNacp.bcat_passphrase);
-        strcat(nacpXml, tmp);
+        xmlBufferAppend(&nacpXml, "  <BcatPassphrase>");
+        xmlBufferAppendEscaped(&nacpXml, controlNacp.bcat_passphrase, sizeof(controlNacp.bcat_passphrase));
+        xmlBufferAppend(&nacpXml, "</BcatPassphrase>\n");
     } else {
-        strcat(nacpXml, "  <BcatPassphrase />\n");
+        xmlBufferAppend(&nacpXml, "  <BcatPassphrase />\n");
     }
     
-    strcat(nacpXml, "  <StartupUserAccountOption>");
+    xmlBufferAppend(&nacpXml, "  <StartupUserAccountOption>");
     
     if (*((u8*)&(controlNacp.startup_user_account_option)) != 0)
     {
-        if (controlNacp.startup_user_account_option.StartupUserAccountOptionFlag_IsOptional) strcat(nacpXml, "IsOptional");
+        if (controlNacp.startup_user_account_option.StartupUserAccountOptionFlag_IsOptional) xmlBufferAppend(&nacpXml, "IsOptional");
     } else {
-        strcat(nacpXml, "None");
+        xmlBufferAppend(&nacpXml, "None");
     }
     
-    strcat(nacpXml, "</StartupUserAccountOption>\n");
+    xmlBufferAppend(&nacpXml, "</StartupUserAccountOption>\n");
     
-    sprintf(tmp, "  <AddOnContentRegistrationType>%s</AddOnContentRegistrationType>\n", getNacpAddOnContentRegistrationType(controlNacp.add_on_content_registration_type));
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <AddOnContentRegistrationType>%s</AddOnContentRegistrationType>\n", getNacpAddOnContentRegistrationType(controlNacp.add_on_content_registration_type));
     
-    sprintf(tmp, "  <UserAccountSaveDataSizeMax>0x%016lx</UserAccountSaveDataSizeMax>\n", controlNacp.user_account_save_data_size_max);
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <UserAccountSaveDataSizeMax>0x%016lx</UserAccountSaveDataSizeMax>\n", controlNacp.user_account_save_data_size_max);
     
-    sprintf(tmp, "  <UserAccountSaveDataJournalSizeMax>0x%016lx</UserAccountSaveDataJournalSizeMax>\n", controlNacp.user_account_save_data_journal_size_max);
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <UserAccountSaveDataJournalSizeMax>0x%016lx</UserAccountSaveDataJournalSizeMax>\n", controlNacp.user_account_save_data_journal_size_max);
     
-    sprintf(tmp, "  <DeviceSaveDataSizeMax>0x%016lx</DeviceSaveDataSizeMax>\n", controlNacp.device_save_data_size_max);
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <DeviceSaveDataSizeMax>0x%016lx</DeviceSaveDataSizeMax>\n", controlNacp.device_save_data_size_max);
     
-    sprintf(tmp, "  <DeviceSaveDataJournalSizeMax>0x%016lx</DeviceSaveDataJournalSizeMax>\n", controlNacp.device_save_data_journal_size_max);
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <DeviceSaveDataJournalSizeMax>0x%016lx</DeviceSaveDataJournalSizeMax>\n", controlNacp.device_save_data_journal_size_max);
     
-    sprintf(tmp, "  <TemporaryStorageSize>0x%016lx</TemporaryStorageSize>\n", controlNacp.temporary_storage_size);
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <TemporaryStorageSize>0x%016lx</TemporaryStorageSize>\n", controlNacp.temporary_storage_size);
     
-    sprintf(tmp, "  <CacheStorageSize>0x%016lx</CacheStorageSize>\n", controlNacp.cache_storage_size);
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <CacheStorageSize>0x%016lx</CacheStorageSize>\n", controlNacp.cache_storage_size);
     
-    sprintf(tmp, "  <CacheStorageJournalSize>0x%016lx</CacheStorageJournalSize>\n", controlNacp.cache_storage_journal_size);
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <CacheStorageJournalSize>0x%016lx</CacheStorageJournalSize>\n", controlNacp.cache_storage_journal_size);
     
-    sprintf(tmp, "  <CacheStorageDataAndJournalSizeMax>0x%016lx</CacheStorageDataAndJournalSizeMax>\n", controlNacp.cache_storage_data_and_journal_size_max);
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <CacheStorageDataAndJournalSizeMax>0x%016lx</CacheStorageDataAndJournalSizeMax>\n", controlNacp.cache_storage_data_and_journal_size_max);
     
-    sprintf(tmp, "  <CacheStorageIndexMax>0x%04x</CacheStorageIndexMax>\n", controlNacp.cache_storage_index_max);
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <CacheStorageIndexMax>0x%04x</CacheStorageIndexMax>\n", controlNacp.cache_storage_index_max);
     
-    sprintf(tmp, "  <Hdcp>%s</Hdcp>\n", getNacpHdcp(controlNacp.hdcp));
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <Hdcp>%s</Hdcp>\n", getNacpHdcp(controlNacp.hdcp));
     
-    sprintf(tmp, "  <CrashReport>%s</CrashReport>\n", getNacpCrashReport(controlNacp.crash_report));
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <CrashReport>%s</CrashReport>\n", getNacpCrashReport(controlNacp.crash_report));
     
-    sprintf(tmp, "  <RuntimeAddOnContentInstall>%s</RuntimeAddOnContentInstall>\n", getNacpRuntimeAddOnContentInstall(controlNacp.runtime_add_on_content_install));
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <RuntimeAddOnContentInstall>%s</RuntimeAddOnContentInstall>\n", getNacpRuntimeAddOnContentInstall(controlNacp.runtime_add_on_content_install));
     
-    sprintf(tmp, "  <RuntimeParameterDelivery>%s</RuntimeParameterDelivery>\n", getNacpRuntimeParameterDelivery(controlNacp.runtime_parameter_delivery));
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <RuntimeParameterDelivery>%s</RuntimeParameterDelivery>\n", getNacpRuntimeParameterDelivery(controlNacp.runtime_parameter_delivery));
     
     for(i = 0; i < 0x10; i++)
     {
         if (controlNacp.play_log_queryable_application_ids[i] != 0)
         {
-            sprintf(tmp, "  <PlayLogQueryableApplicationId>0x%016lx</PlayLogQueryableApplicationId>\n", controlNacp.play_log_queryable_application_ids[i]);
-            strcat(nacpXml, tmp);
+            xmlBufferAppendFormatted(&nacpXml, "  <PlayLogQueryableApplicationId>0x%016lx</PlayLogQueryableApplicationId>\n", controlNacp.play_log_queryable_application_ids[i]);
         }
     }
     
-    sprintf(tmp, "  <PlayLogQueryCapability>%s</PlayLogQueryCapability>\n", getNacpPlayLogQueryCapability(controlNacp.play_log_query_capability));
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <PlayLogQueryCapability>%s</PlayLogQueryCapability>\n", getNacpPlayLogQueryCapability(controlNacp.play_log_query_capability));
     
-    strcat(nacpXml, "  <Repair>");
+    xmlBufferAppend(&nacpXml, "  <Repair>");
     
     if (*((u8*)&(controlNacp.repair_flag)) != 0)
     {
-        if (controlNacp.repair_flag.RepairFlag_SuppressGameCardAccess) strcat(nacpXml, "SuppressGameCardAccess");
+        if (controlNacp.repair_flag.RepairFlag_SuppressGameCardAccess) xmlBufferAppend(&nacpXml, "SuppressGameCardAccess");
     } else {
-        strcat(nacpXml, "None");
+        xmlBufferAppend(&nacpXml, "None");
     }
     
-    strcat(nacpXml, "</Repair>\n");
+    xmlBufferAppend(&nacpXml, "</Repair>\n");
     
-    strcat(nacpXml, "  <Attribute>");
+    xmlBufferAppend(&nacpXml, "  <Attribute>");
     
     memcpy(&flag, &(controlNacp.attribute_flag), sizeof(u32));
     if (flag != 0)
     {
-        if (controlNacp.attribute_flag.AttributeFlag_Demo) strcat(nacpXml, "Demo");
+        if (controlNacp.attribute_flag.AttributeFlag_Demo) xmlBufferAppend(&nacpXml, "Demo");
         
         if (controlNacp.attribute_flag.AttributeFlag_RetailInteractiveDisplay)
         {
-            if (controlNacp.attribute_flag.AttributeFlag_Demo) strcat(nacpXml, ",");
-            strcat(nacpXml, "RetailInteractiveDisplay");
+            if (controlNacp.attribute_flag.AttributeFlag_Demo) xmlBufferAppend(&nacpXml, ",");
+            xmlBufferAppend(&nacpXml, "RetailInteractiveDisplay");
         }
     } else {
-        strcat(nacpXml, "None");
+        xmlBufferAppend(&nacpXml, "None");
     }
     
-    strcat(nacpXml, "</Attribute>\n");
+    xmlBufferAppend(&nacpXml, "</Attribute>\n");
     
-    sprintf(tmp, "  <ProgramIndex>%u</ProgramIndex>\n", controlNacp.program_index);
-    strcat(nacpXml, tmp);
+    xmlBufferAppendFormatted(&nacpXml, "  <ProgramIndex>%u</ProgramIndex>\n", controlNacp.program_index);
     
-    strcat(nacpXml, "  <RequiredNetworkServiceLicenseOnLaunch>");
+    xmlBufferAppend(&nacpXml, "  <RequiredNetworkServiceLicenseOnLaunch>");
     
     if (*((u8*)&(controlNacp.required_network_service_license_on_launch_flag)) != 0)
     {
-        if (controlNacp.required_network_service_license_on_launch_flag.RequiredNetworkServiceLicenseOnLaunchFlag_Common) strcat(nacpXml, "Common");
+        if (controlNacp.required_network_service_license_on_launch_flag.RequiredNetworkServiceLicenseOnLaunchFlag_Common) xmlBufferAppend(&nacpXml, "Common");
     } else {
-        strcat(nacpXml, "None");
+        xmlBufferAppend(&nacpXml, "None");
     }
     
-    strcat(nacpXml, "</RequiredNetworkServiceLicenseOnLaunch>\n");
+    xmlBufferAppend(&nacpXml, "</RequiredNetworkServiceLicenseOnLaunch>\n");
     
     // Check if we actually have valid NeighborDetectionClientConfiguration values
     availableSGC = (controlNacp.neighbor_detection_client_configuration.send_group_configuration.group_id != 0 && memcmp(controlNacp.neighbor_detection_client_configuration.send_group_configuration.key, null_key, 0x10) != 0);
@@ -3326,20 +3924,18 @@ bool retrieveNacpDataFromNca(NcmContentStorage *ncmStorage, const NcmContentId *
     
     if (availableSGC || availableRGC)
     {
-        strcat(nacpXml, "  <NeighborDetectionClientConfiguration>\n");
+        xmlBufferAppend(&nacpXml, "  <NeighborDetectionClientConfiguration>\n");
         
         if (availableSGC)
         {
             convertDataToHexString(controlNacp.neighbor_detection_client_configuration.send_group_configuration.key, 0x10, dataStr, 100);
             
-            sprintf(tmp, "    <SendDataConfiguration>\n" \
-                         "      <DataId>0x%016lx</DataId>\n" \
-                         "      <Key>%s</Key>\n" \
-                         "    </SendDataConfiguration>\n", \
-                         controlNacp.neighbor_detection_client_configuration.send_group_configuration.group_id, \
-                         dataStr);
-            
-            strcat(nacpXml, tmp);
+            xmlBufferAppendFormatted(&nacpXml, "    <SendDataConfiguration>\n" \
+                                               "      <DataId>0x%016lx</DataId>\n" \
+                                               "      <Key>%s</Key>\n" \
+                                               "    </SendDataConfiguration>\n", \
+                                               controlNacp.neighbor_detection_client_configuration.send_group_configuration.group_id, \
+                                               dataStr);
         }
         
         if (availableRGC)
@@ -3350,34 +3946,35 @@ bool retrieveNacpDataFromNca(NcmContentStorage *ncmStorage, const NcmContentId *
                 {
                     convertDataToHexString(controlNacp.neighbor_detection_client_configuration.receivable_group_configurations[i].key, 0x10, dataStr, 100);
                     
-                    sprintf(tmp, "    <ReceivableDataConfiguration>\n" \
-                                 "      <DataId>0x%016lx</DataId>\n" \
-                                 "      <Key>%s</Key>\n" \
-                                 "    </ReceivableDataConfiguration>\n", \
-                                 controlNacp.neighbor_detection_client_configuration.receivable_group_configurations[i].group_id, \
-                                 dataStr);
-                    
-                    strcat(nacpXml, tmp);
+                    xmlBufferAppendFormatted(&nacpXml, "    <ReceivableDataConfiguration>\n" \
+                                                       "      <DataId>0x%016lx</DataId>\n" \
+                                                       "      <Key>%s</Key>\n" \
+                                                       "    </ReceivableDataConfiguration>\n", \
+                                                       controlNacp.neighbor_detection_client_configuration.receivable_group_configurations[i].group_id, \
+                                                       dataStr);
                 }
             }
         }
         
-        strcat(nacpXml, "  </NeighborDetectionClientConfiguration>\n");
+        xmlBufferAppend(&nacpXml, "  </NeighborDetectionClientConfiguration>\n");
     }
     
-    sprintf(tmp, "  <JitConfiguration>\n" \
-                 "    <IsEnabled>%s</IsEnabled>\n" \
-                 "    <MemorySize>0x%016lx</MemorySize>\n" \
-                 "  </JitConfiguration>\n", \
-                 getNacpJitConfigurationFlag(controlNacp.jit_configuration.jit_configuration_flag), \
-                 controlNacp.jit_configuration.memory_size);
+    xmlBufferAppendFormatted(&nacpXml, "  <JitConfiguration>\n" \
+                                       "    <IsEnabled>%s</IsEnabled>\n" \
+                                       "    <MemorySize>0x%016lx</MemorySize>\n" \
+                                       "  </JitConfiguration>\n", \
+                                       getNacpJitConfigurationFlag(controlNacp.jit_configuration.jit_configuration_flag), \
+                                       controlNacp.jit_configuration.memory_size);
     
-    strcat(nacpXml, tmp);
+    xmlBufferAppend(&nacpXml, "</Application>");
     
-    strcat(nacpXml, "</Application>");
+    if (nacpXml.error)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to reallocate memory for the NACP XML!", __func__);
+        goto out;
+    }
     
-    *out_nacp_xml = nacpXml;
-    *out_nacp_xml_size = strlen(nacpXml);
+    *out_nacp_xml = xmlBufferDetach(&nacpXml, out_nacp_xml_size);
     
     if (nacpIconCnt)
     {
@@ -3391,10 +3988,12 @@ out:
     if (!success)
     {
         if (nacpIcons != NULL) free(nacpIcons);
-        
-        if (nacpXml != NULL) free(nacpXml);
     }
     
+    if (iconBuf) free(iconBuf);
+    
+    xmlBufferFree(&nacpXml);
+    
     // Manually free these pointers
     // Calling freeRomFsContext() would also close the ncmStorage handle
     free(romFsContext.romfs_dir_entries);
@@ -4,6 +4,7 @@
 #define __NCA_H__
 
 #include <switch.h>
+#include "xml_buffer.h"
 
 #define NCA3_MAGIC                      (u32)0x4E434133     // "NCA3"
 #define NCA2_MAGIC                      (u32)0x4E434132     // "NCA2"
@@ -34,6 +35,7 @@
 
 #define IVFC_MAGIC                      (u32)0x49564643     // "IVFC"
 #define IVFC_MAX_LEVEL                  6
+#define IVFC_HASH_CACHE_SLOTS           8                   // Cached level 5 hash blocks (each one covers block_size / SHA256_HASH_SIZE data blocks)
 
 #define BKTR_MAGIC                      (u32)0x424B5452     // "BKTR"
 
@@ -271,6 +273,7 @@ typedef struct {
     u64 size;
     u8 hash[SHA256_HASH_SIZE];
     char hash_str[(SHA256_HASH_SIZE * 2) + 1];
+    u8 record_hash[SHA256_HASH_SIZE]; // Original hash from the CNMT content record
     u8 keyblob;
     u8 id_offset;
     u64 cnt_record_offset; // Relative to the start of the content records section in the CNMT
@@ -289,10 +292,29 @@ typedef struct {
     u64 block_size[2];
 } nca_program_mod_data;
 
+typedef struct {
+    NcmContentStorage *ncmStorage;
+    NcmContentId ncaId;
+    char nca_id_str[SHA256_HASH_SIZE + 1];
+    bool gamecard;
+    u64 gamecard_offset; // Relative to the start of the secure IStorage partition
+    u64 gamecard_size;
+} nca_content_handle_t;
+
+// Every NCA read used to need its own ncmContentStorageGetPath() call, so (reads - path_lookups) is the amount of IPC calls saved
+typedef struct {
+    u64 reads;
+    u64 path_lookups; // ncmContentStorageGetPath() calls
+} nca_content_read_stats_t;
+
+// Icon data isn't kept in memory. It's streamed from the Control NCA RomFS section while dumping
 typedef struct {
     char filename[100];
+    NcmContentId nca_id; // Original Control NCA content ID
+    Aes128CtrContext aes_ctx;
+    u64 icon_offset; // Relative to NCA start
     u64 icon_size;
-    u8 icon_data[0x20000];
+    u8 icon_hash[SHA256_HASH_SIZE];
 } nacp_icons_ctx;
 
 typedef struct {
@@ -347,6 +369,24 @@ typedef struct {
     bool missing_tik;
 } title_rights_ctx;
 
+// Used to verify PFS0 data against its SHA-256 hash table while it's being read
+typedef struct {
+    bool initialized;
+    Aes128CtrContext aes_ctx;
+    u64 hash_table_offset; // Relative to NCA start
+    u64 hash_table_size;
+    u64 pfs0_offset; // Relative to NCA start
+    u64 pfs0_size;
+    u64 block_size;
+    u8 master_hash[SHA256_HASH_SIZE];
+    u8 *hash_table;
+    u8 *block_buf; // Used to read the missing bytes from partially provided data blocks
+    Sha256Context sha_ctx; // Running hash for the current data block
+    u64 cur_block_idx;
+    u64 cur_block_fill;
+    bool cur_block_active;
+} pfs0_hash_ctx_t;
+
 typedef struct {
     NcmStorageId storageId;
     NcmContentStorage ncmStorage;
@@ -361,8 +401,24 @@ typedef struct {
     u64 exefs_str_table_offset; // Relative to NCA start
     char *exefs_str_table;
     u64 exefs_data_offset; // Relative to NCA start
+    pfs0_hash_ctx_t hash_ctx;
 } exefs_ctx_t;
 
+// Used to verify RomFS data against its IVFC hash tree
+typedef struct {
+    bool initialized;
+    u64 level_offset[IVFC_MAX_LEVEL]; // Relative to section start
+    u64 level_size[IVFC_MAX_LEVEL];
+    u64 level_block_size[IVFC_MAX_LEVEL];
+    u8 *upper_levels[IVFC_MAX_LEVEL - 2]; // Levels 1 - 4 are small enough to be fully cached after being verified
+    u8 *hash_cache; // Level 5 hash blocks (direct-mapped)
+    u64 hash_cache_tags[IVFC_HASH_CACHE_SLOTS];
+    bool hash_cache_valid[IVFC_HASH_CACHE_SLOTS];
+    u8 *block_buf; // Last data block read to verify a partial block
+    u64 block_buf_idx;
+    bool block_buf_valid;
+} ivfc_ctx_t;
+
 typedef struct {
     NcmStorageId storageId;
     NcmContentStorage ncmStorage;
@@ -371,6 +427,8 @@ typedef struct {
     Aes128CtrContext aes_ctx;
     u64 section_offset; // Relative to NCA start
     u64 section_size;
+    ivfc_hdr_t ivfc_header;
+    ivfc_ctx_t ivfc_ctx;
     u64 romfs_offset; // Relative to NCA start
     u64 romfs_size;
     u64 romfs_dirtable_offset; // Relative to NCA start
@@ -449,6 +507,7 @@ typedef struct {
     romfs_file *romfs_file_entries;
     u64 romfs_filedata_offset; // Relative to section start
     bool use_base_romfs;
+    ivfc_ctx_t ivfc_ctx;
 } bktr_ctx_t;
 
 // Used in HFS0 / ExeFS / RomFS browsers
@@ -723,18 +782,53 @@ typedef struct {
 
 char *getContentType(u8 type);
 
-void generateCnmtXml(cnmt_xml_program_info *xml_program_info, cnmt_xml_content_info *xml_content_info, char *out);
+void generateCnmtXml(cnmt_xml_program_info *xml_program_info, cnmt_xml_content_info *xml_content_info, xml_buffer_t *out);
 
 void convertNcaSizeToU64(const u8 size[0x6], u64 *out);
 
 void convertU64ToNcaSize(const u64 size, u8 out[0x6]);
 
+// Forgets the last resolved NCA content path. Must be called whenever content storages may have changed (e.g. gamecard removal)
+void invalidateNcaContentPathCache();
+
+// Resolves the content path, storage kind and gamecard location for a NCA only once
+// Reads issued through the handle don't perform any other IPC calls besides the data transfer itself
+bool openNcaContentHandle(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, nca_content_handle_t *handle);
+
+bool readNcaContentHandle(nca_content_handle_t *handle, u64 offset, void *outBuf, size_t bufSize);
+
+void resetNcaContentReadStats();
+
+void getNcaContentReadStats(nca_content_read_stats_t *out);
+
 bool readNcaDataByContentId(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, u64 offset, void *outBuf, size_t bufSize);
 
 bool processNcaCtrSectionBlock(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, Aes128CtrContext *ctx, u64 offset, void *outBuf, size_t bufSize, bool encrypt);
 
 bool readBktrSectionBlock(u64 offset, void *outBuf, size_t bufSize);
 
+bool initRomFsIvfcContext(bool usePatch);
+
+void freeIvfcContext(ivfc_ctx_t *ctx);
+
+// "offset" must be the same offset used to read the data block from the RomFS section (relative to NCA start for base RomFS sections, or relative to section start for BKTR sections)
+// If the verification fails, "out_failed_offset" will hold the offset of the first data block that couldn't be verified
+bool verifyRomFsSectionBlock(bool usePatch, u64 offset, const u8 *data, u64 size, u64 *out_failed_offset);
+
+void setupPfs0HashContext(pfs0_hash_ctx_t *ctx, nca_header_t *dec_nca_header, u8 section_index, u8 *decrypted_nca_keys);
+
+bool initPfs0HashContext(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, pfs0_hash_ctx_t *ctx);
+
+void freePfs0HashContext(pfs0_hash_ctx_t *ctx);
+
+// "offset" is relative to NCA start. Data blocks are hashed as the data is fed, so consecutive calls with contiguous data never read anything from the NCA
+// Bytes outside the PFS0 partition are ignored. If "encrypted" is true, the provided data is treated as raw NCA data and decrypted on the fly using ncaCtrBuf
+// If the verification fails, "out_failed_offset" will hold the offset of the first data block that couldn't be verified (relative to NCA start)
+bool verifyPfs0SectionBlock(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, pfs0_hash_ctx_t *ctx, u64 offset, const u8 *data, u64 size, bool encrypted, u64 *out_failed_offset);
+
+// Reads the remaining bytes from the last data block fed to verifyPfs0SectionBlock() (if it wasn't complete) and verifies it
+bool finishPfs0SectionVerification(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, pfs0_hash_ctx_t *ctx, u64 *out_failed_offset);
+
 bool encryptNcaHeader(nca_header_t *input, u8 *outBuf, u64 outBufSize);
 
 bool decryptNcaHeader(const u8 *ncaBuf, u64 ncaBufSize, nca_header_t *out, title_rights_ctx *rights_info, u8 *decrypted_nca_keys, bool retrieveTitleKeyData);
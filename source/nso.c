@@ -15,41 +15,66 @@ extern int font_height;
 
 /* Statically allocated variables */
 
-static u8 *nsoBinaryData = NULL;
-static u64 nsoBinaryDataSize = 0;
+static nso_image_t nsoImageCache[NSO_CACHE_MAX_ENTRIES];
+static u64 nsoImageCacheSize = 0;
+static u64 nsoImageCacheTick = 0;
 
-static u64 nsoBinaryTextSectionOffset = 0;
-static u64 nsoBinaryTextSectionSize = 0;
-
-static u64 nsoBinaryRodataSectionOffset = 0;
-static u64 nsoBinaryRodataSectionSize = 0;
+static void freeNsoImage(nso_image_t *nsoImage)
+{
+    if (!nsoImage) return;
+    
+    if (nsoImage->valid) nsoImageCacheSize -= nsoImage->data_size;
+    
+    if (nsoImage->data) free(nsoImage->data);
+    
+    memset(nsoImage, 0, sizeof(nso_image_t));
+}
 
-static u64 nsoBinaryDataSectionOffset = 0;
-static u64 nsoBinaryDataSectionSize = 0;
+void freeNsoImageCache()
+{
+    u32 i;
+    
+    for(i = 0; i < NSO_CACHE_MAX_ENTRIES; i++) freeNsoImage(&(nsoImageCache[i]));
+    
+    nsoImageCacheSize = 0;
+    nsoImageCacheTick = 0;
+}
 
-void freeNsoBinaryData()
+static nso_image_t *getLeastRecentlyUsedNsoImage()
 {
-    if (nsoBinaryData)
+    u32 i;
+    nso_image_t *lru = NULL;
+    
+    for(i = 0; i < NSO_CACHE_MAX_ENTRIES; i++)
     {
-        free(nsoBinaryData);
-        nsoBinaryData = NULL;
+        if (!nsoImageCache[i].valid || nsoImageCache[i].refcount > 0 || nsoImageCache[i].pinned) continue;
+        if (!lru || nsoImageCache[i].last_used < lru->last_used) lru = &(nsoImageCache[i]);
     }
     
-    nsoBinaryDataSize = 0;
-    
-    nsoBinaryTextSectionOffset = 0;
-    nsoBinaryTextSectionSize = 0;
+    return lru;
+}
+
+// Evicts unreferenced images (least recently used first) until "required_size" more bytes fit within NSO_CACHE_MAX_SIZE
+// Returns the last evicted slot, or NULL if nothing was evicted
+static nso_image_t *evictNsoImages(u64 required_size)
+{
+    nso_image_t *lru, *evicted = NULL;
     
-    nsoBinaryRodataSectionOffset = 0;
-    nsoBinaryRodataSectionSize = 0;
+    while((nsoImageCacheSize + required_size) > NSO_CACHE_MAX_SIZE)
+    {
+        lru = getLeastRecentlyUsedNsoImage();
+        if (!lru) break;
+        
+        freeNsoImage(lru);
+        evicted = lru;
+    }
     
-    nsoBinaryDataSectionOffset = 0;
-    nsoBinaryDataSectionSize = 0;
+    return evicted;
 }
 
-bool loadNsoBinaryData(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, Aes128CtrContext *aes_ctx, u64 nso_base_offset, nso_header_t *nsoHeader)
+static bool loadNsoBinaryData(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, Aes128CtrContext *aes_ctx, u64 nso_base_offset, nso_header_t *nsoHeader, nso_image_t *nsoImage)
 {
-    if (!ncmStorage || !ncaId || !aes_ctx || !nso_base_offset || !nsoHeader)
+    if (!ncmStorage || !ncaId || !aes_ctx || !nso_base_offset || !nsoHeader || !nsoImage)
     {
         uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: invalid parameters to load .text, .rodata and .data sections from NSO in Program NCA!", __func__);
         return false;
@@ -57,188 +82,280 @@ bool loadNsoBinaryData(NcmContentStorage *ncmStorage, const NcmContentId *ncaId,
     
     u8 i;
     
-    u8 *nsoTextSection = NULL;
-    u64 nsoTextSectionSize = 0;
+    const char *sectionNames[3] = { ".text", ".rodata", ".data" };
+    segment_header_t *segmentHeaders[3] = { &(nsoHeader->text_segment_header), &(nsoHeader->rodata_segment_header), &(nsoHeader->data_segment_header) };
+    u64 compressedSizes[3] = { (u64)nsoHeader->text_compressed_size, (u64)nsoHeader->rodata_compressed_size, (u64)nsoHeader->data_compressed_size };
     
-    u8 *nsoRodataSection = NULL;
-    u64 nsoRodataSectionSize = 0;
+    u64 sectionOffsets[3];
+    u64 sectionSizes[3];
+    u64 sectionEndOffset;
     
-    u8 *nsoDataSection = NULL;
-    u64 nsoDataSectionSize = 0;
+    u8 *compressedSection = NULL;
+    u64 compressedSectionBufSize = 0;
     
-    u8 *curCompressedSection;
-    u64 curCompressedSectionSize;
-    u64 curCompressedSectionOffset;
-    u8 curSectionFlag;
-    
-    u8 *curDecompressedSection;
-    u64 curDecompressedSectionSize;
+    u64 allocSize = 0;
+    bool success = false;
     
-    bool success = true;
+    u8 *nsoBinaryData = NULL;
     
-    freeNsoBinaryData();
+    memset(nsoImage, 0, sizeof(nso_image_t));
     
+    // Calculate the final memory layout before reading anything, so each section can be read or decompressed straight into the output buffer
+    // Uncompressed sections use their file size, like before
     for(i = 0; i < 3; i++)
     {
-        curCompressedSection = NULL;
-        curCompressedSectionSize = (i == 0 ? (u64)nsoHeader->text_compressed_size : (i == 1 ? (u64)nsoHeader->rodata_compressed_size : (u64)nsoHeader->data_compressed_size));
-        curCompressedSectionOffset = (nso_base_offset + (i == 0 ? (u64)nsoHeader->text_segment_header.file_offset : (i == 1 ? (u64)nsoHeader->rodata_segment_header.file_offset : (u64)nsoHeader->data_segment_header.file_offset)));
-        curSectionFlag = (1 << i);
-        
-        curDecompressedSection = NULL;
-        curDecompressedSectionSize = (i == 0 ? (u64)nsoHeader->text_segment_header.decompressed_size : (i == 1 ? (u64)nsoHeader->rodata_segment_header.decompressed_size : (u64)nsoHeader->data_segment_header.decompressed_size));
+        bool compressed = ((nsoHeader->flags & (1 << i)) != 0);
         
-        // Load section
-        curCompressedSection = malloc(curCompressedSectionSize);
-        if (!curCompressedSection)
+        if (compressed && (u64)segmentHeaders[i]->decompressed_size <= compressedSizes[i])
         {
-            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to allocate memory for the compressed %s section from NSO in Program NCA!", __func__, (i == 0 ? ".text" : (i == 1 ? ".rodata" : ".data")));
-            success = false;
-            break;
+            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: invalid decompressed size for %s section from NSO in Program NCA!", __func__, sectionNames[i]);
+            return false;
         }
         
-        if (!processNcaCtrSectionBlock(ncmStorage, ncaId, aes_ctx, curCompressedSectionOffset, curCompressedSection, curCompressedSectionSize, false))
+        sectionOffsets[i] = (i == 0 ? 0 : (u64)segmentHeaders[i]->memory_offset);
+        sectionSizes[i] = (compressed ? (u64)segmentHeaders[i]->decompressed_size : compressedSizes[i]);
+        
+        sectionEndOffset = (sectionOffsets[i] + sectionSizes[i]);
+        if (sectionEndOffset > allocSize) allocSize = sectionEndOffset;
+        
+        // A single buffer is reused for all compressed sections
+        if (compressed && compressedSizes[i] > compressedSectionBufSize) compressedSectionBufSize = compressedSizes[i];
+    }
+    
+    if (!allocSize)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: NSO in Program NCA is empty!", __func__);
+        return false;
+    }
+    
+    nsoBinaryData = malloc(allocSize);
+    if (!nsoBinaryData)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to allocate %lu bytes for full decompressed NSO in Program NCA!", __func__, allocSize);
+        return false;
+    }
+    
+    if (compressedSectionBufSize)
+    {
+        compressedSection = malloc(compressedSectionBufSize);
+        if (!compressedSection)
         {
-            breaks++;
-            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: failed to read 0x%016lX bytes %s section from NSO in Program NCA!", __func__, curCompressedSectionSize, (i == 0 ? ".text" : (i == 1 ? ".rodata" : ".data")));
-            free(curCompressedSection);
-            success = false;
-            break;
+            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to allocate memory for the compressed NSO sections in Program NCA!", __func__);
+            goto out;
         }
+    }
+    
+    // Sections are processed in order, so any overlapping bytes from a section are overwritten by the next one (same as truncating the previous section)
+    for(i = 0; i < 3; i++)
+    {
+        u8 *curSection = (nsoBinaryData + sectionOffsets[i]);
+        u64 curSectionFileOffset = (nso_base_offset + (u64)segmentHeaders[i]->file_offset);
         
-        if (nsoHeader->flags & curSectionFlag)
+        if (nsoHeader->flags & (1 << i))
         {
-            if (curDecompressedSectionSize <= curCompressedSectionSize)
-            {
-                uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: invalid decompressed size for %s section from NSO in Program NCA!", __func__, (i == 0 ? ".text" : (i == 1 ? ".rodata" : ".data")));
-                free(curCompressedSection);
-                success = false;
-                break;
-            }
-            
-            // Uncompress section
-            curDecompressedSection = malloc(curDecompressedSectionSize);
-            if (!curDecompressedSection)
-            {
-                uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to allocate memory for the decompressed %s section from NSO in Program NCA!", __func__, (i == 0 ? ".text" : (i == 1 ? ".rodata" : ".data")));
-                free(curCompressedSection);
-                success = false;
-                break;
-            }
-            
-            if (LZ4_decompress_safe((const char*)curCompressedSection, (char*)curDecompressedSection, (int)curCompressedSectionSize, (int)curDecompressedSectionSize) != (int)curDecompressedSectionSize)
+            if (!processNcaCtrSectionBlock(ncmStorage, ncaId, aes_ctx, curSectionFileOffset, compressedSection, compressedSizes[i], false))
             {
-                uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to decompress %s section from NSO in Program NCA!", __func__, (i == 0 ? ".text" : (i == 1 ? ".rodata" : ".data")));
-                free(curDecompressedSection);
-                free(curCompressedSection);
-                success = false;
-                break;
+                breaks++;
+                uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: failed to read 0x%016lX bytes %s section from NSO in Program NCA!", __func__, compressedSizes[i], sectionNames[i]);
+                goto out;
             }
             
-            free(curCompressedSection);
-            
-            switch(i)
+            if (LZ4_decompress_safe((const char*)compressedSection, (char*)curSection, (int)compressedSizes[i], (int)sectionSizes[i]) != (int)sectionSizes[i])
             {
-                case 0:
-                    nsoTextSection = curDecompressedSection;
-                    nsoTextSectionSize = curDecompressedSectionSize;
-                    break;
-                case 1:
-                    nsoRodataSection = curDecompressedSection;
-                    nsoRodataSectionSize = curDecompressedSectionSize;
-                    break;
-                case 2:
-                    nsoDataSection = curDecompressedSection;
-                    nsoDataSectionSize = curDecompressedSectionSize;
-                    break;
-                default:
-                    break;
+                uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to decompress %s section from NSO in Program NCA!", __func__, sectionNames[i]);
+                goto out;
             }
         } else {
-            switch(i)
+            if (sectionSizes[i] && !processNcaCtrSectionBlock(ncmStorage, ncaId, aes_ctx, curSectionFileOffset, curSection, sectionSizes[i], false))
             {
-                case 0:
-                    nsoTextSection = curCompressedSection;
-                    nsoTextSectionSize = curCompressedSectionSize;
-                    break;
-                case 1:
-                    nsoRodataSection = curCompressedSection;
-                    nsoRodataSectionSize = curCompressedSectionSize;
-                    break;
-                case 2:
-                    nsoDataSection = curCompressedSection;
-                    nsoDataSectionSize = curCompressedSectionSize;
-                    break;
-                default:
-                    break;
+                breaks++;
+                uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: failed to read 0x%016lX bytes %s section from NSO in Program NCA!", __func__, sectionSizes[i], sectionNames[i]);
+                goto out;
             }
         }
     }
     
-    curCompressedSection = curDecompressedSection = NULL;
+    // Calculate final section sizes
+    nsoImage->text_offset = 0;
+    nsoImage->text_size = (sectionSizes[0] > sectionOffsets[1] ? sectionOffsets[1] : sectionSizes[0]);
+    
+    nsoImage->rodata_offset = sectionOffsets[1];
+    nsoImage->rodata_size = ((sectionOffsets[1] + sectionSizes[1]) > sectionOffsets[2] ? (sectionOffsets[2] > sectionOffsets[1] ? (sectionOffsets[2] - sectionOffsets[1]) : 0) : sectionSizes[1]);
+    
+    nsoImage->data_offset = sectionOffsets[2];
+    nsoImage->data_section_size = sectionSizes[2];
+    
+    nsoImage->data = nsoBinaryData;
+    nsoImage->data_size = (sectionOffsets[2] + sectionSizes[2]);
+    
+    // Clear the gaps between sections
+    if (nsoImage->rodata_offset > nsoImage->text_size) memset(nsoBinaryData + nsoImage->text_size, 0, nsoImage->rodata_offset - nsoImage->text_size);
+    if (nsoImage->data_offset > (nsoImage->rodata_offset + nsoImage->rodata_size)) memset(nsoBinaryData + nsoImage->rodata_offset + nsoImage->rodata_size, 0, nsoImage->data_offset - (nsoImage->rodata_offset + nsoImage->rodata_size));
+    
+    success = true;
     
-    if (success)
+out:
+    if (compressedSection) free(compressedSection);
+    
+    if (!success && nsoBinaryData) free(nsoBinaryData);
+    
+    return success;
+}
+
+// Returns a decoded NSO image from the cache, loading it if needed
+// Each successful call must be paired with releaseNsoImage()
+static nso_image_t *acquireNsoImage(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, Aes128CtrContext *aes_ctx, u64 nso_base_offset, nso_header_t *nsoHeader)
+{
+    if (!ncmStorage || !ncaId || !aes_ctx || !nso_base_offset || !nsoHeader) return NULL;
+    
+    u32 i;
+    nso_image_t *nsoImage = NULL;
+    
+    for(i = 0; i < NSO_CACHE_MAX_ENTRIES; i++)
     {
-        // Calculate full binary size
-        u64 finalTextSectionSize = nsoTextSectionSize;
-        u64 finalRodataSectionSize = nsoRodataSectionSize;
-        
-        nsoBinaryDataSize = nsoTextSectionSize;
-        
-        if ((u64)nsoHeader->rodata_segment_header.memory_offset > nsoBinaryDataSize)
+        if (nsoImageCache[i].valid && nsoImageCache[i].nso_base_offset == nso_base_offset && !memcmp(nsoImageCache[i].nca_id, ncaId->c, sizeof(nsoImageCache[i].nca_id)))
         {
-            nsoBinaryDataSize += ((u64)nsoHeader->rodata_segment_header.memory_offset - nsoBinaryDataSize);
-        } else
-        if ((u64)nsoHeader->rodata_segment_header.memory_offset < nsoBinaryDataSize)
+            nsoImageCache[i].refcount++;
+            nsoImageCache[i].last_used = ++nsoImageCacheTick;
+            return &(nsoImageCache[i]);
+        }
+    }
+    
+    // Make room for the new image before loading it, to keep peak memory usage down
+    u64 estimated_size = ((u64)nsoHeader->data_segment_header.memory_offset + (u64)nsoHeader->data_segment_header.decompressed_size);
+    nsoImage = evictNsoImages(estimated_size);
+    
+    if (!nsoImage)
+    {
+        for(i = 0; i < NSO_CACHE_MAX_ENTRIES; i++)
         {
-            finalTextSectionSize -= (nsoBinaryDataSize - (u64)nsoHeader->rodata_segment_header.memory_offset);
-            nsoBinaryDataSize -= (nsoBinaryDataSize - (u64)nsoHeader->rodata_segment_header.memory_offset);
+            if (!nsoImageCache[i].valid)
+            {
+                nsoImage = &(nsoImageCache[i]);
+                break;
+            }
         }
+    }
+    
+    // All slots are in use: evict the least recently used unreferenced image
+    if (!nsoImage)
+    {
+        nsoImage = getLeastRecentlyUsedNsoImage();
+        if (nsoImage) freeNsoImage(nsoImage);
+    }
+    
+    if (!nsoImage)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: no free NSO cache slots available!", __func__);
+        return NULL;
+    }
+    
+    if (!loadNsoBinaryData(ncmStorage, ncaId, aes_ctx, nso_base_offset, nsoHeader, nsoImage)) return NULL;
+    
+    memcpy(nsoImage->nca_id, ncaId->c, sizeof(nsoImage->nca_id));
+    nsoImage->nso_base_offset = nso_base_offset;
+    nsoImage->refcount = 1;
+    nsoImage->last_used = ++nsoImageCacheTick;
+    nsoImage->valid = true;
+    
+    nsoImageCacheSize += nsoImage->data_size;
+    
+    return nsoImage;
+}
+
+// The symbols list is only retrieved from the main NSO, so its image must survive the middleware pass
+static bool isMainNso(const char *nso_filename)
+{
+    return (strlen(nso_filename) == 4 && !strncmp(nso_filename, "main", 4));
+}
+
+static void releaseNsoImage(nso_image_t *nsoImage)
+{
+    if (!nsoImage || !nsoImage->valid || !nsoImage->refcount) return;
+    
+    nsoImage->refcount--;
+    
+    // Unreferenced images are only kept around while the cache stays within its size limit
+    if (!nsoImage->refcount) evictNsoImages(0);
+}
+
+bool scanNsoRodataForMiddleware(const u8 *data, u64 data_size, nso_rodata_match_t **out_matches, u64 *out_match_cnt)
+{
+    if (!data || !data_size || !out_matches || !out_match_cnt)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: invalid parameters to scan NSO .rodata section!", __func__);
+        return false;
+    }
+    
+    const u64 markerLen = (sizeof(NSO_MIDDLEWARE_MARKER) - 1);
+    
+    const u8 *cur = data;
+    const u8 *end = (data + data_size);
+    const u8 *strEnd;
+    
+    nso_rodata_match_t *matches = NULL, *tmpMatches = NULL;
+    u64 matchCnt = 0;
+    
+    while(cur < end)
+    {
+        // Jump straight to the next byte that can start the marker. memchr() is word-optimized
+        cur = memchr(cur, NSO_MIDDLEWARE_MARKER[0], (size_t)(end - cur));
+        if (!cur) break;
         
-        nsoBinaryDataSize += nsoRodataSectionSize;
-        
-        if ((u64)nsoHeader->data_segment_header.memory_offset > nsoBinaryDataSize)
-        {
-            nsoBinaryDataSize += ((u64)nsoHeader->data_segment_header.memory_offset - nsoBinaryDataSize);
-        } else
-        if ((u64)nsoHeader->data_segment_header.memory_offset < nsoBinaryDataSize)
+        if ((u64)(end - cur) < markerLen || memcmp(cur, NSO_MIDDLEWARE_MARKER, markerLen) != 0)
         {
-            finalRodataSectionSize -= (nsoBinaryDataSize - (u64)nsoHeader->data_segment_header.memory_offset);
-            nsoBinaryDataSize -= (nsoBinaryDataSize - (u64)nsoHeader->data_segment_header.memory_offset);
+            cur++;
+            continue;
         }
         
-        nsoBinaryDataSize += nsoDataSectionSize;
+        // Found a match. Skip the rest of the string it belongs to
+        strEnd = memchr(cur, 0, (size_t)(end - cur));
+        if (!strEnd) strEnd = end;
         
-        nsoBinaryData = calloc(nsoBinaryDataSize, sizeof(u8));
-        if (nsoBinaryData)
+        tmpMatches = realloc(matches, (matchCnt + 1) * sizeof(nso_rodata_match_t));
+        if (!tmpMatches)
         {
-            memcpy(nsoBinaryData, nsoTextSection, finalTextSectionSize);
-            memcpy(nsoBinaryData + (u64)nsoHeader->rodata_segment_header.memory_offset, nsoRodataSection, finalRodataSectionSize);
-            memcpy(nsoBinaryData + (u64)nsoHeader->data_segment_header.memory_offset, nsoDataSection, nsoDataSectionSize);
-            
-            nsoBinaryTextSectionOffset = 0;
-            nsoBinaryTextSectionSize = finalTextSectionSize;
-            
-            nsoBinaryRodataSectionOffset = (u64)nsoHeader->rodata_segment_header.memory_offset;
-            nsoBinaryRodataSectionSize = finalRodataSectionSize;
-            
-            nsoBinaryDataSectionOffset = (u64)nsoHeader->data_segment_header.memory_offset;
-            nsoBinaryDataSectionSize = nsoDataSectionSize;
-        } else {
-            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to allocate %lu bytes for full decompressed NSO in Program NCA!", __func__, nsoBinaryDataSize);
-            nsoBinaryDataSize = 0;
-            success = false;
+            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to reallocate NSO .rodata marker matches buffer!", __func__);
+            if (matches) free(matches);
+            return false;
         }
+        
+        matches = tmpMatches;
+        tmpMatches = NULL;
+        
+        matches[matchCnt].str = (const char*)cur;
+        matches[matchCnt].len = (u64)(strEnd - cur);
+        matchCnt++;
+        
+        cur = strEnd;
     }
     
-    if (nsoTextSection) free(nsoTextSection);
-    if (nsoRodataSection) free(nsoRodataSection);
-    if (nsoDataSection) free(nsoDataSection);
+    *out_matches = matches;
+    *out_match_cnt = matchCnt;
     
-    return success;
+    return true;
+}
+
+static bool parseNsoMiddlewareEntry(const nso_rodata_match_t *match, nso_middleware_entry_t *out)
+{
+    if (!match || match->len <= (sizeof(NSO_MIDDLEWARE_MARKER) - 1) || !out) return false;
+    
+    const char *mwDev = (match->str + sizeof(NSO_MIDDLEWARE_MARKER) - 1);
+    u64 mwDevMaxLen = (match->len - (sizeof(NSO_MIDDLEWARE_MARKER) - 1));
+    
+    const char *sep = memchr(mwDev, '+', mwDevMaxLen);
+    if (!sep) return false;
+    
+    out->vendor = mwDev;
+    out->vendor_len = (u64)(sep - mwDev);
+    out->module = (sep + 1);
+    out->module_len = (mwDevMaxLen - out->vendor_len - 1);
+    out->is_nnsdk = (out->module_len >= (sizeof(NSO_NNSDK_MODULE_NAME) - 1) && !strncasecmp(out->module, NSO_NNSDK_MODULE_NAME, sizeof(NSO_NNSDK_MODULE_NAME) - 1));
+    
+    return true;
 }
 
-bool retrieveMiddlewareListFromNso(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, Aes128CtrContext *aes_ctx, const char *nso_filename, u64 nso_base_offset, nso_header_t *nsoHeader, char *programInfoXml)
+bool retrieveMiddlewareListFromNso(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, Aes128CtrContext *aes_ctx, const char *nso_filename, u64 nso_base_offset, nso_header_t *nsoHeader, xml_buffer_t *programInfoXml)
 {
     if (!ncmStorage || !ncaId || !aes_ctx || !nso_filename || !strlen(nso_filename) || !nso_base_offset || !nsoHeader || !programInfoXml)
     {
@@ -248,48 +365,56 @@ bool retrieveMiddlewareListFromNso(NcmContentStorage *ncmStorage, const NcmConte
     
     u64 i;
     
-    char tmp[NAME_BUF_LEN] = {'\0'};
+    nso_rodata_match_t *matches = NULL;
+    u64 matchCnt = 0;
+    
+    nso_middleware_entry_t mwEntry;
+    
+    nso_image_t *nsoImage = acquireNsoImage(ncmStorage, ncaId, aes_ctx, nso_base_offset, nsoHeader);
+    if (!nsoImage) return false;
     
-    if (!loadNsoBinaryData(ncmStorage, ncaId, aes_ctx, nso_base_offset, nsoHeader)) return false;
+    if (isMainNso(nso_filename)) nsoImage->pinned = true;
     
-    for(i = 0; i < nsoBinaryRodataSectionSize; i++)
+    if (!nsoImage->rodata_size)
     {
-        char *curStr = ((char*)nsoBinaryData + nsoBinaryRodataSectionOffset + i);
-        
-        if (strncmp(curStr, "SDK MW+", 7) != 0) continue;
-        
-        // Found a match
-        char *mwDev = (curStr + 7);
-        char *mwName = (strchr(mwDev, '+') + 1);
+        releaseNsoImage(nsoImage);
+        return true;
+    }
+    
+    if (!scanNsoRodataForMiddleware(nsoImage->data + nsoImage->rodata_offset, nsoImage->rodata_size, &matches, &matchCnt))
+    {
+        releaseNsoImage(nsoImage);
+        return false;
+    }
+    
+    for(i = 0; i < matchCnt; i++)
+    {
+        if (!parseNsoMiddlewareEntry(&(matches[i]), &mwEntry)) continue;
         
         // Filter nnSdk entries
-        if (!strncasecmp(mwName, "NintendoSdk_nnSdk", 17))
-        {
-            i += strlen(curStr);
-            continue;
-        }
-        
-        sprintf(tmp, "    <Middleware>\n" \
-                     "      <ModuleName>%s</ModuleName>\n" \
-                     "      <VenderName>%.*s</VenderName>\n" \
-                     "      <NsoName>%s</NsoName>\n" \
-                     "    </Middleware>\n", \
-                     mwName, \
-                     (int)(mwName - mwDev - 1), mwDev, \
-                     nso_filename);
+        if (mwEntry.is_nnsdk) continue;
         
-        strcat(programInfoXml, tmp);
-        
-        // Update counter
-        i += strlen(curStr);
+        xmlBufferAppend(programInfoXml, "    <Middleware>\n" \
+                                        "      <ModuleName>");
+        xmlBufferAppendEscaped(programInfoXml, mwEntry.module, mwEntry.module_len);
+        xmlBufferAppend(programInfoXml, "</ModuleName>\n" \
+                                        "      <VenderName>");
+        xmlBufferAppendEscaped(programInfoXml, mwEntry.vendor, mwEntry.vendor_len);
+        xmlBufferAppend(programInfoXml, "</VenderName>\n" \
+                                        "      <NsoName>");
+        xmlBufferAppendEscaped(programInfoXml, nso_filename, strlen(nso_filename));
+        xmlBufferAppend(programInfoXml, "</NsoName>\n" \
+                                        "    </Middleware>\n");
     }
     
-    freeNsoBinaryData();
+    if (matches) free(matches);
+    
+    releaseNsoImage(nsoImage);
     
     return true;
 }
 
-bool retrieveSymbolsListFromNso(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, Aes128CtrContext *aes_ctx, const char *nso_filename, u64 nso_base_offset, nso_header_t *nsoHeader, char *programInfoXml)
+bool retrieveSymbolsListFromNso(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, Aes128CtrContext *aes_ctx, const char *nso_filename, u64 nso_base_offset, nso_header_t *nsoHeader, xml_buffer_t *programInfoXml)
 {
     if (!ncmStorage || !ncaId || !aes_ctx || !nso_filename || !strlen(nso_filename) || !nso_base_offset || !nsoHeader || !programInfoXml)
     {
@@ -301,8 +426,6 @@ bool retrieveSymbolsListFromNso(NcmContentStorage *ncmStorage, const NcmContentI
     
     bool success = false;
     
-    char tmp[NAME_BUF_LEN] = {'\0'};
-    
     u32 mod_magic_offset;
     u32 mod_magic;
     s32 dynamic_section_offset;
@@ -325,11 +448,12 @@ bool retrieveSymbolsListFromNso(NcmContentStorage *ncmStorage, const NcmContentI
     
     u64 cur_symbol_table_offset = 0;
     
-    if (!loadNsoBinaryData(ncmStorage, ncaId, aes_ctx, nso_base_offset, nsoHeader)) return false;
+    nso_image_t *nsoImage = acquireNsoImage(ncmStorage, ncaId, aes_ctx, nso_base_offset, nsoHeader);
+    if (!nsoImage) return false;
     
-    mod_magic_offset = *((u32*)(&(nsoBinaryData[0x04])));
-    mod_magic = *((u32*)(&(nsoBinaryData[mod_magic_offset])));
-    dynamic_section_offset = ((s32)mod_magic_offset + *((s32*)(&(nsoBinaryData[mod_magic_offset + 0x04]))));
+    mod_magic_offset = *((u32*)(&(nsoImage->data[0x04])));
+    mod_magic = *((u32*)(&(nsoImage->data[mod_magic_offset])));
+    dynamic_section_offset = ((s32)mod_magic_offset + *((s32*)(&(nsoImage->data[mod_magic_offset + 0x04]))));
     
     if (__builtin_bswap32(mod_magic) != MOD_MAGIC)
     {
@@ -337,18 +461,18 @@ bool retrieveSymbolsListFromNso(NcmContentStorage *ncmStorage, const NcmContentI
         goto out;
     }
     
-    armv7 = (*((u64*)(&(nsoBinaryData[dynamic_section_offset]))) > (u64)0xFFFFFFFF || *((u64*)(&(nsoBinaryData[dynamic_section_offset + 0x10]))) > (u64)0xFFFFFFFF);
+    armv7 = (*((u64*)(&(nsoImage->data[dynamic_section_offset]))) > (u64)0xFFFFFFFF || *((u64*)(&(nsoImage->data[dynamic_section_offset + 0x10]))) > (u64)0xFFFFFFFF);
     
     // Read dynamic section
     dynamic_block_size = (armv7 ? 0x08 : 0x10);
-    dynamic_block_cnt = ((nsoBinaryDataSize - dynamic_section_offset) / dynamic_block_size);
+    dynamic_block_cnt = ((nsoImage->data_size - dynamic_section_offset) / dynamic_block_size);
     
     for(i = 0; i < dynamic_block_cnt; i++)
     {
-        if ((nsoBinaryDataSize - dynamic_section_offset - (i * dynamic_block_size)) < dynamic_block_size) break;
+        if ((nsoImage->data_size - dynamic_section_offset - (i * dynamic_block_size)) < dynamic_block_size) break;
         
-        u64 tag = (armv7 ? (u64)(*((u32*)(&(nsoBinaryData[dynamic_section_offset + (i * dynamic_block_size)])))) : *((u64*)(&(nsoBinaryData[dynamic_section_offset + (i * dynamic_block_size)]))));
-        u64 val = (armv7 ? (u64)(*((u32*)(&(nsoBinaryData[dynamic_section_offset + (i * dynamic_block_size) + 0x04])))) : *((u64*)(&(nsoBinaryData[dynamic_section_offset + (i * dynamic_block_size) + 0x08]))));
+        u64 tag = (armv7 ? (u64)(*((u32*)(&(nsoImage->data[dynamic_section_offset + (i * dynamic_block_size)])))) : *((u64*)(&(nsoImage->data[dynamic_section_offset + (i * dynamic_block_size)]))));
+        u64 val = (armv7 ? (u64)(*((u32*)(&(nsoImage->data[dynamic_section_offset + (i * dynamic_block_size) + 0x04])))) : *((u64*)(&(nsoImage->data[dynamic_section_offset + (i * dynamic_block_size) + 0x08]))));
         
         if (!tag) break;
         
@@ -384,7 +508,7 @@ bool retrieveSymbolsListFromNso(NcmContentStorage *ncmStorage, const NcmContentI
     }
     
     // Point to the symbol string table
-    symbol_str_table = ((char*)nsoBinaryData + symbol_str_table_offset);
+    symbol_str_table = ((char*)nsoImage->data + symbol_str_table_offset);
     
     // Retrieve symbol list
     cur_symbol_table_offset = symbol_table_offset;
@@ -392,12 +516,12 @@ bool retrieveSymbolsListFromNso(NcmContentStorage *ncmStorage, const NcmContentI
     {
         if (symbol_table_offset < symbol_str_table_offset && cur_symbol_table_offset >= symbol_str_table_offset) break;
         
-        u32 st_name = *((u32*)(&(nsoBinaryData[cur_symbol_table_offset])));
-        u8 st_info = (armv7 ? nsoBinaryData[cur_symbol_table_offset + 0x0C] : nsoBinaryData[cur_symbol_table_offset + 0x04]);
-        //u8 st_other = (armv7 ? nsoBinaryData[cur_symbol_table_offset + 0x0D] : nsoBinaryData[cur_symbol_table_offset + 0x05]);
-        u16 st_shndx = (armv7 ? *((u16*)(&(nsoBinaryData[cur_symbol_table_offset + 0x0E]))) : *((u16*)(&(nsoBinaryData[cur_symbol_table_offset + 0x06]))));
-        u64 st_value = (armv7 ? (u64)(*((u32*)(&(nsoBinaryData[cur_symbol_table_offset + 0x04])))) : *((u64*)(&(nsoBinaryData[cur_symbol_table_offset + 0x08]))));
-        //u64 st_size = (armv7 ? (u64)(*((u32*)(&(nsoBinaryData[cur_symbol_table_offset + 0x08])))) : *((u64*)(&(nsoBinaryData[cur_symbol_table_offset + 0x10]))));
+        u32 st_name = *((u32*)(&(nsoImage->data[cur_symbol_table_offset])));
+        u8 st_info = (armv7 ? nsoImage->data[cur_symbol_table_offset + 0x0C] : nsoImage->data[cur_symbol_table_offset + 0x04]);
+        //u8 st_other = (armv7 ? nsoImage->data[cur_symbol_table_offset + 0x0D] : nsoImage->data[cur_symbol_table_offset + 0x05]);
+        u16 st_shndx = (armv7 ? *((u16*)(&(nsoImage->data[cur_symbol_table_offset + 0x0E]))) : *((u16*)(&(nsoImage->data[cur_symbol_table_offset + 0x06]))));
+        u64 st_value = (armv7 ? (u64)(*((u32*)(&(nsoImage->data[cur_symbol_table_offset + 0x04])))) : *((u64*)(&(nsoImage->data[cur_symbol_table_offset + 0x08]))));
+        //u64 st_size = (armv7 ? (u64)(*((u32*)(&(nsoImage->data[cur_symbol_table_offset + 0x08])))) : *((u64*)(&(nsoImage->data[cur_symbol_table_offset + 0x10]))));
         
         //u8 st_vis = (st_other & 0x03);
         u8 st_type = (st_info & 0x0F);
@@ -410,21 +534,22 @@ bool retrieveSymbolsListFromNso(NcmContentStorage *ncmStorage, const NcmContentI
         // TO-DO: Add more filters?
         if (!st_shndx && !st_value && st_type != ST_OBJECT)
         {
-            sprintf(tmp, "    <UnresolvedApi>\n" \
-                         "      <ApiName>%s</ApiName>\n" \
-                         "      <NsoName>%s</NsoName>\n" \
-                         "    </UnresolvedApi>\n", \
-                         symbol_str_table + st_name, \
-                         nso_filename);
-            
-            strcat(programInfoXml, tmp);
+            xmlBufferAppend(programInfoXml, "    <UnresolvedApi>\n" \
+                                            "      <ApiName>");
+            xmlBufferAppendEscaped(programInfoXml, symbol_str_table + st_name, symbol_str_table_size - st_name);
+            xmlBufferAppend(programInfoXml, "</ApiName>\n" \
+                                            "      <NsoName>");
+            xmlBufferAppendEscaped(programInfoXml, nso_filename, strlen(nso_filename));
+            xmlBufferAppend(programInfoXml, "</NsoName>\n" \
+                                            "    </UnresolvedApi>\n");
         }
     }
     
     success = true;
     
 out:
-    freeNsoBinaryData();
+    nsoImage->pinned = false;
+    releaseNsoImage(nsoImage);
     
     return success;
 }
@@ -4,6 +4,7 @@
 #define __NSO_H__
 
 #include <switch.h>
+#include "xml_buffer.h"
 
 #define NSO_MAGIC       (u32)0x4E534F30     // "NSO0"
 #define MOD_MAGIC       (u32)0x4D4F4430     // "MOD0"
@@ -14,6 +15,12 @@
 
 #define ST_OBJECT       0x01
 
+#define NSO_MIDDLEWARE_MARKER   "SDK MW+"
+#define NSO_NNSDK_MODULE_NAME   "NintendoSdk_nnSdk"
+
+#define NSO_CACHE_MAX_ENTRIES   4
+#define NSO_CACHE_MAX_SIZE      (u64)0x6000000      // 96 MiB. Unreferenced images are evicted once the cache grows past this size
+
 typedef struct {
     u32 file_offset;
     u32 memory_offset;
@@ -49,10 +56,51 @@ typedef struct {
     u8 data_decompressed_hash[0x20];
 } PACKED nso_header_t;
 
+// Decoded NSO image (.text, .rodata and .data sections placed at their memory offsets)
+typedef struct {
+    bool valid;
+    u8 nca_id[0x10];
+    u64 nso_base_offset;
+    u32 refcount;
+    bool pinned;        // Kept cached regardless of the size limit until the symbols list has been retrieved from it (main NSO only)
+    u64 last_used;
+    u8 *data;
+    u64 data_size;
+    u64 text_offset;
+    u64 text_size;
+    u64 rodata_offset;
+    u64 rodata_size;
+    u64 data_offset;
+    u64 data_section_size;
+} nso_image_t;
+
+// Middleware marker match. Points to the whole NULL-terminated string that holds the marker
+typedef struct {
+    const char *str;
+    u64 len;
+} nso_rodata_match_t;
+
+// Parsed "SDK MW+<vendor>+<module>" string. Pointers reference the decoded NSO image
+typedef struct {
+    const char *vendor;
+    u64 vendor_len;
+    const char *module;
+    u64 module_len;
+    bool is_nnsdk;
+} nso_middleware_entry_t;
+
+// Finds all NSO_MIDDLEWARE_MARKER strings in a single pass over "data"
+// Matches are stored in a buffer allocated by this function, which must be freed by the caller
+bool scanNsoRodataForMiddleware(const u8 *data, u64 data_size, nso_rodata_match_t **out_matches, u64 *out_match_cnt);
+
+// Frees all decoded NSO images kept in the cache
+// Images are cached by NCA ID and NSO offset, so both lists below can be retrieved from a NSO while only decoding it once
+void freeNsoImageCache();
+
 // Retrieves the middleware list from a NSO stored in a partition from a NCA file
-bool retrieveMiddlewareListFromNso(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, Aes128CtrContext *aes_ctx, const char *nso_filename, u64 nso_base_offset, nso_header_t *nsoHeader, char *programInfoXml);
+bool retrieveMiddlewareListFromNso(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, Aes128CtrContext *aes_ctx, const char *nso_filename, u64 nso_base_offset, nso_header_t *nsoHeader, xml_buffer_t *programInfoXml);
 
 // Retrieves the symbols list from a NSO stored in a partition from a NCA file
-bool retrieveSymbolsListFromNso(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, Aes128CtrContext *aes_ctx, const char *nso_filename, u64 nso_base_offset, nso_header_t *nsoHeader, char *programInfoXml);
+bool retrieveSymbolsListFromNso(NcmContentStorage *ncmStorage, const NcmContentId *ncaId, Aes128CtrContext *aes_ctx, const char *nso_filename, u64 nso_base_offset, nso_header_t *nsoHeader, xml_buffer_t *programInfoXml);
 
 #endif
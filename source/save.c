@@ -2,8 +2,10 @@
 #include <string.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <sys/stat.h>
 
 #include "save.h"
+#include "fatfs/diskio.h"
 #include "util.h"
 #include "keys.h"
 
@@ -159,42 +161,40 @@ remap_segment_ctx_t *save_remap_init_segments(remap_header_t *header, remap_entr
         return NULL;
     }
     
-    unsigned int i, entry_idx = 0;
+    unsigned int i, entry_idx = 0, run_end;
     bool success = false;
     
     for(i = 0; i < header->map_segment_count; i++)
     {
         remap_segment_ctx_t *seg = &(segments[i]);
         
+        if (entry_idx >= num_map_entries)
+        {
+            snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: remap segment #%u has no map entries!", __func__, i);
+            goto out;
+        }
+        
+        // Each segment is a run of contiguous entries, so they're already sorted by virtual offset
+        // Find where it ends to allocate its entry list only once
+        run_end = (entry_idx + 1);
+        while(run_end < num_map_entries && map_entries[run_end - 1].virtual_offset_end == map_entries[run_end].virtual_offset) run_end++;
+        
         seg->entry_count = 0;
         
-        seg->entries = calloc(1, sizeof(remap_entry_ctx_t*));
+        seg->entries = calloc(run_end - entry_idx, sizeof(remap_entry_ctx_t*));
         if (!seg->entries)
         {
             snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: failed to allocate memory for remap segment entry #%u!", __func__, entry_idx);
             goto out;
         }
         
-        seg->entries[seg->entry_count++] = &map_entries[entry_idx];
         seg->offset = map_entries[entry_idx].virtual_offset;
-        map_entries[entry_idx++].segment = seg;
         
-        while(entry_idx < num_map_entries && map_entries[entry_idx - 1].virtual_offset_end == map_entries[entry_idx].virtual_offset)
+        for(; entry_idx < run_end; entry_idx++)
         {
             map_entries[entry_idx].segment = seg;
-            map_entries[entry_idx - 1].next = &map_entries[entry_idx];
-            
-            remap_entry_ctx_t **ptr = calloc(sizeof(remap_entry_ctx_t*), seg->entry_count + 1);
-            if (!ptr)
-            {
-                snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: failed to allocate memory for remap segment entry #%u!", __func__, entry_idx);
-                goto out;
-            }
-            
-            memcpy(ptr, seg->entries, sizeof(remap_entry_ctx_t*) * seg->entry_count);
-            free(seg->entries);
-            seg->entries = ptr;
-            seg->entries[seg->entry_count++] = &map_entries[entry_idx++];
+            if (seg->entry_count) map_entries[entry_idx - 1].next = &map_entries[entry_idx];
+            seg->entries[seg->entry_count++] = &map_entries[entry_idx];
         }
         
         seg->length = (seg->entries[seg->entry_count - 1]->virtual_offset_end - seg->entries[0]->virtual_offset);
@@ -250,13 +250,45 @@ remap_entry_ctx_t *save_remap_get_map_entry(remap_storage_ctx_t *ctx, u64 offset
         return NULL;
     }
     
+    // Sequential reads usually hit the last entry or the one right after it
+    remap_entry_ctx_t *entry = ctx->last_entry;
+    
+    if (entry && offset >= entry->virtual_offset)
+    {
+        if (offset < entry->virtual_offset_end) return entry;
+        
+        entry = entry->next;
+        if (entry && offset >= entry->virtual_offset && offset < entry->virtual_offset_end)
+        {
+            ctx->last_entry = entry;
+            return entry;
+        }
+    }
+    
     u32 segment_idx = (u32)(offset >> (64 - ctx->header->segment_bits));
     
-    if (segment_idx < ctx->header->map_segment_count)
+    if (segment_idx < ctx->header->map_segment_count && ctx->segments[segment_idx].entry_count)
     {
-        for(unsigned int i = 0; i < ctx->segments[segment_idx].entry_count; i++)
+        // Binary search the first entry that ends past the offset
+        remap_segment_ctx_t *seg = &(ctx->segments[segment_idx]);
+        u64 low = 0, high = seg->entry_count, mid;
+        
+        while(low < high)
         {
-            if (ctx->segments[segment_idx].entries[i]->virtual_offset_end > offset) return ctx->segments[segment_idx].entries[i];
+            mid = (low + ((high - low) / 2));
+            
+            if (seg->entries[mid]->virtual_offset_end > offset)
+            {
+                high = mid;
+            } else {
+                low = (mid + 1);
+            }
+        }
+        
+        if (low < seg->entry_count)
+        {
+            ctx->last_entry = seg->entries[low];
+            return ctx->last_entry;
         }
     }
     
@@ -354,8 +386,17 @@ u32 save_journal_storage_read(journal_storage_ctx_t *ctx, remap_storage_ctx_t *r
     {
         u32 block_num = (u32)(in_pos / ctx->block_size);
         u32 block_pos = (u32)(in_pos % ctx->block_size);
-        u64 physical_offset = (ctx->map.entries[block_num].physical_index * ctx->block_size + block_pos);
-        u32 bytes_to_read = ((ctx->block_size - block_pos) < remaining ? (ctx->block_size - block_pos) : remaining);
+        
+        if (block_num >= ctx->map.header->main_data_block_count)
+        {
+            snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: journal block #%u out of range!", __func__, block_num);
+            return out_pos;
+        }
+        
+        // Read up to the end of the physically contiguous run that holds the current block
+        u64 physical_offset = ((u64)ctx->map.entries[block_num].physical_index * ctx->block_size + block_pos);
+        u64 run_size = (((u64)ctx->map.run_lengths[block_num] * ctx->block_size) - block_pos);
+        u32 bytes_to_read = (run_size < remaining ? (u32)run_size : remaining);
         
         br = save_remap_read(remap, (u8*)buffer + out_pos, ctx->journal_data_offset + physical_offset, bytes_to_read);
         if (br != bytes_to_read)
@@ -457,6 +498,16 @@ bool save_ivfc_storage_init(hierarchical_integrity_verification_storage_ctx_t *c
         
         ctx->level_validities[i - 1] = level_data->block_validities;
         if (i > 1) level_data->next_level = &ctx->integrity_storages[i - 2];
+        
+        level_data->scratch = malloc(level_data->sector_size + (i > 1 ? init_info[i - 1].block_size : 0));
+        if (!level_data->scratch)
+        {
+            snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: failed to allocate memory for scratch buffer in IVFC level #%u!", __func__, i);
+            goto out;
+        }
+        
+        level_data->hash_block_index = 0;
+        level_data->hash_block_valid = false;
     }
     
     ctx->data_level = &levels[ivfc->num_levels - 1];
@@ -467,13 +518,16 @@ bool save_ivfc_storage_init(hierarchical_integrity_verification_storage_ctx_t *c
 out:
     if (!success && ctx->level_validities)
     {
-        free(ctx->level_validities);
-        ctx->level_validities = NULL;
-        
         for(unsigned int i = 1; i < ivfc->num_levels; i++)
         {
             integrity_verification_storage_ctx_t *level_data = &ctx->integrity_storages[i - 1];
             
+            if (level_data->scratch)
+            {
+                free(level_data->scratch);
+                level_data->scratch = NULL;
+            }
+            
             if (level_data->block_validities)
             {
                 free(level_data->block_validities);
@@ -483,6 +537,9 @@ out:
                 break;
             }
         }
+        
+        free(ctx->level_validities);
+        ctx->level_validities = NULL;
     }
     
     return success;
@@ -576,12 +633,31 @@ bool save_ivfc_storage_read(integrity_verification_storage_ctx_t *ctx, void *buf
     
     if (ctx->next_level)
     {
-        if (!save_ivfc_storage_read(ctx->next_level, hash_buffer, hash_pos, 0x20, verify))
+        // Hashes for consecutive sectors live in the same block from the next level, so it's only read once
+        // It must be read again if it hasn't been verified yet and verification was requested
+        integrity_verification_storage_ctx_t *next_level = ctx->next_level;
+        u64 hash_block_index = (hash_pos / next_level->sector_size);
+        u64 hash_block_offset = (hash_block_index * next_level->sector_size);
+        u8 *hash_block = (ctx->scratch + ctx->sector_size);
+        
+        if (!ctx->hash_block_valid || ctx->hash_block_index != hash_block_index || (verify && next_level->block_validities[hash_block_index] != VALIDITY_VALID))
         {
-            snprintf(tmp, MAX_CHARACTERS(tmp), "\n%s: failed to read hash from next IVFC level!", __func__);
-            strcat(strbuf, tmp);
-            return false;
+            u64 hash_block_size = ((next_level->_length - hash_block_offset) < next_level->sector_size ? (next_level->_length - hash_block_offset) : next_level->sector_size);
+            
+            ctx->hash_block_valid = false;
+            
+            if (!save_ivfc_storage_read(next_level, hash_block, hash_block_offset, hash_block_size, verify))
+            {
+                snprintf(tmp, MAX_CHARACTERS(tmp), "\n%s: failed to read hash from next IVFC level!", __func__);
+                strcat(strbuf, tmp);
+                return false;
+            }
+            
+            ctx->hash_block_index = hash_block_index;
+            ctx->hash_block_valid = true;
         }
+        
+        memcpy(hash_buffer, hash_block + (hash_pos - hash_block_offset), 0x20);
     } else {
         if (save_ivfc_level_fread(ctx->hash_storage, hash_buffer, hash_pos, 0x20) != 0x20)
         {
@@ -598,31 +674,41 @@ bool save_ivfc_storage_read(integrity_verification_storage_ctx_t *ctx, void *buf
         return true;
     }
     
-    if (save_ivfc_level_fread(ctx->base_storage, buffer, offset, count) != count)
+    bool check = (verify && ctx->block_validities[block_index] == VALIDITY_UNCHECKED);
+    
+    // The whole sector is needed to verify partial reads, so those go through the scratch buffer
+    u64 sector_offset = (block_index * ctx->sector_size);
+    u64 sector_data_size = ((ctx->_length - sector_offset) < ctx->sector_size ? (ctx->_length - sector_offset) : ctx->sector_size);
+    bool use_scratch = (check && (offset != sector_offset || count != ctx->sector_size));
+    
+    u8 *data_buffer = (use_scratch ? ctx->scratch : (u8*)buffer);
+    u64 read_offset = (use_scratch ? sector_offset : offset);
+    u64 read_size = (use_scratch ? sector_data_size : count);
+    
+    if (save_ivfc_level_fread(ctx->base_storage, data_buffer, read_offset, read_size) != read_size)
     {
         snprintf(tmp, MAX_CHARACTERS(tmp), "\n%s: failed to read IVFC level from base storage!", __func__);
         strcat(strbuf, tmp);
         return false;
     }
     
-    if (!(verify && ctx->block_validities[block_index] == VALIDITY_UNCHECKED)) return true;
-    
-    u8 hash[0x20] = {0};
-    
-    u8 *data_buffer = calloc(1, ctx->sector_size + 0x20);
-    if (!data_buffer)
+    if (use_scratch)
     {
-        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: failed to allocate memory for data buffer!", __func__);
-        return false;
+        if (sector_data_size < ctx->sector_size) memset(data_buffer + sector_data_size, 0, ctx->sector_size - sector_data_size);
+        memcpy(buffer, data_buffer + (offset - sector_offset), count);
     }
     
-    memcpy(data_buffer, ctx->salt, 0x20);
-    memcpy(data_buffer + 0x20, buffer, ctx->sector_size);
+    if (!check) return true;
     
-    sha256CalculateHash(hash, data_buffer, ctx->sector_size + 0x20);
+    u8 hash[0x20] = {0};
+    
+    // Hash the salt and the sector data without copying them into a single buffer
+    Sha256Context sha_ctx;
+    sha256ContextCreate(&sha_ctx);
+    sha256ContextUpdate(&sha_ctx, ctx->salt, 0x20);
+    sha256ContextUpdate(&sha_ctx, data_buffer, ctx->sector_size);
+    sha256ContextGetHash(&sha_ctx, hash);
     hash[0x1F] |= 0x80;
-
-    free(data_buffer);
     
     ctx->block_validities[block_index] = (!memcmp(hash_buffer, hash, 0x20) ? VALIDITY_VALID : VALIDITY_INVALID);
 
@@ -830,24 +916,138 @@ bool save_allocation_table_iterator_seek(allocation_table_iterator_ctx_t *ctx, u
     }
 }
 
-u32 save_allocation_table_storage_read(allocation_table_storage_ctx_t *ctx, void *buffer, u64 offset, size_t count)
+bool save_allocation_table_storage_build_extents(allocation_table_storage_ctx_t *ctx)
 {
-    if (!ctx || !ctx->fat || !ctx->block_size || !buffer || !count)
+    if (!ctx || !ctx->fat)
     {
-        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: invalid parameters to read data from FAT storage!", __func__);
-        return 0;
+        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: invalid parameters to build FAT storage extents!", __func__);
+        return false;
     }
     
+    save_allocation_table_storage_free_extents(ctx);
+    
+    if (ctx->initial_block == 0xFFFFFFFF) return true;
+    
     char tmp[NAME_BUF_LEN / 2] = {'\0'};
     
+    u32 extents_size = 0;
+    allocation_table_extent_t *tmp_extents = NULL;
+    
     allocation_table_iterator_ctx_t iterator;
     if (!save_allocation_table_iterator_begin(&iterator, ctx->fat, ctx->initial_block))
     {
         snprintf(tmp, MAX_CHARACTERS(tmp), "\n%s: failed to initialize FAT interator!", __func__);
         strcat(strbuf, tmp);
+        return false;
+    }
+    
+    // Walk the block chain only once
+    while(true)
+    {
+        if (ctx->extent_cnt >= extents_size)
+        {
+            extents_size = (extents_size ? (extents_size * 2) : 16);
+            
+            tmp_extents = realloc(ctx->extents, extents_size * sizeof(allocation_table_extent_t));
+            if (!tmp_extents)
+            {
+                snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: failed to reallocate FAT storage extents!", __func__);
+                save_allocation_table_storage_free_extents(ctx);
+                return false;
+            }
+            
+            ctx->extents = tmp_extents;
+            tmp_extents = NULL;
+        }
+        
+        ctx->extents[ctx->extent_cnt].virtual_block = iterator.virtual_block;
+        ctx->extents[ctx->extent_cnt].physical_block = iterator.physical_block;
+        ctx->extents[ctx->extent_cnt].length = iterator.current_segment_size;
+        ctx->extent_cnt++;
+        
+        if (iterator.next_block == 0xFFFFFFFF) break;
+        
+        if (!save_allocation_table_iterator_move_next(&iterator))
+        {
+            snprintf(tmp, MAX_CHARACTERS(tmp), "\n%s: failed to move FAT iterator to the next block!", __func__);
+            strcat(strbuf, tmp);
+            save_allocation_table_storage_free_extents(ctx);
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+void save_allocation_table_storage_free_extents(allocation_table_storage_ctx_t *ctx)
+{
+    if (!ctx) return;
+    
+    if (ctx->extents) free(ctx->extents);
+    
+    ctx->extents = NULL;
+    ctx->extent_cnt = 0;
+}
+
+static bool save_allocation_table_storage_seek(allocation_table_storage_ctx_t *ctx, u32 block, allocation_table_iterator_ctx_t *out)
+{
+    if (ctx->extents && ctx->extent_cnt)
+    {
+        // Binary search the extent holding this block
+        u32 low = 0, high = ctx->extent_cnt, mid;
+        
+        while(low < high)
+        {
+            mid = (low + ((high - low) / 2));
+            
+            if ((ctx->extents[mid].virtual_block + ctx->extents[mid].length) <= block)
+            {
+                low = (mid + 1);
+            } else {
+                high = mid;
+            }
+        }
+        
+        if (low >= ctx->extent_cnt || block < ctx->extents[low].virtual_block)
+        {
+            snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: block #%u is out of bounds!", __func__, block);
+            return false;
+        }
+        
+        out->virtual_block = ctx->extents[low].virtual_block;
+        out->physical_block = ctx->extents[low].physical_block;
+        out->current_segment_size = ctx->extents[low].length;
+        
+        return true;
+    }
+    
+    // Walking back from the cursor would take longer than starting over
+    if (!ctx->cursor_valid || block < (ctx->cursor.virtual_block / 2))
+    {
+        ctx->cursor_valid = save_allocation_table_iterator_begin(&ctx->cursor, ctx->fat, ctx->initial_block);
+        if (!ctx->cursor_valid) return false;
+    }
+    
+    ctx->cursor_valid = save_allocation_table_iterator_seek(&ctx->cursor, block);
+    if (!ctx->cursor_valid) return false;
+    
+    memcpy(out, &(ctx->cursor), sizeof(allocation_table_iterator_ctx_t));
+    
+    return true;
+}
+
+u32 save_allocation_table_storage_read(allocation_table_storage_ctx_t *ctx, void *buffer, u64 offset, size_t count)
+{
+    if (!ctx || !ctx->fat || !ctx->block_size || !buffer || !count)
+    {
+        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: invalid parameters to read data from FAT storage!", __func__);
         return 0;
     }
     
+    char tmp[NAME_BUF_LEN / 2] = {'\0'};
+    
+    allocation_table_iterator_ctx_t iterator;
+    
     u64 in_pos = offset;
     u32 out_pos = 0;
     u32 remaining = count;
@@ -855,7 +1055,7 @@ u32 save_allocation_table_storage_read(allocation_table_storage_ctx_t *ctx, void
     while(remaining)
     {
         u32 block_num = (u32)(in_pos / ctx->block_size);
-        if (!save_allocation_table_iterator_seek(&iterator, block_num))
+        if (!save_allocation_table_storage_seek(ctx, block_num, &iterator))
         {
             snprintf(tmp, MAX_CHARACTERS(tmp), "\n%s: failed to seek to block #%u within offset 0x%lX!", __func__, block_num, offset);
             strcat(strbuf, tmp);
@@ -971,11 +1171,133 @@ bool save_fs_list_get_value(save_filesystem_list_ctx_t *ctx, u32 index, save_fs_
     return true;
 }
 
+static u32 save_fs_list_hash_key(u32 parent, const char *name)
+{
+    // FNV-1a over the parent index and the name
+    u32 hash = 0x811C9DC5;
+    
+    for(unsigned int i = 0; i < 4; i++)
+    {
+        hash ^= ((parent >> (i * 8)) & 0xFF);
+        hash *= 0x01000193;
+    }
+    
+    for(unsigned int i = 0; i < SAVE_FS_LIST_MAX_NAME_LENGTH && name[i]; i++)
+    {
+        hash ^= (u8)name[i];
+        hash *= 0x01000193;
+    }
+    
+    return hash;
+}
+
+void save_fs_list_free_index(save_filesystem_list_ctx_t *ctx)
+{
+    if (!ctx) return;
+    
+    if (ctx->index_entries) free(ctx->index_entries);
+    if (ctx->index_buckets) free(ctx->index_buckets);
+    
+    ctx->index_entries = NULL;
+    ctx->index_entry_cnt = 0;
+    ctx->index_buckets = NULL;
+    ctx->index_bucket_cnt = 0;
+}
+
+// Walks the used entry list only once, so path lookups don't need to do it for every path component
+bool save_fs_list_build_index(save_filesystem_list_ctx_t *ctx)
+{
+    if (!ctx)
+    {
+        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: invalid parameters to build FS list index!", __func__);
+        return false;
+    }
+    
+    char tmp[NAME_BUF_LEN / 2] = {'\0'};
+    
+    save_fs_list_free_index(ctx);
+    
+    u32 capacity = save_fs_list_get_capacity(ctx);
+    if (!capacity)
+    {
+        snprintf(tmp, MAX_CHARACTERS(tmp), "\n%s: failed to retrieve FS capacity!", __func__);
+        strcat(strbuf, tmp);
+        return false;
+    }
+    
+    save_fs_list_entry_t entry;
+    if (!save_fs_list_read_entry(ctx, ctx->used_list_head_index, &entry))
+    {
+        snprintf(tmp, MAX_CHARACTERS(tmp), "\n%s: failed to read FS entry for initial index %u!", __func__, ctx->used_list_head_index);
+        strcat(strbuf, tmp);
+        return false;
+    }
+    
+    ctx->index_entries = calloc(capacity, sizeof(save_fs_list_index_entry_t));
+    if (!ctx->index_entries)
+    {
+        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: failed to allocate memory for FS list index entries!", __func__);
+        return false;
+    }
+    
+    u32 index = entry.next, bucket;
+    
+    // The used entry list can't hold more entries than the table capacity
+    while(index)
+    {
+        if (index > capacity || ctx->index_entry_cnt >= capacity)
+        {
+            snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: save entry index %u out of range!", __func__, index);
+            goto out;
+        }
+        
+        if (!save_fs_list_read_entry(ctx, index, &entry))
+        {
+            snprintf(tmp, MAX_CHARACTERS(tmp), "\n%s: failed to read FS entry for index %u!", __func__, index);
+            strcat(strbuf, tmp);
+            goto out;
+        }
+        
+        save_fs_list_index_entry_t *index_entry = &(ctx->index_entries[ctx->index_entry_cnt++]);
+        index_entry->parent = entry.parent;
+        index_entry->index = index;
+        memcpy(index_entry->name, entry.name, SAVE_FS_LIST_MAX_NAME_LENGTH);
+        
+        index = entry.next;
+    }
+    
+    // Keep the load factor at or below 50%
+    ctx->index_bucket_cnt = 16;
+    while(ctx->index_bucket_cnt < (ctx->index_entry_cnt * 2)) ctx->index_bucket_cnt <<= 1;
+    
+    ctx->index_buckets = calloc(ctx->index_bucket_cnt, sizeof(u32));
+    if (!ctx->index_buckets)
+    {
+        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: failed to allocate memory for FS list index buckets!", __func__);
+        goto out;
+    }
+    
+    for(u32 i = 0; i < ctx->index_entry_cnt; i++)
+    {
+        bucket = (save_fs_list_hash_key(ctx->index_entries[i].parent, ctx->index_entries[i].name) & (ctx->index_bucket_cnt - 1));
+        while(ctx->index_buckets[bucket]) bucket = ((bucket + 1) & (ctx->index_bucket_cnt - 1));
+        
+        ctx->index_buckets[bucket] = (i + 1);
+    }
+    
+    return true;
+    
+out:
+    save_fs_list_free_index(ctx);
+    return false;
+}
+
 u32 save_fs_get_index_from_key(save_filesystem_list_ctx_t *ctx, save_entry_key_t *key, u32 *prev_index)
 {
     char tmp[NAME_BUF_LEN / 2] = {'\0'};
     
     u32 prev;
+    bool need_prev = (prev_index != NULL);
     if (!prev_index) prev_index = &prev;
     
     if (!ctx || !key)
@@ -984,6 +1306,23 @@ u32 save_fs_get_index_from_key(save_filesystem_list_ctx_t *ctx, save_entry_key_t
         goto out;
     }
     
+    // The lookup table doesn't keep track of previous list entries
+    if (!need_prev && ctx->index_buckets && ctx->index_bucket_cnt)
+    {
+        u32 bucket = (save_fs_list_hash_key(key->parent, key->name) & (ctx->index_bucket_cnt - 1));
+        
+        while(ctx->index_buckets[bucket])
+        {
+            save_fs_list_index_entry_t *index_entry = &(ctx->index_entries[ctx->index_buckets[bucket] - 1]);
+            if (index_entry->parent == key->parent && !strncmp(index_entry->name, key->name, SAVE_FS_LIST_MAX_NAME_LENGTH)) return index_entry->index;
+            
+            bucket = ((bucket + 1) & (ctx->index_bucket_cnt - 1));
+        }
+        
+        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: unable to find FS index from key!", __func__);
+        goto out;
+    }
+    
     u32 capacity = save_fs_list_get_capacity(ctx);
     if (!capacity)
     {
@@ -1114,6 +1453,9 @@ bool save_open_fat_storage(save_filesystem_ctx_t *ctx, allocation_table_storage_
     storage_ctx->fat = &ctx->allocation_table;
     storage_ctx->block_size = (u32)ctx->header->block_size;
     storage_ctx->initial_block = block_index;
+    storage_ctx->cursor_valid = false;
+    storage_ctx->extents = NULL;
+    storage_ctx->extent_cnt = 0;
     
     if (block_index == 0xFFFFFFFF)
     {
@@ -1162,11 +1504,20 @@ bool save_filesystem_init(save_filesystem_ctx_t *ctx, void *fat, save_fs_header_
         return false;
     }
     
+    // Directory and file table entries are looked up by index, so map their block chains only once
+    // Reads fall back to the iterator cursor if this fails
+    save_allocation_table_storage_build_extents(&ctx->file_table.directory_table.storage);
+    save_allocation_table_storage_build_extents(&ctx->file_table.file_table.storage);
+    
     ctx->file_table.file_table.free_list_head_index = 0;
     ctx->file_table.file_table.used_list_head_index = 1;
     ctx->file_table.directory_table.free_list_head_index = 0;
     ctx->file_table.directory_table.used_list_head_index = 1;
     
+    // Path lookups fall back to walking the used entry lists if this fails
+    save_fs_list_build_index(&ctx->file_table.directory_table);
+    save_fs_list_build_index(&ctx->file_table.file_table);
+    
     return true;
 }
 
@@ -1399,6 +1750,7 @@ bool save_process(save_ctx_t *ctx)
     }
     
     /* Initialize data remap storage. */
+    ctx->data_remap_storage.last_entry = NULL;
     ctx->data_remap_storage.segments = save_remap_init_segments(ctx->data_remap_storage.header, ctx->data_remap_storage.map_entries, ctx->data_remap_storage.header->map_entry_count);
     if (!ctx->data_remap_storage.segments)
     {
@@ -1542,6 +1894,7 @@ bool save_process(save_ctx_t *ctx)
         ctx->meta_remap_storage.map_entries[i].virtual_offset_end = (ctx->meta_remap_storage.map_entries[i].virtual_offset + ctx->meta_remap_storage.map_entries[i].size);
     }
     
+    ctx->meta_remap_storage.last_entry = NULL;
     ctx->meta_remap_storage.segments = save_remap_init_segments(ctx->meta_remap_storage.header, ctx->meta_remap_storage.map_entries, ctx->meta_remap_storage.header->map_entry_count);
     if (!ctx->meta_remap_storage.segments)
     {
@@ -1589,6 +1942,22 @@ bool save_process(save_ctx_t *ctx)
         pos += 2;
     }
     
+    ctx->journal_storage.map.run_lengths = calloc(sizeof(u32), ctx->journal_storage.map.header->main_data_block_count);
+    if (!ctx->journal_storage.map.run_lengths)
+    {
+        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: failed to allocate memory for journal map run lengths!", __func__);
+        goto out;
+    }
+    
+    for(unsigned int i = ctx->journal_storage.map.header->main_data_block_count; i > 0; i--)
+    {
+        journal_map_entry_t *entries = ctx->journal_storage.map.entries;
+        u32 *run_lengths = ctx->journal_storage.map.run_lengths;
+        
+        bool contiguous = (i < ctx->journal_storage.map.header->main_data_block_count && entries[i].physical_index == (entries[i - 1].physical_index + 1));
+        run_lengths[i - 1] = (contiguous ? (run_lengths[i] + 1) : 1);
+    }
+    
     ctx->journal_storage.block_size = ctx->journal_storage.header->block_size;
     ctx->journal_storage._length = (ctx->journal_storage.header->total_size - ctx->journal_storage.header->journal_size);
     
@@ -1718,6 +2087,7 @@ void save_free_contexts(save_ctx_t *ctx)
         
         free(ctx->data_remap_storage.segments);
         ctx->data_remap_storage.segments = NULL;
+        ctx->data_remap_storage.last_entry = NULL;
     }
     
     if (ctx->data_remap_storage.map_entries)
@@ -1738,6 +2108,7 @@ void save_free_contexts(save_ctx_t *ctx)
         
         free(ctx->meta_remap_storage.segments);
         ctx->meta_remap_storage.segments = NULL;
+        ctx->meta_remap_storage.last_entry = NULL;
     }
     
     if (ctx->meta_remap_storage.map_entries)
@@ -1791,6 +2162,12 @@ void save_free_contexts(save_ctx_t *ctx)
         ctx->journal_storage.map.entries = NULL;
     }
     
+    if (ctx->journal_storage.map.run_lengths)
+    {
+        free(ctx->journal_storage.map.run_lengths);
+        ctx->journal_storage.map.run_lengths = NULL;
+    }
+    
     for(unsigned int i = 0; i < ctx->header.data_ivfc_header.num_levels - 1; i++)
     {
         if (ctx->core_data_ivfc_storage.integrity_storages[i].block_validities)
@@ -1798,6 +2175,12 @@ void save_free_contexts(save_ctx_t *ctx)
             free(ctx->core_data_ivfc_storage.integrity_storages[i].block_validities);
             ctx->core_data_ivfc_storage.integrity_storages[i].block_validities = NULL;
         }
+        
+        if (ctx->core_data_ivfc_storage.integrity_storages[i].scratch)
+        {
+            free(ctx->core_data_ivfc_storage.integrity_storages[i].scratch);
+            ctx->core_data_ivfc_storage.integrity_storages[i].scratch = NULL;
+        }
     }
     
     if (ctx->core_data_ivfc_storage.level_validities)
@@ -1815,6 +2198,12 @@ void save_free_contexts(save_ctx_t *ctx)
                 free(ctx->fat_ivfc_storage.integrity_storages[i].block_validities);
                 ctx->fat_ivfc_storage.integrity_storages[i].block_validities = NULL;
             }
+            
+            if (ctx->fat_ivfc_storage.integrity_storages[i].scratch)
+            {
+                free(ctx->fat_ivfc_storage.integrity_storages[i].scratch);
+                ctx->fat_ivfc_storage.integrity_storages[i].scratch = NULL;
+            }
         }
     }
     
@@ -1829,6 +2218,172 @@ void save_free_contexts(save_ctx_t *ctx)
         free(ctx->fat_storage);
         ctx->fat_storage = NULL;
     }
+    
+    save_allocation_table_storage_free_extents(&ctx->save_filesystem_core.file_table.directory_table.storage);
+    save_allocation_table_storage_free_extents(&ctx->save_filesystem_core.file_table.file_table.storage);
+    
+    save_fs_list_free_index(&ctx->save_filesystem_core.file_table.directory_table);
+    save_fs_list_free_index(&ctx->save_filesystem_core.file_table.file_table);
+}
+
+static bool save_extract_file(save_ctx_t *ctx, save_fs_list_entry_t *entry, const char *out_path, u8 *buf, u64 buf_size, save_extract_stats_t *stats)
+{
+    char tmp[NAME_BUF_LEN / 2] = {'\0'};
+    
+    allocation_table_storage_ctx_t fat_storage;
+    memset(&fat_storage, 0, sizeof(allocation_table_storage_ctx_t));
+    
+    u64 file_size = entry->value.save_file_info.length;
+    u64 offset = 0, n = 0;
+    FILE *outFile = NULL;
+    bool success = false;
+    
+    if (!save_open_fat_storage(&ctx->save_filesystem_core, &fat_storage, entry->value.save_file_info.start_block))
+    {
+        snprintf(tmp, MAX_CHARACTERS(tmp), "\n%s: failed to open FAT storage for \"%s\"!", __func__, out_path);
+        strcat(strbuf, tmp);
+        return false;
+    }
+    
+    if (file_size > fat_storage._length)
+    {
+        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: file size exceeds FAT storage length for \"%s\"!", __func__, out_path);
+        return false;
+    }
+    
+    // Chunks are a multiple of the FAT block size, so each read covers whole blocks and follows the block chain only once
+    u64 chunk_size = (buf_size >= fat_storage.block_size ? (buf_size - (buf_size % fat_storage.block_size)) : buf_size);
+    
+    outFile = fopen(out_path, "wb");
+    if (!outFile)
+    {
+        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: failed to open output file \"%s\"!", __func__, out_path);
+        return false;
+    }
+    
+    for(offset = 0; offset < file_size; offset += n)
+    {
+        n = ((file_size - offset) < chunk_size ? (file_size - offset) : chunk_size);
+        
+        if (save_allocation_table_storage_read(&fat_storage, buf, offset, n) != n)
+        {
+            snprintf(tmp, MAX_CHARACTERS(tmp), "\n%s: failed to read 0x%lX bytes chunk at offset 0x%lX from \"%s\"!", __func__, n, offset, out_path);
+            strcat(strbuf, tmp);
+            goto out;
+        }
+        
+        if (fwrite(buf, 1, n, outFile) != n)
+        {
+            snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: failed to write 0x%lX bytes chunk at offset 0x%lX to \"%s\"!", __func__, n, offset, out_path);
+            goto out;
+        }
+    }
+    
+    stats->file_cnt++;
+    stats->total_size += file_size;
+    
+    success = true;
+    
+out:
+    fclose(outFile);
+    
+    if (!success) remove(out_path);
+    
+    return success;
+}
+
+static bool save_extract_directory(save_ctx_t *ctx, u32 dir_index, char *out_path, size_t out_path_size, u8 *buf, u64 buf_size, save_extract_stats_t *stats)
+{
+    char tmp[NAME_BUF_LEN / 2] = {'\0'};
+    
+    hierarchical_save_file_table_ctx_t *table = &ctx->save_filesystem_core.file_table;
+    save_fs_list_entry_t dir_entry, entry;
+    size_t path_len = strlen(out_path);
+    u32 index;
+    
+    if (!save_fs_list_get_value(&table->directory_table, dir_index, &dir_entry))
+    {
+        snprintf(tmp, MAX_CHARACTERS(tmp), "\n%s: unable to get directory entry #%u!", __func__, dir_index);
+        strcat(strbuf, tmp);
+        return false;
+    }
+    
+    mkdir(out_path, 0744);
+    stats->dir_cnt++;
+    
+    // Children are linked through their sibling index. Zero ends each list
+    for(index = dir_entry.value.save_find_position.next_file; index != 0 && index != 0xFFFFFFFF; index = entry.value.next_sibling)
+    {
+        if (!save_fs_list_get_value(&table->file_table, index, &entry))
+        {
+            snprintf(tmp, MAX_CHARACTERS(tmp), "\n%s: unable to get file entry #%u!", __func__, index);
+            strcat(strbuf, tmp);
+            return false;
+        }
+        
+        if ((size_t)snprintf(out_path + path_len, out_path_size - path_len, "/%.*s", SAVE_FS_LIST_MAX_NAME_LENGTH, entry.name) >= (out_path_size - path_len))
+        {
+            out_path[path_len] = '\0';
+            snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: output path too long for file entry #%u!", __func__, index);
+            return false;
+        }
+        
+        bool extracted = save_extract_file(ctx, &entry, out_path, buf, buf_size, stats);
+        out_path[path_len] = '\0';
+        if (!extracted) return false;
+    }
+    
+    for(index = dir_entry.value.save_find_position.next_directory; index != 0 && index != 0xFFFFFFFF; index = entry.value.next_sibling)
+    {
+        if (!save_fs_list_get_value(&table->directory_table, index, &entry))
+        {
+            snprintf(tmp, MAX_CHARACTERS(tmp), "\n%s: unable to get directory entry #%u!", __func__, index);
+            strcat(strbuf, tmp);
+            return false;
+        }
+        
+        if ((size_t)snprintf(out_path + path_len, out_path_size - path_len, "/%.*s", SAVE_FS_LIST_MAX_NAME_LENGTH, entry.name) >= (out_path_size - path_len))
+        {
+            out_path[path_len] = '\0';
+            snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: output path too long for directory entry #%u!", __func__, index);
+            return false;
+        }
+        
+        bool extracted = save_extract_directory(ctx, index, out_path, out_path_size, buf, buf_size, stats);
+        out_path[path_len] = '\0';
+        if (!extracted) return false;
+    }
+    
+    return true;
+}
+
+bool save_extract_filesystem(save_ctx_t *ctx, char *out_path, size_t out_path_size, u8 *buf, u64 buf_size, save_extract_stats_t *stats)
+{
+    if (!ctx || !out_path || !strlen(out_path) || strlen(out_path) >= out_path_size || !buf || !buf_size || !stats)
+    {
+        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: invalid parameters to extract savefile FS!", __func__);
+        return false;
+    }
+    
+    char tmp[NAME_BUF_LEN / 2] = {'\0'};
+    
+    // The root directory is stored with an empty name and no parent
+    save_entry_key_t key;
+    memset(&key, 0, sizeof(save_entry_key_t));
+    
+    u32 root_index = save_fs_get_index_from_key(&ctx->save_filesystem_core.file_table.directory_table, &key, NULL);
+    if (root_index == 0xFFFFFFFF)
+    {
+        snprintf(tmp, MAX_CHARACTERS(tmp), "\n%s: unable to locate root directory!", __func__);
+        strcat(strbuf, tmp);
+        return false;
+    }
+    
+    // Strip trailing path separators, every entry appends its own
+    size_t path_len = strlen(out_path);
+    while(path_len > 1 && out_path[path_len - 1] == '/') out_path[--path_len] = '\0';
+    
+    return save_extract_directory(ctx, root_index, out_path, out_path_size, buf, buf_size, stats);
 }
 
 bool readCertsFromSystemSave()
@@ -1859,6 +2414,9 @@ bool readCertsFromSystemSave()
         goto out;
     }
     
+    // Drop cached sectors first, since the system may have written to the savefile since the last access
+    disk_cache_reset();
+    
     fr = f_open(certSave, BIS_CERT_SAVE_NAME, FA_READ | FA_OPEN_EXISTING);
     if (fr != FR_OK)
     {
@@ -190,6 +190,7 @@ typedef struct {
     remap_header_t *header;
     remap_entry_ctx_t *map_entries;
     remap_segment_ctx_t *segments;
+    remap_entry_ctx_t *last_entry; // Last map entry returned by save_remap_get_map_entry()
     enum base_storage_type type;
     u64 base_storage_offset;
     duplex_storage_ctx_t *duplex;
@@ -268,6 +269,7 @@ typedef struct {
 typedef struct {
     journal_map_header_t *header;
     journal_map_entry_t *entries;
+    u32 *run_lengths; // Number of blocks starting at each virtual block that are also contiguous in the physical journal data
     u8 *map_storage;
 } journal_map_ctx_t;
 
@@ -307,6 +309,9 @@ struct integrity_verification_storage_ctx_t {
     u32 sector_count;
     u64 _length;
     integrity_verification_storage_ctx_t *next_level;
+    u8 *scratch; // Full sector buffer, followed by the cached hash block from the next level
+    u64 hash_block_index;
+    bool hash_block_valid;
 };
 
 typedef struct {
@@ -328,14 +333,6 @@ typedef struct {
     fat_header_t *header;
 } allocation_table_ctx_t;
 
-typedef struct {
-    hierarchical_integrity_verification_storage_ctx_t *base_storage;
-    u32 block_size;
-    u32 initial_block;
-    allocation_table_ctx_t *fat;
-    u64 _length;
-} allocation_table_storage_ctx_t;
-
 typedef struct {
     allocation_table_ctx_t *fat;
     u32 virtual_block;
@@ -345,6 +342,24 @@ typedef struct {
     u32 prev_block;
 } allocation_table_iterator_ctx_t;
 
+typedef struct {
+    u32 virtual_block;
+    u32 physical_block;
+    u32 length; // In blocks
+} allocation_table_extent_t;
+
+typedef struct {
+    hierarchical_integrity_verification_storage_ctx_t *base_storage;
+    u32 block_size;
+    u32 initial_block;
+    allocation_table_ctx_t *fat;
+    u64 _length;
+    allocation_table_iterator_ctx_t cursor; // Kept between reads, so sequential reads don't walk the block chain from its start
+    bool cursor_valid;
+    allocation_table_extent_t *extents; // Optional virtual to physical block map, used for random access
+    u32 extent_cnt;
+} allocation_table_storage_ctx_t;
+
 typedef struct {
     char name[SAVE_FS_LIST_MAX_NAME_LENGTH];
     u32 parent;
@@ -385,11 +400,21 @@ typedef struct {
 } save_fs_list_entry_t;
 #pragma pack(pop)
 
+typedef struct {
+    u32 parent;
+    u32 index;
+    char name[SAVE_FS_LIST_MAX_NAME_LENGTH];
+} save_fs_list_index_entry_t;
+
 typedef struct {
     u32 free_list_head_index;
     u32 used_list_head_index;
     allocation_table_storage_ctx_t storage;
     u32 capacity;
+    save_fs_list_index_entry_t *index_entries; // Optional (parent, name) lookup table for used entries
+    u32 index_entry_cnt;
+    u32 *index_buckets; // Holds index entry numbers plus one. Zero marks an empty bucket
+    u32 index_bucket_cnt; // Always a power of two
 } save_filesystem_list_ctx_t;
 
 typedef struct {
@@ -404,6 +429,12 @@ typedef struct {
     hierarchical_save_file_table_ctx_t file_table;
 } save_filesystem_ctx_t;
 
+typedef struct {
+    u32 file_cnt;
+    u32 dir_cnt;
+    u64 total_size;
+} save_extract_stats_t;
+
 struct save_ctx_t {
     save_header_t header;
     FIL *file;
@@ -478,11 +509,16 @@ bool save_process_header(save_ctx_t *ctx);
 void save_free_contexts(save_ctx_t *ctx);
 
 bool save_open_fat_storage(save_filesystem_ctx_t *ctx, allocation_table_storage_ctx_t *storage_ctx, u32 block_index);
+bool save_allocation_table_storage_build_extents(allocation_table_storage_ctx_t *ctx);
+void save_allocation_table_storage_free_extents(allocation_table_storage_ctx_t *ctx);
 u32 save_allocation_table_storage_read(allocation_table_storage_ctx_t *ctx, void *buffer, u64 offset, size_t count);
 bool save_fs_list_get_value(save_filesystem_list_ctx_t *ctx, u32 index, save_fs_list_entry_t *value);
+bool save_fs_list_build_index(save_filesystem_list_ctx_t *ctx);
+void save_fs_list_free_index(save_filesystem_list_ctx_t *ctx);
 u32 save_fs_get_index_from_key(save_filesystem_list_ctx_t *ctx, save_entry_key_t *key, u32 *prev_index);
 bool save_hierarchical_file_table_find_path_recursive(hierarchical_save_file_table_ctx_t *ctx, save_entry_key_t *key, const char *path);
 bool save_hierarchical_file_table_get_file_entry_by_path(hierarchical_save_file_table_ctx_t *ctx, const char *path, save_fs_list_entry_t *entry);
+bool save_extract_filesystem(save_ctx_t *ctx, char *out_path, size_t out_path_size, u8 *buf, u64 buf_size, save_extract_stats_t *stats);
 
 bool retrieveCertData(u8 *out_cert, bool personalized);
 
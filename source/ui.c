@@ -82,6 +82,7 @@ static u32 selectedAppIndex;
 static u32 selectedPatchIndex;
 static u32 selectedAddOnIndex;
 static u32 selectedPartitionIndex;
+static bool hfs0VerifyHashes = false;
 static u32 selectedFileIndex;
 
 static nspDumpType selectedNspDumpType;
@@ -91,6 +92,8 @@ static selectedRomFsType curRomFsType = ROMFS_TYPE_APP;
 
 static selectedTicketType curTikType = TICKET_TYPE_APP;
 
+static bool verifySystemSaveHashes = false;
+
 static bool updatePerformed = false;
 
 bool highlight = false;
@@ -138,7 +141,7 @@ static const char *appControlsSdCardEmmcNoOrphan = "[ " NINTENDO_FONT_DPAD " / "
 static const char *appControlsSdCardEmmcNoApp = "[ " NINTENDO_FONT_B " ] Back | [ " NINTENDO_FONT_X " ] Batch mode | [ " NINTENDO_FONT_Y " ] Dump installed content with missing base application | [ " NINTENDO_FONT_PLUS " ] Exit";
 static const char *appControlsRomFs = "[ " NINTENDO_FONT_DPAD " / " NINTENDO_FONT_LSTICK " / " NINTENDO_FONT_RSTICK " ] Move | [ " NINTENDO_FONT_A " ] Select | [ " NINTENDO_FONT_B " ] Back | [ " NINTENDO_FONT_Y " ] Dump current directory | [ " NINTENDO_FONT_PLUS " ] Exit";
 
-static const char *mainMenuItems[] = { "Dump gamecard content", "Dump installed SD card / eMMC content", "Update options" };
+static const char *mainMenuItems[] = { "Dump gamecard content", "Dump installed SD card / eMMC content", "Dump system savedata", "Update options" };
 static const char *gameCardMenuItems[] = { "NX Card Image (XCI) dump", "Nintendo Submission Package (NSP) dump", "HFS0 options", "ExeFS options", "RomFS options", "Dump gamecard certificate" };
 static const char *xciDumpMenuItems[] = { "Start XCI dump process", "Split output dump (FAT32 support): ", "Create directory with archive bit set: ", "Keep certificate: ", "Trim output dump: ", "CRC32 checksum calculation + dump verification: ", "Dump verification method: ", "Output naming scheme: " };
 static const char *nspDumpGameCardMenuItems[] = { "Dump base application NSP", "Dump bundled update NSP", "Dump bundled DLC NSP" };
@@ -146,20 +149,21 @@ static const char *nspDumpSdCardEmmcMenuItems[] = { "Dump base application NSP",
 static const char *nspAppDumpMenuItems[] = { "Start NSP dump process", "Split output dump (FAT32 support): ", "Verify dump using No-Intro database: ", "Remove console specific data: ", "Generate ticket-less dump: ", "Change NPDM RSA key/sig in Program NCA: ", "Base application to dump: ", "Output naming scheme: " };
 static const char *nspPatchDumpMenuItems[] = { "Start NSP dump process", "Split output dump (FAT32 support): ", "Verify dump using No-Intro database: ", "Remove console specific data: ", "Generate ticket-less dump: ", "Change NPDM RSA key/sig in Program NCA: ", "Dump delta fragments: ", "Update to dump: ", "Output naming scheme: " };
 static const char *nspAddOnDumpMenuItems[] = { "Start NSP dump process", "Split output dump (FAT32 support): ", "Verify dump using No-Intro database: ", "Remove console specific data: ", "Generate ticket-less dump: ", "DLC to dump: ", "Output naming scheme: " };
-static const char *hfs0MenuItems[] = { "Raw HFS0 partition dump", "HFS0 partition data dump", "Browse HFS0 partitions" };
+static const char *hfs0MenuItems[] = { "Raw HFS0 partition dump", "HFS0 partition data dump", "Browse HFS0 partitions", "Verify HFS0 partitions" };
 static const char *hfs0PartitionDumpType1MenuItems[] = { "Dump HFS0 partition 0 (Update)", "Dump HFS0 partition 1 (Normal)", "Dump HFS0 partition 2 (Secure)" };
 static const char *hfs0PartitionDumpType2MenuItems[] = { "Dump HFS0 partition 0 (Update)", "Dump HFS0 partition 1 (Logo)", "Dump HFS0 partition 2 (Normal)", "Dump HFS0 partition 3 (Secure)" };
 static const char *hfs0BrowserType1MenuItems[] = { "Browse HFS0 partition 0 (Update)", "Browse HFS0 partition 1 (Normal)", "Browse HFS0 partition 2 (Secure)" };
 static const char *hfs0BrowserType2MenuItems[] = { "Browse HFS0 partition 0 (Update)", "Browse HFS0 partition 1 (Logo)", "Browse HFS0 partition 2 (Normal)", "Browse HFS0 partition 3 (Secure)" };
-static const char *exeFsMenuItems[] = { "ExeFS section data dump", "Browse ExeFS section", "Split files bigger than 4 GiB (FAT32 support): ", "Save data to CFW directory (LayeredFS): ", "Use update: " };
+static const char *exeFsMenuItems[] = { "ExeFS section data dump", "Browse ExeFS section", "Split files bigger than 4 GiB (FAT32 support): ", "Save data to CFW directory (LayeredFS): ", "Verify PFS0 hashes: ", "Use update: " };
 static const char *exeFsSectionDumpMenuItems[] = { "Start ExeFS data dump process", "Base application to dump: ", "Use update: " };
 static const char *exeFsSectionBrowserMenuItems[] = { "Browse ExeFS section", "Base application to browse: ", "Use update: " };
-static const char *romFsMenuItems[] = { "RomFS section data dump", "Browse RomFS section", "Split files bigger than 4 GiB (FAT32 support): ", "Save data to CFW directory (LayeredFS): ", "Use update/DLC: " };
+static const char *romFsMenuItems[] = { "RomFS section data dump", "Browse RomFS section", "Split files bigger than 4 GiB (FAT32 support): ", "Save data to CFW directory (LayeredFS): ", "Verify IVFC hashes: ", "Use update/DLC: " };
 static const char *romFsSectionDumpMenuItems[] = { "Start RomFS data dump process", "Base application to dump: ", "Use update/DLC: " };
 static const char *romFsSectionBrowserMenuItems[] = { "Browse RomFS section", "Base application to browse: ", "Use update/DLC: " };
 static const char *sdCardEmmcMenuItems[] = { "Nintendo Submission Package (NSP) dump", "ExeFS options", "RomFS options", "Ticket options" };
 static const char *batchModeMenuItems[] = { "Start batch dump process", "Dump base applications: ", "Dump updates: ", "Dump DLCs: ", "Split output dumps (FAT32 support): ", "Remove console specific data: ", "Generate ticket-less dumps: ", "Change NPDM RSA key/sig in Program NCA: ", "Dump delta fragments from updates: ", "Skip already dumped titles: ", "Remember dumped titles: ", "Halt dump process on errors: ", "Output naming scheme: ", "Source storage: " };
 static const char *ticketMenuItems[] = { "Start ticket dump", "Remove console specific data: ", "Use ticket from title: " };
+static const char *systemSaveMenuItems[] = { "Extract all system savefiles", "Extract all system savefiles (verify IVFC hashes)" };
 static const char *updateMenuItems[] = { "Update NSWDB.COM XML database", "Update application" };
 
 static const char *xciChecksumLookupMethods[] = { "NSWDB.COM XML database (offline)", "No-Intro database lookup (online)" };
@@ -257,11 +261,13 @@ void uiDrawIcon(const u8 *icon, int width, int height, int x, int y)
     }
 }
 
-bool uiLoadJpgFromMem(u8 *rawJpg, size_t rawJpgSize, int expectedWidth, int expectedHeight, int desiredWidth, int desiredHeight, u8 **outBuf)
+bool uiDecodeJpgFromMem(u8 *rawJpg, size_t rawJpgSize, int expectedWidth, int expectedHeight, int desiredWidth, int desiredHeight, u8 **outBuf, char *errBuf, size_t errBufSize)
 {
+    if (!errBuf || !errBufSize) return false;
+    
     if (!rawJpg || !rawJpgSize || !expectedWidth || !expectedHeight || !desiredWidth || !desiredHeight || !outBuf)
     {
-        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: invalid parameters to process JPG image buffer!", __func__);
+        snprintf(errBuf, errBufSize, "%s: invalid parameters to process JPG image buffer!", __func__);
         return false;
     }
     
@@ -278,27 +284,27 @@ bool uiLoadJpgFromMem(u8 *rawJpg, size_t rawJpgSize, int expectedWidth, int expe
     _jpegDecompressor = tjInitDecompress();
     if (!_jpegDecompressor)
     {
-        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: tjInitDecompress failed!", __func__);
+        snprintf(errBuf, errBufSize, "%s: tjInitDecompress failed!", __func__);
         return success;
     }
     
     ret = tjDecompressHeader2(_jpegDecompressor, rawJpg, rawJpgSize, &w, &h, &samp);
     if (ret == -1)
     {
-        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: tjDecompressHeader2 failed! (%d)", __func__, ret);
+        snprintf(errBuf, errBufSize, "%s: tjDecompressHeader2 failed! (%d)", __func__, ret);
         goto out;
     }
     
     if (w != expectedWidth || h != expectedHeight)
     {
-        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: invalid image width/height!", __func__);
+        snprintf(errBuf, errBufSize, "%s: invalid image width/height!", __func__);
         goto out;
     }
     
     scalingFactors = tjGetScalingFactors(&numScalingFactors);
     if (!scalingFactors)
     {
-        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: unable to retrieve scaling factors!", __func__);
+        snprintf(errBuf, errBufSize, "%s: unable to retrieve scaling factors!", __func__);
         goto out;
     }
     
@@ -313,7 +319,7 @@ bool uiLoadJpgFromMem(u8 *rawJpg, size_t rawJpgSize, int expectedWidth, int expe
     
     if (!foundScalingFactor)
     {
-        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: unable to find a valid scaling factor!", __func__);
+        snprintf(errBuf, errBufSize, "%s: unable to find a valid scaling factor!", __func__);
         goto out;
     }
     
@@ -322,7 +328,7 @@ bool uiLoadJpgFromMem(u8 *rawJpg, size_t rawJpgSize, int expectedWidth, int expe
     jpgScaledBuf = malloc(pitch * desiredHeight);
     if (!jpgScaledBuf)
     {
-        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: unable to allocate memory for the scaled RGB image output!", __func__);
+        snprintf(errBuf, errBufSize, "%s: unable to allocate memory for the scaled RGB image output!", __func__);
         goto out;
     }
     
@@ -330,7 +336,7 @@ bool uiLoadJpgFromMem(u8 *rawJpg, size_t rawJpgSize, int expectedWidth, int expe
     if (ret == -1)
     {
         free(jpgScaledBuf);
-        snprintf(strbuf, MAX_CHARACTERS(strbuf), "%s: tjDecompress2 failed! (%d)", __func__, ret);
+        snprintf(errBuf, errBufSize, "%s: tjDecompress2 failed! (%d)", __func__, ret);
         goto out;
     }
     
@@ -343,6 +349,11 @@ out:
     return success;
 }
 
+bool uiLoadJpgFromMem(u8 *rawJpg, size_t rawJpgSize, int expectedWidth, int expectedHeight, int desiredWidth, int desiredHeight, u8 **outBuf)
+{
+    return uiDecodeJpgFromMem(rawJpg, rawJpgSize, expectedWidth, expectedHeight, desiredWidth, desiredHeight, outBuf, strbuf, MAX_CHARACTERS(strbuf));
+}
+
 bool uiLoadJpgFromFile(const char *filename, int expectedWidth, int expectedHeight, int desiredWidth, int desiredHeight, u8 **outBuf)
 {
     if (!filename || !desiredWidth || !desiredHeight || !outBuf)
@@ -992,7 +1003,7 @@ UIResult uiProcess()
     uiPrintHeadline();
     loadTitleInfo();
     
-    if (uiState == stateMainMenu || uiState == stateGameCardMenu || uiState == stateXciDumpMenu || uiState == stateNspDumpMenu || uiState == stateNspAppDumpMenu || uiState == stateNspPatchDumpMenu || uiState == stateNspAddOnDumpMenu || uiState == stateHfs0Menu || uiState == stateRawHfs0PartitionDumpMenu || uiState == stateHfs0PartitionDataDumpMenu || uiState == stateHfs0BrowserMenu || uiState == stateHfs0Browser || uiState == stateExeFsMenu || uiState == stateExeFsSectionDataDumpMenu || uiState == stateExeFsSectionBrowserMenu || uiState == stateExeFsSectionBrowser || uiState == stateRomFsMenu || uiState == stateRomFsSectionDataDumpMenu || uiState == stateRomFsSectionBrowserMenu || uiState == stateRomFsSectionBrowser || uiState == stateSdCardEmmcMenu || uiState == stateSdCardEmmcTitleMenu || uiState == stateSdCardEmmcOrphanPatchAddOnMenu || uiState == stateSdCardEmmcBatchModeMenu || uiState == stateTicketMenu || uiState == stateUpdateMenu)
+    if (uiState == stateMainMenu || uiState == stateGameCardMenu || uiState == stateXciDumpMenu || uiState == stateNspDumpMenu || uiState == stateNspAppDumpMenu || uiState == stateNspPatchDumpMenu || uiState == stateNspAddOnDumpMenu || uiState == stateHfs0Menu || uiState == stateRawHfs0PartitionDumpMenu || uiState == stateHfs0PartitionDataDumpMenu || uiState == stateHfs0BrowserMenu || uiState == stateHfs0Browser || uiState == stateExeFsMenu || uiState == stateExeFsSectionDataDumpMenu || uiState == stateExeFsSectionBrowserMenu || uiState == stateExeFsSectionBrowser || uiState == stateRomFsMenu || uiState == stateRomFsSectionDataDumpMenu || uiState == stateRomFsSectionBrowserMenu || uiState == stateRomFsSectionBrowser || uiState == stateSdCardEmmcMenu || uiState == stateSdCardEmmcTitleMenu || uiState == stateSdCardEmmcOrphanPatchAddOnMenu || uiState == stateSdCardEmmcBatchModeMenu || uiState == stateTicketMenu || uiState == stateSystemSaveMenu || uiState == stateUpdateMenu)
     {
         switch(menuType)
         {
@@ -1196,7 +1207,7 @@ UIResult uiProcess()
         }
     }
     
-    if (uiState == stateMainMenu || uiState == stateGameCardMenu || uiState == stateXciDumpMenu || uiState == stateNspDumpMenu || uiState == stateNspAppDumpMenu || uiState == stateNspPatchDumpMenu || uiState == stateNspAddOnDumpMenu || uiState == stateHfs0Menu || uiState == stateRawHfs0PartitionDumpMenu || uiState == stateHfs0PartitionDataDumpMenu || uiState == stateHfs0BrowserMenu || uiState == stateHfs0Browser || uiState == stateExeFsMenu || uiState == stateExeFsSectionDataDumpMenu || uiState == stateExeFsSectionBrowserMenu || uiState == stateExeFsSectionBrowser || uiState == stateRomFsMenu || uiState == stateRomFsSectionDataDumpMenu || uiState == stateRomFsSectionBrowserMenu || uiState == stateRomFsSectionBrowser || uiState == stateSdCardEmmcMenu || uiState == stateSdCardEmmcTitleMenu || uiState == stateSdCardEmmcOrphanPatchAddOnMenu || uiState == stateSdCardEmmcBatchModeMenu || uiState == stateTicketMenu || uiState == stateUpdateMenu)
+    if (uiState == stateMainMenu || uiState == stateGameCardMenu || uiState == stateXciDumpMenu || uiState == stateNspDumpMenu || uiState == stateNspAppDumpMenu || uiState == stateNspPatchDumpMenu || uiState == stateNspAddOnDumpMenu || uiState == stateHfs0Menu || uiState == stateRawHfs0PartitionDumpMenu || uiState == stateHfs0PartitionDataDumpMenu || uiState == stateHfs0BrowserMenu || uiState == stateHfs0Browser || uiState == stateExeFsMenu || uiState == stateExeFsSectionDataDumpMenu || uiState == stateExeFsSectionBrowserMenu || uiState == stateExeFsSectionBrowser || uiState == stateRomFsMenu || uiState == stateRomFsSectionDataDumpMenu || uiState == stateRomFsSectionBrowserMenu || uiState == stateRomFsSectionBrowser || uiState == stateSdCardEmmcMenu || uiState == stateSdCardEmmcTitleMenu || uiState == stateSdCardEmmcOrphanPatchAddOnMenu || uiState == stateSdCardEmmcBatchModeMenu || uiState == stateTicketMenu || uiState == stateSystemSaveMenu || uiState == stateUpdateMenu)
     {
         if ((menuType == MENUTYPE_GAMECARD && uiState != stateHfs0Browser && uiState != stateExeFsSectionBrowser && uiState != stateRomFsSectionBrowser) || (menuType == MENUTYPE_SDCARD_EMMC && !orphanMode && uiState != stateSdCardEmmcMenu && uiState != stateSdCardEmmcBatchModeMenu && uiState != stateExeFsSectionBrowser && uiState != stateRomFsSectionBrowser))
         {
@@ -1205,10 +1216,18 @@ UIResult uiProcess()
             ypos = STRING_Y_POS(breaks);
             startYPos = ypos;
             
-            /* Draw icon */
-            if (baseAppEntries[selectedAppInfoIndex].icon != NULL)
+            /* Draw icon, or a placeholder until it has been decoded */
+            if (baseAppEntries && selectedAppInfoIndex < titleAppCount)
             {
-                uiDrawIcon(baseAppEntries[selectedAppInfoIndex].icon, NACP_ICON_DOWNSCALED, NACP_ICON_DOWNSCALED, xpos, ypos);
+                u8 *icon = getBaseApplicationIcon(selectedAppInfoIndex);
+                
+                if (icon != NULL)
+                {
+                    uiDrawIcon(icon, NACP_ICON_DOWNSCALED, NACP_ICON_DOWNSCALED, xpos, ypos);
+                } else {
+                    uiFill(xpos, ypos, NACP_ICON_DOWNSCALED, NACP_ICON_DOWNSCALED, ICON_PLACEHOLDER_COLOR_RGB);
+                }
+                
                 xpos += (NACP_ICON_DOWNSCALED + 8);
                 ypos += 8;
             }
@@ -1819,12 +1838,19 @@ UIResult uiProcess()
                 
                 uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_TITLE_RGB, sdCardEmmcMenuItems[3]);
                 
+                break;
+            case stateSystemSaveMenu:
+                menu = systemSaveMenuItems;
+                menuItemsCount = MAX_ELEMENTS(systemSaveMenuItems);
+                
+                uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_TITLE_RGB, mainMenuItems[2]);
+                
                 break;
             case stateUpdateMenu:
                 menu = updateMenuItems;
                 menuItemsCount = MAX_ELEMENTS(updateMenuItems);
                 
-                uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_TITLE_RGB, mainMenuItems[2]);
+                uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_TITLE_RGB, mainMenuItems[3]);
                 
                 break;
             default:
@@ -1842,6 +1868,19 @@ UIResult uiProcess()
             j = 0;
             highlight = false;
             
+            // Queue icons for the rows right outside the visible ones, so they're ready when scrolling
+            // Visible rows are requested afterwards while drawing, which gives them priority
+            if (uiState == stateSdCardEmmcMenu)
+            {
+                int firstRow = (scroll > ICON_LOOKAHEAD_ROWS ? (scroll - ICON_LOOKAHEAD_ROWS) : 0);
+                int lastRow = (scroll + maxElements + ICON_LOOKAHEAD_ROWS);
+                
+                for(i = firstRow; i < menuItemsCount && i < lastRow; i++)
+                {
+                    if (i < scroll || i >= (scroll + maxElements)) getBaseApplicationIcon(i);
+                }
+            }
+            
             for(i = scroll; i < menuItemsCount; i++, j++)
             {
                 if (j >= maxElements) break;
@@ -1921,7 +1960,7 @@ UIResult uiProcess()
                 
                 // Avoid printing the "Use update" option in the ExeFS menu if we're dealing with a gamecard and either its base application count is greater than 1 or it has no available patches
                 // Also avoid printing it if we're dealing with a SD/eMMC title and it has no available patches, or if we're dealing with an orphan Patch
-                if (uiState == stateExeFsMenu && i == 4 && ((menuType == MENUTYPE_GAMECARD && (titleAppCount > 1 || !checkIfBaseApplicationHasPatchOrAddOn(0, false))) || (menuType == MENUTYPE_SDCARD_EMMC && ((!orphanMode && !checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, false)) || orphanMode))))
+                if (uiState == stateExeFsMenu && i == 5 && ((menuType == MENUTYPE_GAMECARD && (titleAppCount > 1 || !checkIfBaseApplicationHasPatchOrAddOn(0, false))) || (menuType == MENUTYPE_SDCARD_EMMC && ((!orphanMode && !checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, false)) || orphanMode))))
                 {
                     j--;
                     continue;
@@ -1936,7 +1975,7 @@ UIResult uiProcess()
                 
                 // Avoid printing the "Use update/DLC" option in the RomFS menu if we're dealing with a gamecard and either its base application count is greater than 1 or it has no available patches/DLCs
                 // Also avoid printing it if we're dealing with a SD/eMMC title and it has no available patches/DLCs (or if its an orphan title)
-                if (uiState == stateRomFsMenu && i == 4 && ((menuType == MENUTYPE_GAMECARD && (titleAppCount > 1 || (!checkIfBaseApplicationHasPatchOrAddOn(0, false) && !checkIfBaseApplicationHasPatchOrAddOn(0, true)))) || (menuType == MENUTYPE_SDCARD_EMMC && (orphanMode || (!checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, false) && !checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, true))))))
+                if (uiState == stateRomFsMenu && i == 5 && ((menuType == MENUTYPE_GAMECARD && (titleAppCount > 1 || (!checkIfBaseApplicationHasPatchOrAddOn(0, false) && !checkIfBaseApplicationHasPatchOrAddOn(0, true)))) || (menuType == MENUTYPE_SDCARD_EMMC && (orphanMode || (!checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, false) && !checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, true))))))
                 {
                     j--;
                     continue;
@@ -1975,13 +2014,17 @@ UIResult uiProcess()
                 
                 if (uiState == stateSdCardEmmcMenu)
                 {
-                    if (baseAppEntries[i].icon != NULL)
+                    u8 *icon = getBaseApplicationIcon(i);
+                    
+                    if (icon != NULL)
                     {
-                        uiDrawIcon(baseAppEntries[i].icon, NACP_ICON_DOWNSCALED, NACP_ICON_DOWNSCALED, xpos, ypos);
-                        
-                        xpos += (NACP_ICON_DOWNSCALED + 8);
+                        uiDrawIcon(icon, NACP_ICON_DOWNSCALED, NACP_ICON_DOWNSCALED, xpos, ypos);
+                    } else {
+                        uiFill(xpos, ypos, NACP_ICON_DOWNSCALED, NACP_ICON_DOWNSCALED, ICON_PLACEHOLDER_COLOR_RGB);
                     }
                     
+                    xpos += (NACP_ICON_DOWNSCALED + 8);
+                    
                     ypos += ((NACP_ICON_DOWNSCALED / 2) - (font_height / 2));
                 } else
                 if (uiState == stateHfs0Browser || uiState == stateExeFsSectionBrowser || uiState == stateRomFsSectionBrowser)
@@ -2259,7 +2302,10 @@ UIResult uiProcess()
                         case 3: // Save data to CFW directory (LayeredFS)
                             uiPrintOption(xpos, ypos, OPTIONS_X_END_POS, dumpCfg.exeFsDumpCfg.useLayeredFSDir, !dumpCfg.exeFsDumpCfg.useLayeredFSDir, (dumpCfg.exeFsDumpCfg.useLayeredFSDir ? 0 : 255), (dumpCfg.exeFsDumpCfg.useLayeredFSDir ? 255 : 0), 0, (dumpCfg.exeFsDumpCfg.useLayeredFSDir ? "Yes" : "No"));
                             break;
-                        case 4: // Use update
+                        case 4: // Verify PFS0 hashes
+                            uiPrintOption(xpos, ypos, OPTIONS_X_END_POS, dumpCfg.exeFsDumpCfg.verifyHashes, !dumpCfg.exeFsDumpCfg.verifyHashes, (dumpCfg.exeFsDumpCfg.verifyHashes ? 0 : 255), (dumpCfg.exeFsDumpCfg.verifyHashes ? 255 : 0), 0, (dumpCfg.exeFsDumpCfg.verifyHashes ? "Yes" : "No"));
+                            break;
+                        case 5: // Use update
                             if (exeFsUpdateFlag)
                             {
                                 if (!strlen(exeFsAndRomFsSelectorStr))
@@ -2355,7 +2401,10 @@ UIResult uiProcess()
                         case 3: // Save data to CFW directory (LayeredFS)
                             uiPrintOption(xpos, ypos, OPTIONS_X_END_POS, dumpCfg.romFsDumpCfg.useLayeredFSDir, !dumpCfg.romFsDumpCfg.useLayeredFSDir, (dumpCfg.romFsDumpCfg.useLayeredFSDir ? 0 : 255), (dumpCfg.romFsDumpCfg.useLayeredFSDir ? 255 : 0), 0, (dumpCfg.romFsDumpCfg.useLayeredFSDir ? "Yes" : "No"));
                             break;
-                        case 4: // Use update/DLC
+                        case 4: // Verify IVFC hashes
+                            uiPrintOption(xpos, ypos, OPTIONS_X_END_POS, dumpCfg.romFsDumpCfg.verifyHashes, !dumpCfg.romFsDumpCfg.verifyHashes, (dumpCfg.romFsDumpCfg.verifyHashes ? 0 : 255), (dumpCfg.romFsDumpCfg.verifyHashes ? 255 : 0), 0, (dumpCfg.romFsDumpCfg.verifyHashes ? "Yes" : "No"));
+                            break;
+                        case 5: // Use update/DLC
                             if (curRomFsType != ROMFS_TYPE_APP)
                             {
                                 if (!strlen(exeFsAndRomFsSelectorStr))
@@ -2590,8 +2639,32 @@ UIResult uiProcess()
                 uiDrawString(STRING_X_POS, ypos, FONT_COLOR_RGB, "Enabling this option will save output data to \"%s[TitleID]/%s/\" (LayeredFS directory structure).", strchr(cfwDirStr, '/'), (uiState == stateExeFsMenu ? "exefs" : "romfs"));
             }
             
+            // Print information about the "Verify PFS0 hashes" option
+            if (uiState == stateExeFsMenu && cursor == 4)
+            {
+                uiDrawString(STRING_X_POS, ypos, FONT_COLOR_RGB, "Verifies extracted ExeFS data against the PFS0 hash table from the Program NCA. Files with mismatching blocks are still written, but reported.");
+            }
+            
+            // Print information about the "Verify IVFC hashes" option
+            if (uiState == stateRomFsMenu && cursor == 4)
+            {
+                uiDrawString(STRING_X_POS, ypos, FONT_COLOR_RGB, "Verifies extracted RomFS data against its IVFC hash tree. Files with mismatching blocks are still written, but reported.");
+            }
+            
+            // Print hint about verifying HFS0 hashed regions while dumping
+            if (uiState == stateRawHfs0PartitionDumpMenu || uiState == stateHfs0PartitionDataDumpMenu)
+            {
+                uiDrawString(STRING_X_POS, ypos, FONT_COLOR_RGB, "Press " NINTENDO_FONT_Y " to dump the selected partition while verifying the hashed region of every file in it.");
+            }
+            
+            // Print hint about verifying RomFS section data without extracting it
+            if ((uiState == stateRomFsMenu || uiState == stateRomFsSectionDataDumpMenu) && cursor == 0)
+            {
+                uiDrawString(STRING_X_POS, ypos, FONT_COLOR_RGB, "Press " NINTENDO_FONT_Y " to verify the whole RomFS section against its IVFC hash tree without extracting it.");
+            }
+            
             // Print hint about dumping RomFS content from DLCs
-            if ((uiState == stateRomFsMenu && cursor == 4 && ((menuType == MENUTYPE_GAMECARD && titleAppCount <= 1 && checkIfBaseApplicationHasPatchOrAddOn(0, true)) || (menuType == MENUTYPE_SDCARD_EMMC && !orphanMode && checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, true)))) || ((uiState == stateRomFsSectionDataDumpMenu || uiState == stateRomFsSectionBrowserMenu) && cursor == 2 && (menuType == MENUTYPE_GAMECARD && titleAppCount > 1 && checkIfBaseApplicationHasPatchOrAddOn(selectedAppIndex, true))))
+            if ((uiState == stateRomFsMenu && cursor == 5 && ((menuType == MENUTYPE_GAMECARD && titleAppCount <= 1 && checkIfBaseApplicationHasPatchOrAddOn(0, true)) || (menuType == MENUTYPE_SDCARD_EMMC && !orphanMode && checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, true)))) || ((uiState == stateRomFsSectionDataDumpMenu || uiState == stateRomFsSectionBrowserMenu) && cursor == 2 && (menuType == MENUTYPE_GAMECARD && titleAppCount > 1 && checkIfBaseApplicationHasPatchOrAddOn(selectedAppIndex, true))))
             {
                 uiDrawString(STRING_X_POS, ypos, FONT_COLOR_RGB, "Hint: choosing a DLC will only access RomFS data from it, unlike updates (which share their RomFS data with its base application).");
             }
@@ -2621,6 +2694,9 @@ UIResult uiProcess()
             keysHeld = getButtonsHeld();
             
             if (keysDown || keysHeld || (menuType == MENUTYPE_GAMECARD && gameCardInfo.isInserted != curGcStatus)) break;
+            
+            // Redraw the menu once the icon worker threads are done with any of the requested icons
+            if (checkIfBaseApplicationIconsUpdated()) break;
         }
         
         // Exit
@@ -3218,7 +3294,10 @@ UIResult uiProcess()
                         case 3: // Save data to CFW directory (LayeredFS)
                             dumpCfg.exeFsDumpCfg.useLayeredFSDir = false;
                             break;
-                        case 4: // Use update
+                        case 4: // Verify PFS0 hashes
+                            dumpCfg.exeFsDumpCfg.verifyHashes = false;
+                            break;
+                        case 5: // Use update
                             if ((menuType == MENUTYPE_GAMECARD && titleAppCount == 1 && checkIfBaseApplicationHasPatchOrAddOn(0, false)) || (menuType == MENUTYPE_SDCARD_EMMC && checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, false)))
                             {
                                 if (exeFsUpdateFlag)
@@ -3252,7 +3331,10 @@ UIResult uiProcess()
                         case 3: // Save data to CFW directory (LayeredFS)
                             dumpCfg.exeFsDumpCfg.useLayeredFSDir = true;
                             break;
-                        case 4: // Use update
+                        case 4: // Verify PFS0 hashes
+                            dumpCfg.exeFsDumpCfg.verifyHashes = true;
+                            break;
+                        case 5: // Use update
                             if ((menuType == MENUTYPE_GAMECARD && titleAppCount == 1 && checkIfBaseApplicationHasPatchOrAddOn(0, false)) || (menuType == MENUTYPE_SDCARD_EMMC && checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, false)))
                             {
                                 u32 appIndex = (menuType == MENUTYPE_GAMECARD ? 0 : selectedAppInfoIndex);
@@ -3410,6 +3492,13 @@ UIResult uiProcess()
                     }
                 }
                 
+                // Verify RomFS section
+                if ((keysDown & HidNpadButton_Y) && cursor == 0)
+                {
+                    if (!orphanMode) selectedAppIndex = (menuType == MENUTYPE_GAMECARD ? 0 : selectedAppInfoIndex);
+                    res = ((menuType == MENUTYPE_GAMECARD && titleAppCount > 1) ? resultShowRomFsSectionDataDumpMenu : resultVerifyRomFsSectionData);
+                }
+                
                 // Back
                 if (keysDown & HidNpadButton_B)
                 {
@@ -3434,7 +3523,10 @@ UIResult uiProcess()
                         case 3: // Save data to CFW directory (LayeredFS)
                             dumpCfg.romFsDumpCfg.useLayeredFSDir = false;
                             break;
-                        case 4: // Use update/DLC
+                        case 4: // Verify IVFC hashes
+                            dumpCfg.romFsDumpCfg.verifyHashes = false;
+                            break;
+                        case 5: // Use update/DLC
                             if ((menuType == MENUTYPE_GAMECARD && titleAppCount == 1 && (checkIfBaseApplicationHasPatchOrAddOn(0, false) || checkIfBaseApplicationHasPatchOrAddOn(0, true))) || (menuType == MENUTYPE_SDCARD_EMMC && !orphanMode && (checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, false) || checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, true))))
                             {
                                 if (curRomFsType != ROMFS_TYPE_APP)
@@ -3487,7 +3579,10 @@ UIResult uiProcess()
                         case 3: // Save data to CFW directory (LayeredFS)
                             dumpCfg.romFsDumpCfg.useLayeredFSDir = true;
                             break;
-                        case 4: // Use update/DLC
+                        case 4: // Verify IVFC hashes
+                            dumpCfg.romFsDumpCfg.verifyHashes = true;
+                            break;
+                        case 5: // Use update/DLC
                             if ((menuType == MENUTYPE_GAMECARD && titleAppCount == 1 && (checkIfBaseApplicationHasPatchOrAddOn(0, false) || checkIfBaseApplicationHasPatchOrAddOn(0, true))) || (menuType == MENUTYPE_SDCARD_EMMC && !orphanMode && (checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, false) || checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, true))))
                             {
                                 u32 appIndex = (menuType == MENUTYPE_GAMECARD ? 0 : selectedAppInfoIndex);
@@ -3556,6 +3651,9 @@ UIResult uiProcess()
                 // Select
                 if ((keysDown & HidNpadButton_A) && cursor == 0) res = (uiState == stateRomFsSectionDataDumpMenu ? resultDumpRomFsSectionData : resultRomFsSectionBrowserGetEntries);
                 
+                // Verify RomFS section
+                if ((keysDown & HidNpadButton_Y) && cursor == 0 && uiState == stateRomFsSectionDataDumpMenu) res = resultVerifyRomFsSectionData;
+                
                 // Back
                 if (keysDown & HidNpadButton_B) res = resultShowRomFsMenu;
                 
@@ -3847,6 +3945,9 @@ UIResult uiProcess()
                                 }
                                 break;
                             case 2:
+                                res = resultShowSystemSaveMenu;
+                                break;
+                            case 3:
                                 res = resultShowUpdateMenu;
                                 break;
                             default:
@@ -3953,6 +4054,9 @@ UIResult uiProcess()
                             case 2:
                                 res = resultShowHfs0BrowserMenu;
                                 break;
+                            case 3:
+                                res = resultVerifyGameCardHfs0Partitions;
+                                break;
                             default:
                                 break;
                         }
@@ -3961,12 +4065,14 @@ UIResult uiProcess()
                     {
                         // Save selected partition index
                         selectedPartitionIndex = (u32)cursor;
+                        hfs0VerifyHashes = false;
                         res = resultDumpRawHfs0Partition;
                     } else
                     if (uiState == stateHfs0PartitionDataDumpMenu)
                     {
                         // Save selected partition index
                         selectedPartitionIndex = (u32)cursor;
+                        hfs0VerifyHashes = false;
                         res = resultDumpHfs0PartitionData;
                     } else
                     if (uiState == stateHfs0BrowserMenu)
@@ -4086,6 +4192,11 @@ UIResult uiProcess()
                             res = resultShowSdCardEmmcTitleMenu;
                         }
                     } else
+                    if (uiState == stateSystemSaveMenu)
+                    {
+                        verifySystemSaveHashes = (cursor == 1);
+                        res = resultDumpSystemSave;
+                    } else
                     if (uiState == stateUpdateMenu)
                     {
                         switch(cursor)
@@ -4110,7 +4221,7 @@ UIResult uiProcess()
                 // Back
                 if (keysDown & HidNpadButton_B)
                 {
-                    if (uiState == stateGameCardMenu || uiState == stateSdCardEmmcMenu || uiState == stateUpdateMenu)
+                    if (uiState == stateGameCardMenu || uiState == stateSdCardEmmcMenu || uiState == stateSystemSaveMenu || uiState == stateUpdateMenu)
                     {
                         res = resultShowMainMenu;
                         menuType = MENUTYPE_MAIN;
@@ -4183,6 +4294,13 @@ UIResult uiProcess()
                     {
                         // RomFS section browser: dump current directory
                         res = resultRomFsSectionBrowserCopyDir;
+                    } else
+                    if (uiState == stateRawHfs0PartitionDumpMenu || uiState == stateHfs0PartitionDataDumpMenu)
+                    {
+                        // HFS0 partition dump menus: dump the selected partition while verifying its hashed regions
+                        selectedPartitionIndex = (u32)cursor;
+                        hfs0VerifyHashes = true;
+                        res = (uiState == stateRawHfs0PartitionDumpMenu ? resultDumpRawHfs0Partition : resultDumpHfs0PartitionData);
                     }
                 }
                 
@@ -4491,15 +4609,15 @@ UIResult uiProcess()
                 
                 // Avoid placing the cursor on the "Use update" option in the ExeFS menu if we're dealing with a gamecard and either its base application count is greater than 1 or it has no available patches
                 // Also avoid placing the cursor on it if we're dealing with a SD/eMMC title and it has no available patches, or if we're dealing with an orphan Patch
-                if (uiState == stateExeFsMenu && cursor == 4 && ((menuType == MENUTYPE_GAMECARD && (titleAppCount > 1 || !checkIfBaseApplicationHasPatchOrAddOn(0, false))) || (menuType == MENUTYPE_SDCARD_EMMC && ((!orphanMode && !checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, false)) || orphanMode))))
+                if (uiState == stateExeFsMenu && cursor == 5 && ((menuType == MENUTYPE_GAMECARD && (titleAppCount > 1 || !checkIfBaseApplicationHasPatchOrAddOn(0, false))) || (menuType == MENUTYPE_SDCARD_EMMC && ((!orphanMode && !checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, false)) || orphanMode))))
                 {
                     if (scrollAmount > 0)
                     {
-                        cursor = (scrollWithKeysDown ? 0 : 1);
+                        cursor = (scrollWithKeysDown ? 0 : 4);
                     } else
                     if (scrollAmount < 0)
                     {
-                        cursor = (scrollWithKeysDown ? 1 : 0);
+                        cursor = (scrollWithKeysDown ? 4 : 0);
                     }
                 }
                 
@@ -4518,15 +4636,15 @@ UIResult uiProcess()
                 
                 // Avoid placing the cursor on the "Use update/DLC" option in the RomFS menu if we're dealing with a gamecard and either its base application count is greater than 1 or it has no available patches/DLCs
                 // Also avoid placing the cursor on it if we're dealing with a SD/eMMC title and it has no available patches/DLCs (or if its an orphan title)
-                if (uiState == stateRomFsMenu && cursor == 4 && ((menuType == MENUTYPE_GAMECARD && (titleAppCount > 1 || (!checkIfBaseApplicationHasPatchOrAddOn(0, false) && !checkIfBaseApplicationHasPatchOrAddOn(0, true)))) || (menuType == MENUTYPE_SDCARD_EMMC && (orphanMode || (!checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, false) && !checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, true))))))
+                if (uiState == stateRomFsMenu && cursor == 5 && ((menuType == MENUTYPE_GAMECARD && (titleAppCount > 1 || (!checkIfBaseApplicationHasPatchOrAddOn(0, false) && !checkIfBaseApplicationHasPatchOrAddOn(0, true)))) || (menuType == MENUTYPE_SDCARD_EMMC && (orphanMode || (!checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, false) && !checkIfBaseApplicationHasPatchOrAddOn(selectedAppInfoIndex, true))))))
                 {
                     if (scrollAmount > 0)
                     {
-                        cursor = (scrollWithKeysDown ? 0 : 1);
+                        cursor = (scrollWithKeysDown ? 0 : 4);
                     } else
                     if (scrollAmount < 0)
                     {
-                        cursor = (scrollWithKeysDown ? 1 : 0);
+                        cursor = (scrollWithKeysDown ? 4 : 0);
                     }
                 }
                 
@@ -4803,7 +4921,7 @@ UIResult uiProcess()
         
         uiRefreshDisplay();
         
-        dumpRawHfs0Partition(selectedPartitionIndex, true);
+        dumpRawHfs0Partition(selectedPartitionIndex, true, hfs0VerifyHashes);
         
         waitForButtonPress();
         
@@ -4817,13 +4935,26 @@ UIResult uiProcess()
         
         uiRefreshDisplay();
         
-        dumpHfs0PartitionData(selectedPartitionIndex, true);
+        dumpHfs0PartitionData(selectedPartitionIndex, true, hfs0VerifyHashes);
         
         waitForButtonPress();
         
         updateFreeSpace();
         res = resultShowHfs0PartitionDataDumpMenu;
     } else
+    if (uiState == stateVerifyGameCardHfs0Partitions)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_TITLE_RGB, hfs0MenuItems[3]);
+        breaks += 2;
+        
+        uiRefreshDisplay();
+        
+        verifyGameCardHfs0Partitions();
+        
+        waitForButtonPress();
+        
+        res = resultShowHfs0Menu;
+    } else
     if (uiState == stateHfs0BrowserGetList)
     {
         uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_TITLE_RGB, (gameCardInfo.hfs0PartitionCnt == GAMECARD_TYPE1_PARTITION_CNT ? hfs0BrowserType1MenuItems[selectedPartitionIndex] : hfs0BrowserType2MenuItems[selectedPartitionIndex]));
@@ -4999,6 +5130,42 @@ UIResult uiProcess()
         
         res = ((menuType == MENUTYPE_GAMECARD && titleAppCount > 1) ? resultShowRomFsSectionDataDumpMenu : resultShowRomFsMenu);
     } else
+    if (uiState == stateVerifyRomFsSectionData)
+    {
+        u32 curIndex = 0;
+        
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_TITLE_RGB, "RomFS section verification");
+        breaks++;
+        
+        switch(curRomFsType)
+        {
+            case ROMFS_TYPE_APP:
+                snprintf(strbuf, MAX_CHARACTERS(strbuf), "Bundled application to verify: %s v%s", baseAppEntries[selectedAppIndex].name, baseAppEntries[selectedAppIndex].versionStr);
+                curIndex = selectedAppIndex;
+                break;
+            case ROMFS_TYPE_PATCH:
+                retrieveDescriptionForPatchOrAddOn(selectedPatchIndex, false, true, "Update to verify: ", strbuf, MAX_CHARACTERS(strbuf));
+                curIndex = selectedPatchIndex;
+                break;
+            case ROMFS_TYPE_ADDON:
+                retrieveDescriptionForPatchOrAddOn(selectedAddOnIndex, true, true, "DLC to verify: ", strbuf, MAX_CHARACTERS(strbuf));
+                curIndex = selectedAddOnIndex;
+                break;
+            default:
+                break;
+        }
+        
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_TITLE_RGB, strbuf);
+        breaks += 2;
+        
+        uiRefreshDisplay();
+        
+        verifyRomFsSectionData(curIndex, curRomFsType);
+        
+        waitForButtonPress();
+        
+        res = ((menuType == MENUTYPE_GAMECARD && titleAppCount > 1) ? resultShowRomFsSectionDataDumpMenu : resultShowRomFsMenu);
+    } else
     if (uiState == stateRomFsSectionBrowserGetEntries)
     {
         u32 curIndex = 0;
@@ -5248,6 +5415,18 @@ UIResult uiProcess()
         updateFreeSpace();
         res = resultShowTicketMenu;
     } else
+    if (uiState == stateDumpSystemSave)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_TITLE_RGB, systemSaveMenuItems[verifySystemSaveHashes ? 1 : 0]);
+        breaks += 2;
+        
+        dumpSystemSaveData(verifySystemSaveHashes);
+        
+        waitForButtonPress();
+        
+        updateFreeSpace();
+        res = resultShowSystemSaveMenu;
+    } else
     if (uiState == stateUpdateNSWDBXml)
     {
         uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_TITLE_RGB, updateMenuItems[0]);
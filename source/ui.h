@@ -29,6 +29,8 @@
 
 #define EMPTY_BAR_COLOR_RGB         0, 0, 0
 
+#define ICON_PLACEHOLDER_COLOR_RGB  80, 80, 80
+
 #define COMMON_MAX_ELEMENTS         9
 #define HFS0_MAX_ELEMENTS           14
 #define ROMFS_MAX_ELEMENTS          12
@@ -79,6 +81,7 @@ typedef enum {
     resultDumpRawHfs0Partition,
     resultShowHfs0PartitionDataDumpMenu,
     resultDumpHfs0PartitionData,
+    resultVerifyGameCardHfs0Partitions,
     resultShowHfs0BrowserMenu,
     resultHfs0BrowserGetList,
     resultShowHfs0Browser,
@@ -93,6 +96,7 @@ typedef enum {
     resultShowRomFsMenu,
     resultShowRomFsSectionDataDumpMenu,
     resultDumpRomFsSectionData,
+    resultVerifyRomFsSectionData,
     resultShowRomFsSectionBrowserMenu,
     resultRomFsSectionBrowserGetEntries,
     resultShowRomFsSectionBrowser,
@@ -107,6 +111,8 @@ typedef enum {
     resultSdCardEmmcBatchDump,
     resultShowTicketMenu,
     resultDumpTicket,
+    resultShowSystemSaveMenu,
+    resultDumpSystemSave,
     resultShowUpdateMenu,
     resultUpdateNSWDBXml,
     resultUpdateApplication,
@@ -128,6 +134,7 @@ typedef enum {
     stateDumpRawHfs0Partition,
     stateHfs0PartitionDataDumpMenu,
     stateDumpHfs0PartitionData,
+    stateVerifyGameCardHfs0Partitions,
     stateHfs0BrowserMenu,
     stateHfs0BrowserGetList,
     stateHfs0Browser,
@@ -142,6 +149,7 @@ typedef enum {
     stateRomFsMenu,
     stateRomFsSectionDataDumpMenu,
     stateDumpRomFsSectionData,
+    stateVerifyRomFsSectionData,
     stateRomFsSectionBrowserMenu,
     stateRomFsSectionBrowserGetEntries,
     stateRomFsSectionBrowser,
@@ -156,6 +164,8 @@ typedef enum {
     stateSdCardEmmcBatchDump,
     stateTicketMenu,
     stateDumpTicket,
+    stateSystemSaveMenu,
+    stateDumpSystemSave,
     stateUpdateMenu,
     stateUpdateNSWDBXml,
     stateUpdateApplication
@@ -171,6 +181,7 @@ void uiFill(int x, int y, int width, int height, u8 r, u8 g, u8 b);
 
 void uiDrawIcon(const u8 *icon, int width, int height, int x, int y);
 
+bool uiDecodeJpgFromMem(u8 *rawJpg, size_t rawJpgSize, int expectedWidth, int expectedHeight, int desiredWidth, int desiredHeight, u8 **outBuf, char *errBuf, size_t errBufSize);
 bool uiLoadJpgFromMem(u8 *rawJpg, size_t rawJpgSize, int expectedWidth, int expectedHeight, int desiredWidth, int desiredHeight, u8 **outBuf);
 
 bool uiLoadJpgFromFile(const char *filename, int expectedWidth, int expectedHeight, int desiredWidth, int desiredHeight, u8 **outBuf);
@@ -23,6 +23,7 @@
 #include "ui.h"
 #include "util.h"
 #include "fatfs/ff.h"
+#include "fatfs/diskio.h"
 
 /* Extern variables */
 
@@ -94,6 +95,13 @@ u8 *ncaCtrBuf = NULL;
 orphan_patch_addon_entry *orphanEntries = NULL;
 u32 orphanEntriesCnt = 0;
 
+// Patch / add-on entries sorted by (key, index), plus the range each base application spans within them
+static title_index_entry *patchIndexEntries = NULL, *addOnIndexEntries = NULL;
+static title_index_range *appPatchRanges = NULL, *appAddOnRanges = NULL;
+static u64 *sortedBaseAppTitleIds = NULL;
+static u32 orphanPatchCnt = 0, orphanAddOnCnt = 0;
+static bool titleIndexLoaded = false;
+
 char strbuf[NAME_BUF_LEN] = {'\0'};
 
 static const char *appLaunchPath = NULL;
@@ -101,6 +109,21 @@ static const char *appLaunchPath = NULL;
 FsStorage fatFsStorage = {0};
 static FATFS *fatFsObj = NULL;
 
+static title_cache_entry *titleCacheEntries = NULL;
+static u32 titleCacheEntryCount = 0;
+
+// Icon worker threads only decode icons requested while drawing the title list, and wait idle otherwise
+// They don't share any buffers or storage handles with the dump code, which still runs entirely on the main thread
+static icon_cache_slot iconCacheSlots[ICON_CACHE_SLOT_CNT];
+static u64 iconCacheTick = 0;
+static bool iconCacheUpdated = false;
+static pthread_mutex_t iconCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t iconCacheCond = PTHREAD_COND_INITIALIZER;
+static pthread_t iconWorkerThreads[ICON_WORKER_THREAD_CNT];
+static u32 iconWorkerThreadCnt = 0;
+static bool iconWorkersExit = false;
+static u64 iconCacheLanguageCode = 0;
+
 u64 freeSpace = 0;
 char freeSpaceStr[32] = {'\0'};
 
@@ -139,6 +162,33 @@ void loadConfig()
     size_t configFileSize = ftell(configFile);
     rewind(configFile);
     
+    if (configFileSize == sizeof(legacyDumpOptions))
+    {
+        // Migrate configuration files written before the hash verification options were added
+        legacyDumpOptions legacyCfg;
+        size_t read_res = fread(&legacyCfg, 1, sizeof(legacyDumpOptions), configFile);
+        fclose(configFile);
+        
+        if (read_res != sizeof(legacyDumpOptions))
+        {
+            remove(CONFIG_PATH);
+            return;
+        }
+        
+        memcpy(&(dumpCfg.xciDumpCfg), &(legacyCfg.xciDumpCfg), sizeof(xciOptions));
+        memcpy(&(dumpCfg.nspDumpCfg), &(legacyCfg.nspDumpCfg), sizeof(nspOptions));
+        memcpy(&(dumpCfg.batchDumpCfg), &(legacyCfg.batchDumpCfg), sizeof(batchOptions));
+        memcpy(&(dumpCfg.tikDumpCfg), &(legacyCfg.tikDumpCfg), sizeof(ticketOptions));
+        
+        dumpCfg.exeFsDumpCfg.isFat32 = legacyCfg.exeFsDumpCfg.isFat32;
+        dumpCfg.exeFsDumpCfg.useLayeredFSDir = legacyCfg.exeFsDumpCfg.useLayeredFSDir;
+        
+        dumpCfg.romFsDumpCfg.isFat32 = legacyCfg.romFsDumpCfg.isFat32;
+        dumpCfg.romFsDumpCfg.useLayeredFSDir = legacyCfg.romFsDumpCfg.useLayeredFSDir;
+        
+        goto check;
+    }
+    
     if (configFileSize != sizeof(dumpOptions))
     {
         fclose(configFile);
@@ -158,6 +208,7 @@ void loadConfig()
     
     memcpy(&dumpCfg, &tmpCfg, sizeof(dumpOptions));
     
+check:
     // Check if the configuration is correct
     if (dumpCfg.xciDumpCfg.setXciArchiveBit && !dumpCfg.xciDumpCfg.isFat32) dumpCfg.xciDumpCfg.setXciArchiveBit = false;
     
@@ -258,6 +309,359 @@ static bool createGameCardDetectionThread()
     return true;
 }
 
+static u64 getSystemLanguageCode()
+{
+    u64 languageCode = 0;
+    
+    if (R_SUCCEEDED(setInitialize()))
+    {
+        if (R_FAILED(setGetSystemLanguage(&languageCode))) languageCode = 0;
+        setExit();
+    }
+    
+    return languageCode;
+}
+
+static bool loadBaseApplicationIcon(u64 titleID, u32 version, u32 patchVersion, u8 *outIcon)
+{
+    bool success = false;
+    char iconPath[NAME_BUF_LEN] = {'\0'}, errBuf[NAME_BUF_LEN / 2] = {'\0'};
+    icon_cache_header header;
+    size_t outsize = 0;
+    u8 *decodedIcon = NULL;
+    NsApplicationControlData *buf = NULL;
+    
+    snprintf(iconPath, MAX_CHARACTERS(iconPath), "%s%016lX.bin", ICON_CACHE_PATH, titleID);
+    
+    // Decoded icons are kept in the SD card. Like title cache entries, they're discarded if the title was updated or if the system language changed
+    FILE *iconFile = fopen(iconPath, "rb");
+    if (iconFile)
+    {
+        success = (fread(&header, 1, sizeof(icon_cache_header), iconFile) == sizeof(icon_cache_header) && header.magic == __builtin_bswap32(ICON_CACHE_MAGIC) && header.version == version && \
+                   header.patchVersion == patchVersion && header.languageCode == iconCacheLanguageCode && fread(outIcon, 1, NACP_ICON_DOWNSCALED_SIZE, iconFile) == NACP_ICON_DOWNSCALED_SIZE);
+        fclose(iconFile);
+        if (success) return true;
+    }
+    
+    buf = calloc(1, sizeof(NsApplicationControlData));
+    if (!buf) return false;
+    
+    // Errors can't go to strbuf or the status bar from here, since this runs outside the UI thread
+    if (R_SUCCEEDED(nsGetApplicationControlData(NsApplicationControlSource_Storage, titleID, buf, sizeof(NsApplicationControlData), &outsize)) && outsize > sizeof(buf->nacp))
+    {
+        if (uiDecodeJpgFromMem(buf->icon, outsize - sizeof(buf->nacp), NACP_ICON_SQUARE_DIMENSION, NACP_ICON_SQUARE_DIMENSION, NACP_ICON_DOWNSCALED, NACP_ICON_DOWNSCALED, &decodedIcon, errBuf, MAX_CHARACTERS(errBuf)))
+        {
+            memcpy(outIcon, decodedIcon, NACP_ICON_DOWNSCALED_SIZE);
+            free(decodedIcon);
+            success = true;
+        }
+    }
+    
+    free(buf);
+    
+    if (success)
+    {
+        memset(&header, 0, sizeof(icon_cache_header));
+        header.magic = __builtin_bswap32(ICON_CACHE_MAGIC);
+        header.version = version;
+        header.patchVersion = patchVersion;
+        header.languageCode = iconCacheLanguageCode;
+        
+        iconFile = fopen(iconPath, "wb");
+        if (iconFile)
+        {
+            bool written = (fwrite(&header, 1, sizeof(icon_cache_header), iconFile) == sizeof(icon_cache_header) && fwrite(outIcon, 1, NACP_ICON_DOWNSCALED_SIZE, iconFile) == NACP_ICON_DOWNSCALED_SIZE);
+            fclose(iconFile);
+            if (!written) remove(iconPath);
+        }
+    }
+    
+    return success;
+}
+
+static icon_cache_slot *getNextPendingIconSlot()
+{
+    u32 i;
+    icon_cache_slot *slot = NULL;
+    
+    // The most recently requested icons belong to the rows currently on screen, so those go first
+    for(i = 0; i < ICON_CACHE_SLOT_CNT; i++)
+    {
+        if (iconCacheSlots[i].state == ICON_SLOT_PENDING && (!slot || iconCacheSlots[i].lastUsed > slot->lastUsed)) slot = &(iconCacheSlots[i]);
+    }
+    
+    return slot;
+}
+
+static void *iconWorkerThreadFunc(void *arg)
+{
+    (void)arg;
+    
+    icon_cache_slot *slot = NULL;
+    
+    while(true)
+    {
+        pthread_mutex_lock(&iconCacheMutex);
+        
+        while(!iconWorkersExit && !(slot = getNextPendingIconSlot())) pthread_cond_wait(&iconCacheCond, &iconCacheMutex);
+        
+        if (iconWorkersExit)
+        {
+            pthread_mutex_unlock(&iconCacheMutex);
+            break;
+        }
+        
+        // Loading slots are never evicted, so the icon buffer can be filled without holding the lock
+        slot->state = ICON_SLOT_LOADING;
+        u64 titleID = slot->titleId;
+        u32 version = slot->version;
+        u32 patchVersion = slot->patchVersion;
+        
+        pthread_mutex_unlock(&iconCacheMutex);
+        
+        bool loaded = loadBaseApplicationIcon(titleID, version, patchVersion, slot->icon);
+        
+        pthread_mutex_lock(&iconCacheMutex);
+        slot->state = (loaded ? ICON_SLOT_READY : ICON_SLOT_FAILED);
+        iconCacheUpdated = true;
+        pthread_mutex_unlock(&iconCacheMutex);
+    }
+    
+    return 0;
+}
+
+static bool initIconCache()
+{
+    u32 i;
+    int ret = 0;
+    
+    memset(iconCacheSlots, 0, sizeof(iconCacheSlots));
+    
+    iconCacheLanguageCode = getSystemLanguageCode();
+    
+    for(i = 0; i < ICON_CACHE_SLOT_CNT; i++)
+    {
+        iconCacheSlots[i].icon = malloc(NACP_ICON_DOWNSCALED_SIZE);
+        if (!iconCacheSlots[i].icon)
+        {
+            uiDrawString(STRING_DEFAULT_POS, FONT_COLOR_ERROR_RGB, "%s: failed to allocate memory for the icon cache!", __func__);
+            return false;
+        }
+    }
+    
+    iconWorkersExit = false;
+    
+    for(i = 0; i < ICON_WORKER_THREAD_CNT; i++)
+    {
+        ret = pthread_create(&(iconWorkerThreads[i]), NULL, &iconWorkerThreadFunc, NULL);
+        if (ret != 0)
+        {
+            uiDrawString(STRING_DEFAULT_POS, FONT_COLOR_ERROR_RGB, "%s: failed to create icon worker thread #%u! (%d)", __func__, i, ret);
+            return false;
+        }
+        
+        iconWorkerThreadCnt++;
+    }
+    
+    return true;
+}
+
+static void deinitIconCache()
+{
+    u32 i;
+    
+    pthread_mutex_lock(&iconCacheMutex);
+    iconWorkersExit = true;
+    pthread_cond_broadcast(&iconCacheCond);
+    pthread_mutex_unlock(&iconCacheMutex);
+    
+    for(i = 0; i < iconWorkerThreadCnt; i++) pthread_join(iconWorkerThreads[i], NULL);
+    iconWorkerThreadCnt = 0;
+    
+    for(i = 0; i < ICON_CACHE_SLOT_CNT; i++)
+    {
+        if (iconCacheSlots[i].icon) free(iconCacheSlots[i].icon);
+    }
+    
+    memset(iconCacheSlots, 0, sizeof(iconCacheSlots));
+}
+
+u8 *getBaseApplicationIcon(u32 appIndex)
+{
+    if (!baseAppEntries || appIndex >= titleAppCount || !iconWorkerThreadCnt) return NULL;
+    
+    u32 i;
+    u8 *icon = NULL;
+    icon_cache_slot *slot = NULL, *victim = NULL;
+    u64 titleID = baseAppEntries[appIndex].titleId;
+    u32 version = baseAppEntries[appIndex].version;
+    u32 patchVersion = baseAppEntries[appIndex].patchVersion;
+    
+    pthread_mutex_lock(&iconCacheMutex);
+    
+    for(i = 0; i < ICON_CACHE_SLOT_CNT; i++)
+    {
+        if (iconCacheSlots[i].state != ICON_SLOT_EMPTY && iconCacheSlots[i].titleId == titleID && iconCacheSlots[i].version == version && iconCacheSlots[i].patchVersion == patchVersion)
+        {
+            slot = &(iconCacheSlots[i]);
+            break;
+        }
+        
+        // Slots being loaded can't be reused until their worker is done with them
+        if (iconCacheSlots[i].state != ICON_SLOT_LOADING && (!victim || iconCacheSlots[i].lastUsed < victim->lastUsed)) victim = &(iconCacheSlots[i]);
+    }
+    
+    if (!slot && victim)
+    {
+        slot = victim;
+        slot->titleId = titleID;
+        slot->version = version;
+        slot->patchVersion = patchVersion;
+        slot->state = ICON_SLOT_PENDING;
+        pthread_cond_signal(&iconCacheCond);
+    }
+    
+    if (slot)
+    {
+        slot->lastUsed = ++iconCacheTick;
+        if (slot->state == ICON_SLOT_READY) icon = slot->icon;
+    }
+    
+    pthread_mutex_unlock(&iconCacheMutex);
+    
+    return icon;
+}
+
+bool checkIfBaseApplicationIconsUpdated()
+{
+    pthread_mutex_lock(&iconCacheMutex);
+    bool updated = iconCacheUpdated;
+    iconCacheUpdated = false;
+    pthread_mutex_unlock(&iconCacheMutex);
+    
+    return updated;
+}
+
+static gamecard_read_ahead_window gcReadAheadWindows[GAMECARD_READ_AHEAD_WINDOW_CNT];
+static u64 gcReadAheadTick = 0;
+static u64 gcReadAheadPartitionSize = 0;
+static u64 gcReadAheadLastWindowOffset = 0;
+static bool gcReadAheadLastWindowValid = false;
+
+static void invalidateGameCardReadAheadCache()
+{
+    u32 i;
+    for(i = 0; i < GAMECARD_READ_AHEAD_WINDOW_CNT; i++) gcReadAheadWindows[i].valid = false;
+    
+    gcReadAheadTick = 0;
+    gcReadAheadPartitionSize = 0;
+    gcReadAheadLastWindowOffset = 0;
+    gcReadAheadLastWindowValid = false;
+}
+
+static gamecard_read_ahead_window *getGameCardReadAheadWindow(u64 windowOffset)
+{
+    u32 i;
+    
+    for(i = 0; i < GAMECARD_READ_AHEAD_WINDOW_CNT; i++)
+    {
+        if (gcReadAheadWindows[i].valid && gcReadAheadWindows[i].offset == windowOffset) return &(gcReadAheadWindows[i]);
+    }
+    
+    return NULL;
+}
+
+static gamecard_read_ahead_window *getGameCardReadAheadVictimWindow(const gamecard_read_ahead_window *keep)
+{
+    u32 i;
+    gamecard_read_ahead_window *victim = NULL;
+    
+    for(i = 0; i < GAMECARD_READ_AHEAD_WINDOW_CNT; i++)
+    {
+        if (&(gcReadAheadWindows[i]) == keep) continue;
+        if (!gcReadAheadWindows[i].valid) return &(gcReadAheadWindows[i]);
+        if (!victim || gcReadAheadWindows[i].last_used < victim->last_used) victim = &(gcReadAheadWindows[i]);
+    }
+    
+    return victim;
+}
+
+static Result fillGameCardReadAheadWindow(u64 windowOffset, gamecard_read_ahead_window **out)
+{
+    Result result;
+    gamecard_read_ahead_window *window = NULL, *nextWindow = NULL;
+    
+    u64 windowSize = ((gcReadAheadPartitionSize - windowOffset) > GAMECARD_READ_AHEAD_WINDOW_SIZE ? GAMECARD_READ_AHEAD_WINDOW_SIZE : (gcReadAheadPartitionSize - windowOffset));
+    u64 nextWindowOffset = (windowOffset + GAMECARD_READ_AHEAD_WINDOW_SIZE);
+    u64 nextWindowSize = 0;
+    
+    // Sequential access: fetch the following window with the same storage read
+    bool sequential = (gcReadAheadLastWindowValid && (windowOffset == gcReadAheadLastWindowOffset || windowOffset == (gcReadAheadLastWindowOffset + GAMECARD_READ_AHEAD_WINDOW_SIZE)));
+    if (sequential && windowSize == GAMECARD_READ_AHEAD_WINDOW_SIZE && nextWindowOffset < gcReadAheadPartitionSize && !getGameCardReadAheadWindow(nextWindowOffset))
+    {
+        nextWindowSize = ((gcReadAheadPartitionSize - nextWindowOffset) > GAMECARD_READ_AHEAD_WINDOW_SIZE ? GAMECARD_READ_AHEAD_WINDOW_SIZE : (gcReadAheadPartitionSize - nextWindowOffset));
+    }
+    
+    result = fsStorageRead(&(gameCardInfo.fsGameCardStorage), windowOffset, gcReadBuf, windowSize + nextWindowSize);
+    if (R_FAILED(result)) return result;
+    
+    window = getGameCardReadAheadVictimWindow(NULL);
+    memcpy(window->data, gcReadBuf, windowSize);
+    window->valid = true;
+    window->offset = windowOffset;
+    window->size = windowSize;
+    window->last_used = ++gcReadAheadTick;
+    
+    if (nextWindowSize)
+    {
+        nextWindow = getGameCardReadAheadVictimWindow(window);
+        memcpy(nextWindow->data, gcReadBuf + windowSize, nextWindowSize);
+        nextWindow->valid = true;
+        nextWindow->offset = nextWindowOffset;
+        nextWindow->size = nextWindowSize;
+        
+        // Prefetched windows are the first candidates for eviction until they're actually used
+        nextWindow->last_used = 0;
+    }
+    
+    *out = window;
+    
+    return result;
+}
+
+static Result readGameCardStoragePartitionWindowed(u64 off, u8 *outBuf, u64 len)
+{
+    Result result = 0;
+    gamecard_read_ahead_window *window = NULL;
+    
+    while(len)
+    {
+        u64 windowOffset = (off - (off % GAMECARD_READ_AHEAD_WINDOW_SIZE));
+        
+        window = getGameCardReadAheadWindow(windowOffset);
+        if (!window)
+        {
+            result = fillGameCardReadAheadWindow(windowOffset, &window);
+            if (R_FAILED(result)) return result;
+        }
+        
+        window->last_used = ++gcReadAheadTick;
+        gcReadAheadLastWindowOffset = windowOffset;
+        gcReadAheadLastWindowValid = true;
+        
+        u64 windowDataOffset = (off - windowOffset);
+        u64 copySize = ((window->size - windowDataOffset) > len ? len : (window->size - windowDataOffset));
+        
+        memcpy(outBuf, window->data + windowDataOffset, copySize);
+        
+        off += copySize;
+        outBuf += copySize;
+        len -= copySize;
+    }
+    
+    return result;
+}
+
 static void closeGameCardHandle()
 {
     svcCloseHandle(gameCardInfo.fsGameCardHandle.value);
@@ -271,6 +675,8 @@ void closeGameCardStoragePartition()
     fsStorageClose(&(gameCardInfo.fsGameCardStorage));
     memset(&(gameCardInfo.fsGameCardStorage), 0, sizeof(FsStorage));
     
+    invalidateGameCardReadAheadCache();
+    
     closeGameCardHandle();
     
     gameCardInfo.curIStorageIndex = ISTORAGE_PARTITION_NONE;
@@ -311,6 +717,10 @@ Result openGameCardStoragePartition(openIStoragePartition partitionIndex)
     {
         // Update current IStorage index
         gameCardInfo.curIStorageIndex = partitionIndex;
+        
+        // Windowed reads are only used if we know where the partition ends
+        invalidateGameCardReadAheadCache();
+        if (R_FAILED(fsStorageGetSize(&(gameCardInfo.fsGameCardStorage), (s64*)&gcReadAheadPartitionSize))) gcReadAheadPartitionSize = 0;
     } else {
         // res2 takes precedence over res1
         out = (R_FAILED(res2) ? res2 : res1);
@@ -327,6 +737,9 @@ Result readGameCardStoragePartition(u64 off, void *buf, size_t len)
 {
     if (!gameCardInfo.curIStorageIndex || gameCardInfo.curIStorageIndex >= ISTORAGE_PARTITION_INVALID || !buf || !len) return MAKERESULT(Module_Libnx, LibnxError_IoError);
     
+    // Serve small reads (headers, tables, NCA metadata) from the read-ahead window cache
+    if (len <= GAMECARD_READ_AHEAD_WINDOW_SIZE && gcReadAheadPartitionSize && off < gcReadAheadPartitionSize && len <= (gcReadAheadPartitionSize - off)) return readGameCardStoragePartitionWindowed(off, (u8*)buf, len);
+    
     // Optimization for reads that are already aligned to MEDIA_UNIT_SIZE bytes
     if (!(off % MEDIA_UNIT_SIZE) && !(len % MEDIA_UNIT_SIZE)) return fsStorageRead(&(gameCardInfo.fsGameCardStorage), off, buf, len);
     
@@ -369,6 +782,8 @@ bool mountSysEmmcPartition()
         return false;
     }
     
+    disk_cache_reset();
+    
     fatFsObj = calloc(1, sizeof(FATFS));
     if (!fatFsObj)
     {
@@ -400,6 +815,8 @@ void unmountSysEmmcPartition()
         fsStorageClose(&fatFsStorage);
         memset(&fatFsStorage, 0, sizeof(FsStorage));
     }
+    
+    disk_cache_reset();
 }
 
 static bool getExosphereApiVersion(u32 *out)
@@ -488,6 +905,8 @@ static void createOutputDirectories()
     mkdir(CERT_DUMP_PATH, 0744);
     mkdir(BATCH_OVERRIDES_PATH, 0744);
     mkdir(TICKET_PATH, 0744);
+    mkdir(SAVE_DUMP_PATH, 0744);
+    mkdir(ICON_CACHE_PATH, 0744);
 }
 
 static bool getSdCardFreeSpace(u64 *out)
@@ -637,6 +1056,8 @@ void freeExeFsContext()
         free(exeFsContext.exefs_str_table);
         exeFsContext.exefs_str_table = NULL;
     }
+    
+    freePfs0HashContext(&(exeFsContext.hash_ctx));
 }
 
 void initRomFsContext()
@@ -664,6 +1085,8 @@ void freeRomFsContext()
         free(romFsContext.romfs_file_entries);
         romFsContext.romfs_file_entries = NULL;
     }
+    
+    freeIvfcContext(&(romFsContext.ivfc_ctx));
 }
 
 void initBktrContext()
@@ -680,31 +1103,201 @@ void freeBktrContext()
     ncmContentStorageClose(&(bktrContext.ncmStorage));
     memset(&(bktrContext.ncmStorage), 0, sizeof(NcmContentStorage));
     
-    if (bktrContext.relocation_block != NULL)
-    {
-        free(bktrContext.relocation_block);
-        bktrContext.relocation_block = NULL;
-    }
+    if (bktrContext.relocation_block != NULL)
+    {
+        free(bktrContext.relocation_block);
+        bktrContext.relocation_block = NULL;
+    }
+    
+    if (bktrContext.subsection_block != NULL)
+    {
+        free(bktrContext.subsection_block);
+        bktrContext.subsection_block = NULL;
+    }
+    
+    if (bktrContext.romfs_dir_entries != NULL)
+    {
+        free(bktrContext.romfs_dir_entries);
+        bktrContext.romfs_dir_entries = NULL;
+    }
+    
+    if (bktrContext.romfs_file_entries != NULL)
+    {
+        free(bktrContext.romfs_file_entries);
+        bktrContext.romfs_file_entries = NULL;
+    }
+    
+    freeIvfcContext(&(bktrContext.ivfc_ctx));
+    
+    bktrContext.use_base_romfs = false;
+}
+
+static u32 hashFilename(const char *filename)
+{
+    // FNV-1a. Lookups are case insensitive
+    u32 hash = 0x811C9DC5;
+    
+    while(*filename)
+    {
+        hash ^= (u8)tolower((unsigned char)*filename++);
+        hash *= 0x01000193;
+    }
+    
+    return hash;
+}
+
+void freeDirectoryFilenameIndex(dir_filename_index *index)
+{
+    if (!index) return;
+    
+    if (index->names) free(index->names);
+    if (index->name_offsets) free(index->name_offsets);
+    if (index->buckets) free(index->buckets);
+    
+    memset(index, 0, sizeof(dir_filename_index));
+}
+
+// Lists a directory only once, so membership checks don't need to hit the filesystem
+// A missing directory results in an empty index
+bool buildDirectoryFilenameIndex(const char *path, dir_filename_index *index)
+{
+    if (!path || !strlen(path) || !index) return false;
+    
+    DIR *dir = NULL;
+    struct dirent *ent;
+    
+    u32 i, bucket, name_offsets_size = 0;
+    u64 names_size = 0, names_used = 0, name_len;
+    char *tmp_names = NULL;
+    u32 *tmp_name_offsets = NULL;
+    
+    bool success = false;
+    
+    freeDirectoryFilenameIndex(index);
+    
+    dir = opendir(path);
+    if (dir)
+    {
+        while((ent = readdir(dir)) != NULL)
+        {
+            if (!strcmp(ent->d_name, ".") || !strcmp(ent->d_name, "..")) continue;
+            
+            name_len = (strlen(ent->d_name) + 1);
+            
+            if ((names_used + name_len) > names_size)
+            {
+                names_size = (names_size ? (names_size * 2) : 0x4000);
+                while((names_used + name_len) > names_size) names_size *= 2;
+                
+                tmp_names = realloc(index->names, names_size);
+                if (!tmp_names) goto out;
+                
+                index->names = tmp_names;
+                tmp_names = NULL;
+            }
+            
+            if (index->name_cnt >= name_offsets_size)
+            {
+                name_offsets_size = (name_offsets_size ? (name_offsets_size * 2) : 256);
+                
+                tmp_name_offsets = realloc(index->name_offsets, name_offsets_size * sizeof(u32));
+                if (!tmp_name_offsets) goto out;
+                
+                index->name_offsets = tmp_name_offsets;
+                tmp_name_offsets = NULL;
+            }
+            
+            memcpy(index->names + names_used, ent->d_name, name_len);
+            index->name_offsets[index->name_cnt++] = (u32)names_used;
+            names_used += name_len;
+        }
+    }
+    
+    // Keep the load factor at or below 50%
+    index->bucket_cnt = 16;
+    while(index->bucket_cnt < (index->name_cnt * 2)) index->bucket_cnt <<= 1;
+    
+    index->buckets = calloc(index->bucket_cnt, sizeof(u32));
+    if (!index->buckets) goto out;
+    
+    for(i = 0; i < index->name_cnt; i++)
+    {
+        bucket = (hashFilename(index->names + index->name_offsets[i]) & (index->bucket_cnt - 1));
+        while(index->buckets[bucket]) bucket = ((bucket + 1) & (index->bucket_cnt - 1));
+        
+        index->buckets[bucket] = (i + 1);
+    }
+    
+    success = true;
+    
+out:
+    if (dir) closedir(dir);
+    
+    if (!success) freeDirectoryFilenameIndex(index);
+    
+    return success;
+}
+
+bool checkDirectoryFilenameIndex(const dir_filename_index *index, const char *filename)
+{
+    if (!index || !index->buckets || !index->bucket_cnt || !index->name_cnt || !filename || !strlen(filename)) return false;
+    
+    u32 bucket = (hashFilename(filename) & (index->bucket_cnt - 1));
+    
+    while(index->buckets[bucket])
+    {
+        if (!strcasecmp(index->names + index->name_offsets[index->buckets[bucket] - 1], filename)) return true;
+        bucket = ((bucket + 1) & (index->bucket_cnt - 1));
+    }
+    
+    return false;
+}
+
+static void freeHfs0FilenameIndex(hfs0_filename_index *index)
+{
+    if (!index) return;
+    
+    if (index->buckets) free(index->buckets);
+    
+    index->buckets = NULL;
+    index->bucket_cnt = 0;
+}
+
+static bool buildHfs0FilenameIndex(u32 partition, hfs0_filename_index *index)
+{
+    if (!gameCardInfo.hfs0Partitions || partition >= gameCardInfo.hfs0PartitionCnt || !gameCardInfo.hfs0Partitions[partition].header || !index) return false;
+    
+    u32 i, bucket;
+    hfs0_file_entry entry;
+    
+    u32 file_cnt = gameCardInfo.hfs0Partitions[partition].file_cnt;
+    char *str_table = (char*)(gameCardInfo.hfs0Partitions[partition].header + sizeof(hfs0_header) + (file_cnt * sizeof(hfs0_file_entry)));
     
-    if (bktrContext.subsection_block != NULL)
-    {
-        free(bktrContext.subsection_block);
-        bktrContext.subsection_block = NULL;
-    }
+    freeHfs0FilenameIndex(index);
     
-    if (bktrContext.romfs_dir_entries != NULL)
+    // Keep the load factor at or below 50%
+    index->bucket_cnt = 16;
+    while(index->bucket_cnt < (file_cnt * 2)) index->bucket_cnt <<= 1;
+    
+    index->buckets = calloc(index->bucket_cnt, sizeof(u32));
+    if (!index->buckets)
     {
-        free(bktrContext.romfs_dir_entries);
-        bktrContext.romfs_dir_entries = NULL;
+        index->bucket_cnt = 0;
+        return false;
     }
     
-    if (bktrContext.romfs_file_entries != NULL)
+    for(i = 0; i < file_cnt; i++)
     {
-        free(bktrContext.romfs_file_entries);
-        bktrContext.romfs_file_entries = NULL;
+        memcpy(&entry, gameCardInfo.hfs0Partitions[partition].header + sizeof(hfs0_header) + (i * sizeof(hfs0_file_entry)), sizeof(hfs0_file_entry));
+        if (entry.filename_offset >= gameCardInfo.hfs0Partitions[partition].str_table_size) continue;
+        
+        bucket = (hashFilename(str_table + entry.filename_offset) & (index->bucket_cnt - 1));
+        while(index->buckets[bucket]) bucket = ((bucket + 1) & (index->bucket_cnt - 1));
+        
+        index->buckets[bucket] = (i + 1);
     }
     
-    bktrContext.use_base_romfs = false;
+    return true;
 }
 
 static void freeGameCardInfo()
@@ -719,6 +1312,12 @@ static void freeGameCardInfo()
         gameCardInfo.rootHfs0Header = NULL;
     }
     
+    gameCardInfo.rootHfs0HeaderHashValid = false;
+    
+    freeHfs0FilenameIndex(&(gameCardInfo.secureHfs0Index));
+    
+    invalidateNcaContentPathCache();
+    
     if (gameCardInfo.hfs0Partitions)
     {
         for(i = 0; i < gameCardInfo.hfs0PartitionCnt; i++)
@@ -758,18 +1357,232 @@ static void freeOrphanPatchOrAddOnList()
     orphanEntriesCnt = 0;
 }
 
-static void freeTitleInfo()
+static int titleIndexEntryCmp(const void *a, const void *b)
+{
+    const title_index_entry *entry1 = (const title_index_entry*)a;
+    const title_index_entry *entry2 = (const title_index_entry*)b;
+    
+    if (entry1->key != entry2->key) return (entry1->key < entry2->key ? -1 : 1);
+    if (entry1->index != entry2->index) return (entry1->index < entry2->index ? -1 : 1);
+    
+    return 0;
+}
+
+static int titleIdCmp(const void *a, const void *b)
+{
+    u64 titleId1 = *((const u64*)a);
+    u64 titleId2 = *((const u64*)b);
+    
+    if (titleId1 != titleId2) return (titleId1 < titleId2 ? -1 : 1);
+    
+    return 0;
+}
+
+static inline u64 getPatchOrAddOnKeyFromBaseApplication(u64 titleId, bool addOn)
+{
+    return (!addOn ? (titleId | APPLICATION_PATCH_BITMASK) : (titleId & APPLICATION_ADDON_BITMASK));
+}
+
+static void freeTitleIndex()
+{
+    if (patchIndexEntries)
+    {
+        free(patchIndexEntries);
+        patchIndexEntries = NULL;
+    }
+    
+    if (addOnIndexEntries)
+    {
+        free(addOnIndexEntries);
+        addOnIndexEntries = NULL;
+    }
+    
+    if (appPatchRanges)
+    {
+        free(appPatchRanges);
+        appPatchRanges = NULL;
+    }
+    
+    if (appAddOnRanges)
+    {
+        free(appAddOnRanges);
+        appAddOnRanges = NULL;
+    }
+    
+    if (sortedBaseAppTitleIds)
+    {
+        free(sortedBaseAppTitleIds);
+        sortedBaseAppTitleIds = NULL;
+    }
+    
+    orphanPatchCnt = 0;
+    orphanAddOnCnt = 0;
+    
+    titleIndexLoaded = false;
+}
+
+static bool checkIfPatchOrAddOnHasBaseApplication(u32 titleIndex, bool addOn)
+{
+    if (!sortedBaseAppTitleIds || !titleAppCount) return false;
+    
+    u64 key = (!addOn ? patchEntries[titleIndex].titleId : (addOnEntries[titleIndex].titleId & APPLICATION_ADDON_BITMASK));
+    u32 low = 0, high = titleAppCount, mid;
+    
+    // Both key transforms are monotonic, so the sorted base application Title IDs stay sorted under them
+    while(low < high)
+    {
+        mid = (low + ((high - low) / 2));
+        
+        if (getPatchOrAddOnKeyFromBaseApplication(sortedBaseAppTitleIds[mid], addOn) < key)
+        {
+            low = (mid + 1);
+        } else {
+            high = mid;
+        }
+    }
+    
+    return (low < titleAppCount && getPatchOrAddOnKeyFromBaseApplication(sortedBaseAppTitleIds[low], addOn) == key);
+}
+
+static bool buildPatchOrAddOnIndex(bool addOn)
 {
     u32 i;
+    u32 count = (!addOn ? titlePatchCount : titleAddOnCount);
+    patch_addon_ctx_t *entries = (!addOn ? patchEntries : addOnEntries);
+    
+    title_index_entry *indexEntries = NULL;
+    title_index_range *ranges = NULL;
+    u32 orphanCnt = 0;
+    
+    if (!count || !entries) return true;
+    
+    indexEntries = malloc(count * sizeof(title_index_entry));
+    if (!indexEntries) return false;
+    
+    for(i = 0; i < count; i++)
+    {
+        indexEntries[i].key = (!addOn ? entries[i].titleId : (entries[i].titleId & APPLICATION_ADDON_BITMASK));
+        indexEntries[i].index = i;
+    }
+    
+    qsort(indexEntries, count, sizeof(title_index_entry), titleIndexEntryCmp);
     
-    if (baseAppEntries && titleAppCount)
+    if (titleAppCount && baseAppEntries)
     {
+        ranges = calloc(titleAppCount, sizeof(title_index_range));
+        if (!ranges)
+        {
+            free(indexEntries);
+            return false;
+        }
+        
         for(i = 0; i < titleAppCount; i++)
         {
-            if (baseAppEntries[i].icon) free(baseAppEntries[i].icon);
+            u64 key = getPatchOrAddOnKeyFromBaseApplication(baseAppEntries[i].titleId, addOn);
+            u32 low = 0, high = count, mid;
+            
+            while(low < high)
+            {
+                mid = (low + ((high - low) / 2));
+                
+                if (indexEntries[mid].key < key)
+                {
+                    low = (mid + 1);
+                } else {
+                    high = mid;
+                }
+            }
+            
+            ranges[i].start = low;
+            while(low < count && indexEntries[low].key == key) low++;
+            ranges[i].count = (low - ranges[i].start);
         }
     }
     
+    if (!addOn)
+    {
+        patchIndexEntries = indexEntries;
+        appPatchRanges = ranges;
+    } else {
+        addOnIndexEntries = indexEntries;
+        appAddOnRanges = ranges;
+    }
+    
+    for(i = 0; i < count; i++)
+    {
+        if (!checkIfPatchOrAddOnHasBaseApplication(i, addOn)) orphanCnt++;
+    }
+    
+    if (!addOn)
+    {
+        orphanPatchCnt = orphanCnt;
+    } else {
+        orphanAddOnCnt = orphanCnt;
+    }
+    
+    return true;
+}
+
+static bool loadTitleIndex()
+{
+    if (titleIndexLoaded) return true;
+    
+    freeTitleIndex();
+    
+    if (titleAppCount && baseAppEntries)
+    {
+        u32 i;
+        
+        sortedBaseAppTitleIds = malloc(titleAppCount * sizeof(u64));
+        if (!sortedBaseAppTitleIds) return false;
+        
+        for(i = 0; i < titleAppCount; i++) sortedBaseAppTitleIds[i] = baseAppEntries[i].titleId;
+        
+        qsort(sortedBaseAppTitleIds, titleAppCount, sizeof(u64), titleIdCmp);
+    }
+    
+    if (!buildPatchOrAddOnIndex(false) || !buildPatchOrAddOnIndex(true))
+    {
+        freeTitleIndex();
+        return false;
+    }
+    
+    titleIndexLoaded = true;
+    
+    return true;
+}
+
+static title_index_range *getPatchOrAddOnIndexRange(u32 appIndex, bool addOn)
+{
+    if (!titleAppCount || !baseAppEntries || appIndex >= titleAppCount || (!addOn && (!titlePatchCount || !patchEntries)) || (addOn && (!titleAddOnCount || !addOnEntries))) return NULL;
+    
+    if (!loadTitleIndex()) return NULL;
+    
+    title_index_range *range = (!addOn ? &(appPatchRanges[appIndex]) : &(appAddOnRanges[appIndex]));
+    
+    return (range->count ? range : NULL);
+}
+
+static u32 getHighestPatchVersionFromBaseApplication(u32 appIndex)
+{
+    title_index_range *range = getPatchOrAddOnIndexRange(appIndex, false);
+    if (!range) return 0;
+    
+    u32 i, version = 0;
+    
+    // The same patch may be installed in both the SD card and the eMMC
+    for(i = range->start; i < (range->start + range->count); i++)
+    {
+        if (patchEntries[patchIndexEntries[i].index].version > version) version = patchEntries[patchIndexEntries[i].index].version;
+    }
+    
+    return version;
+}
+
+static void freeTitleInfo()
+{
+    freeTitleIndex();
+
     if (baseAppEntries)
     {
         free(baseAppEntries);
@@ -1099,6 +1912,9 @@ bool initApplicationResources(int argc, char **argv)
     
     gcThreadInit = true;
     
+    /* Allocate the icon cache and start its worker threads */
+    if (!initIconCache()) goto out;
+    
     /* Load settings from configuration file */
     loadConfig();
     
@@ -1135,6 +1951,9 @@ void deinitApplicationResources()
         pthread_join(gameCardDetectionThread, NULL);
     }
     
+    /* Stop the icon worker threads and free the icon cache */
+    deinitIconCache();
+    
     /* Close gamecard detection kernel event */
     if (loadGcKernEvt) eventClose(&(gameCardInfo.fsGameCardKernelEvent));
     
@@ -1324,6 +2143,9 @@ static bool listTitlesByType(NcmContentMetaDatabase *ncmDb, NcmContentMetaType m
     
     if (!proceed) goto out;
     
+    // The title lists are about to change, so the title index must be regenerated
+    freeTitleIndex();
+    
     if (metaType == NcmContentMetaType_Application)
     {
         // If ptr == NULL, realloc will essentially act as a malloc
@@ -1532,52 +2354,236 @@ bool loadTitlesFromSdCardAndEmmc(NcmContentMetaType metaType)
     return false;
 }
 
-void freeTitlesFromSdCardAndEmmc(NcmContentMetaType metaType)
+void freeTitlesFromSdCardAndEmmc(NcmContentMetaType metaType)
+{
+    if (menuType != MENUTYPE_GAMECARD || (metaType != NcmContentMetaType_Patch && metaType != NcmContentMetaType_AddOnContent) || (metaType == NcmContentMetaType_Patch && (!titlePatchCount || !gameCardSdCardEmmcPatchCount)) || (metaType == NcmContentMetaType_AddOnContent && (!titleAddOnCount || !gameCardSdCardEmmcAddOnCount))) return;
+    
+    patch_addon_ctx_t *tmpPatchAddOnEntries = NULL;
+    
+    freeTitleIndex();
+    
+    if (metaType == NcmContentMetaType_Patch)
+    {
+        if ((titlePatchCount - gameCardSdCardEmmcPatchCount) > 0)
+        {
+            tmpPatchAddOnEntries = realloc(patchEntries, (titlePatchCount - gameCardSdCardEmmcPatchCount) * sizeof(patch_addon_ctx_t));
+            if (tmpPatchAddOnEntries != NULL)
+            {
+                patchEntries = tmpPatchAddOnEntries;
+                tmpPatchAddOnEntries = NULL;
+            }
+        } else {
+            free(patchEntries);
+            patchEntries = NULL;
+        }
+        
+        titlePatchCount -= gameCardSdCardEmmcPatchCount;
+        
+        gameCardSdCardEmmcPatchCount = 0;
+        sdCardTitlePatchCount = 0;
+        emmcTitlePatchCount = 0;
+    } else {
+        if ((titleAddOnCount - gameCardSdCardEmmcAddOnCount) > 0)
+        {
+            tmpPatchAddOnEntries = realloc(addOnEntries, (titleAddOnCount - gameCardSdCardEmmcAddOnCount) * sizeof(patch_addon_ctx_t));
+            if (tmpPatchAddOnEntries != NULL)
+            {
+                addOnEntries = tmpPatchAddOnEntries;
+                tmpPatchAddOnEntries = NULL;
+            }
+        } else {
+            free(addOnEntries);
+            addOnEntries = NULL;
+        }
+        
+        titleAddOnCount -= gameCardSdCardEmmcAddOnCount;
+        
+        gameCardSdCardEmmcAddOnCount = 0;
+        sdCardTitleAddOnCount = 0;
+        emmcTitleAddOnCount = 0;
+    }
+}
+
+static int titleCacheEntryCmp(const void *a, const void *b)
+{
+	const title_cache_entry *entry1 = (const title_cache_entry*)a;
+	const title_cache_entry *entry2 = (const title_cache_entry*)b;
+	
+	if (entry1->titleId != entry2->titleId) return (entry1->titleId < entry2->titleId ? -1 : 1);
+	
+	return ((int)entry1->storageId - (int)entry2->storageId);
+}
+
+static void freeTitleMetadataCache()
+{
+    if (titleCacheEntries)
+    {
+        free(titleCacheEntries);
+        titleCacheEntries = NULL;
+    }
+    
+    titleCacheEntryCount = 0;
+}
+
+static void loadTitleMetadataCache(u64 languageCode)
+{
+    freeTitleMetadataCache();
+    
+    FILE *cacheFile = fopen(TITLE_CACHE_PATH, "rb");
+    if (!cacheFile) return;
+    
+    u32 i;
+    bool success = false;
+    title_cache_header header;
+    
+    fseek(cacheFile, 0, SEEK_END);
+    size_t cacheFileSize = ftell(cacheFile);
+    rewind(cacheFile);
+    
+    if (fread(&header, 1, sizeof(title_cache_header), cacheFile) != sizeof(title_cache_header)) goto out;
+    
+    // Names and authors depend on the system language, so the whole cache is discarded if it changes
+    if (header.magic != __builtin_bswap32(TITLE_CACHE_MAGIC) || header.version != TITLE_CACHE_VERSION || header.languageCode != languageCode || !header.entryCount) goto out;
+    
+    if (cacheFileSize != (sizeof(title_cache_header) + ((size_t)header.entryCount * sizeof(title_cache_entry)))) goto out;
+    
+    titleCacheEntries = malloc(header.entryCount * sizeof(title_cache_entry));
+    if (!titleCacheEntries) goto out;
+    
+    if (fread(titleCacheEntries, sizeof(title_cache_entry), header.entryCount, cacheFile) != header.entryCount) goto out;
+    
+    for(i = 0; i < header.entryCount; i++)
+    {
+        titleCacheEntries[i].name[NACP_APPNAME_LEN - 1] = '\0';
+        titleCacheEntries[i].author[NACP_AUTHOR_LEN - 1] = '\0';
+    }
+    
+    titleCacheEntryCount = header.entryCount;
+    qsort(titleCacheEntries, titleCacheEntryCount, sizeof(title_cache_entry), titleCacheEntryCmp);
+    
+    success = true;
+    
+out:
+    fclose(cacheFile);
+    
+    if (!success)
+    {
+        freeTitleMetadataCache();
+        remove(TITLE_CACHE_PATH);
+    }
+}
+
+static title_cache_entry *getTitleMetadataCacheEntry(u64 titleID, u32 version, u32 patchVersion, NcmStorageId storageId)
+{
+    if (!titleCacheEntries || !titleCacheEntryCount) return NULL;
+    
+    title_cache_entry key;
+    key.titleId = titleID;
+    key.storageId = (u8)storageId;
+    
+    title_cache_entry *entry = bsearch(&key, titleCacheEntries, titleCacheEntryCount, sizeof(title_cache_entry), titleCacheEntryCmp);
+    
+    // A different base application or patch version means the title was updated, so its metadata has to be retrieved again
+    return ((entry && entry->version == version && entry->patchVersion == patchVersion) ? entry : NULL);
+}
+
+// Removes decoded icons that don't belong to any installed base application
+static void pruneIconCache()
+{
+    if (!baseAppEntries || !titleAppCount) return;
+    
+    u32 i;
+    u64 titleID;
+    char *endPtr = NULL;
+    char iconPath[NAME_BUF_LEN] = {'\0'};
+    struct dirent *ent = NULL;
+    
+    u64 *titleIds = malloc(titleAppCount * sizeof(u64));
+    if (!titleIds) return;
+    
+    for(i = 0; i < titleAppCount; i++) titleIds[i] = baseAppEntries[i].titleId;
+    qsort(titleIds, titleAppCount, sizeof(u64), titleIdCmp);
+    
+    DIR *dir = opendir(ICON_CACHE_PATH);
+    if (dir)
+    {
+        while((ent = readdir(dir)) != NULL)
+        {
+            // Only look at "<titleID>.bin" files
+            if (strlen(ent->d_name) != 20 || strcasecmp(ent->d_name + 16, ".bin") != 0) continue;
+            
+            titleID = strtoull(ent->d_name, &endPtr, 16);
+            if (endPtr != (ent->d_name + 16)) continue;
+            
+            if (bsearch(&titleID, titleIds, titleAppCount, sizeof(u64), titleIdCmp)) continue;
+            
+            snprintf(iconPath, MAX_CHARACTERS(iconPath), "%s%s", ICON_CACHE_PATH, ent->d_name);
+            remove(iconPath);
+        }
+        
+        closedir(dir);
+    }
+    
+    free(titleIds);
+}
+
+static void saveTitleMetadataCache(u64 languageCode)
 {
-    if (menuType != MENUTYPE_GAMECARD || (metaType != NcmContentMetaType_Patch && metaType != NcmContentMetaType_AddOnContent) || (metaType == NcmContentMetaType_Patch && (!titlePatchCount || !gameCardSdCardEmmcPatchCount)) || (metaType == NcmContentMetaType_AddOnContent && (!titleAddOnCount || !gameCardSdCardEmmcAddOnCount))) return;
+    u32 i, entryCount = 0;
+    title_cache_entry *entries = NULL;
+    title_cache_header header;
     
-    patch_addon_ctx_t *tmpPatchAddOnEntries = NULL;
+    if (!baseAppEntries || !titleAppCount) return;
     
-    if (metaType == NcmContentMetaType_Patch)
+    // Both caches are only rewritten from the SD card / eMMC title list, which holds every installed base application
+    pruneIconCache();
+    
+    entries = calloc(titleAppCount, sizeof(title_cache_entry));
+    if (!entries) return;
+    
+    for(i = 0; i < titleAppCount; i++)
     {
-        if ((titlePatchCount - gameCardSdCardEmmcPatchCount) > 0)
-        {
-            tmpPatchAddOnEntries = realloc(patchEntries, (titlePatchCount - gameCardSdCardEmmcPatchCount) * sizeof(patch_addon_ctx_t));
-            if (tmpPatchAddOnEntries != NULL)
-            {
-                patchEntries = tmpPatchAddOnEntries;
-                tmpPatchAddOnEntries = NULL;
-            }
-        } else {
-            free(patchEntries);
-            patchEntries = NULL;
-        }
-        
-        titlePatchCount -= gameCardSdCardEmmcPatchCount;
-        
-        gameCardSdCardEmmcPatchCount = 0;
-        sdCardTitlePatchCount = 0;
-        emmcTitlePatchCount = 0;
-    } else {
-        if ((titleAddOnCount - gameCardSdCardEmmcAddOnCount) > 0)
-        {
-            tmpPatchAddOnEntries = realloc(addOnEntries, (titleAddOnCount - gameCardSdCardEmmcAddOnCount) * sizeof(patch_addon_ctx_t));
-            if (tmpPatchAddOnEntries != NULL)
-            {
-                addOnEntries = tmpPatchAddOnEntries;
-                tmpPatchAddOnEntries = NULL;
-            }
-        } else {
-            free(addOnEntries);
-            addOnEntries = NULL;
-        }
+        // Titles without a name are retried on the next run
+        if (!strlen(baseAppEntries[i].name)) continue;
         
-        titleAddOnCount -= gameCardSdCardEmmcAddOnCount;
+        entries[entryCount].titleId = baseAppEntries[i].titleId;
+        entries[entryCount].version = baseAppEntries[i].version;
+        entries[entryCount].patchVersion = baseAppEntries[i].patchVersion;
+        entries[entryCount].storageId = (u8)baseAppEntries[i].storageId;
+        entries[entryCount].contentSize = baseAppEntries[i].contentSize;
+        snprintf(entries[entryCount].name, MAX_CHARACTERS(entries[entryCount].name), "%s", baseAppEntries[i].name);
+        snprintf(entries[entryCount].author, MAX_CHARACTERS(entries[entryCount].author), "%s", baseAppEntries[i].author);
         
-        gameCardSdCardEmmcAddOnCount = 0;
-        sdCardTitleAddOnCount = 0;
-        emmcTitleAddOnCount = 0;
+        entryCount++;
+    }
+    
+    if (!entryCount)
+    {
+        free(entries);
+        remove(TITLE_CACHE_PATH);
+        return;
+    }
+    
+    qsort(entries, entryCount, sizeof(title_cache_entry), titleCacheEntryCmp);
+    
+    memset(&header, 0, sizeof(title_cache_header));
+    header.magic = __builtin_bswap32(TITLE_CACHE_MAGIC);
+    header.version = TITLE_CACHE_VERSION;
+    header.languageCode = languageCode;
+    header.entryCount = entryCount;
+    
+    bool success = false;
+    
+    FILE *cacheFile = fopen(TITLE_CACHE_PATH, "wb");
+    if (cacheFile)
+    {
+        success = (fwrite(&header, 1, sizeof(title_cache_header), cacheFile) == sizeof(title_cache_header) && fwrite(entries, sizeof(title_cache_entry), entryCount, cacheFile) == entryCount);
+        fclose(cacheFile);
     }
+    
+    if (!success) remove(TITLE_CACHE_PATH);
+    
+    free(entries);
 }
 
 static bool getCachedBaseApplicationNacpMetadata(u64 titleID, char *nameBuf, size_t nameBufSize, char *authorBuf, size_t authorBufSize, u8 **iconBuf)
@@ -1869,6 +2875,16 @@ bool retrieveGameCardInfo()
         }
     }
     
+    // Mismatches aren't fatal here, they're reported by the HFS0 dump and verification functions
+    checkHfs0HeaderHashes(false);
+    
+    // Index the secure HFS0 partition filenames. Every gamecard NCA read looks up its file entry by name
+    if (!buildHfs0FilenameIndex(gameCardInfo.hfs0PartitionCnt - 1, &(gameCardInfo.secureHfs0Index)))
+    {
+        uiStatusMsg("%s: unable to build filename index for the secure HFS0 partition!", __func__);
+        goto out;
+    }
+    
     // Get bundled FW version update
     result = fsDeviceOperatorUpdatePartitionInfo(&(gameCardInfo.fsOperatorInstance), &(gameCardInfo.fsGameCardHandle), &(gameCardInfo.updateVersion), &(gameCardInfo.updateTitleId));
     if (R_SUCCEEDED(result))
@@ -1993,28 +3009,69 @@ void loadTitleInfo()
     
     if (proceed)
     {
-        u32 i, ncmTitleCount;
+        u32 i, ncmTitleCount, cachedTitleCount = 0;
+        
+        // Metadata for installed titles is kept in the SD card, so only new or updated titles need to go through ns
+        bool useCache = (menuType == MENUTYPE_SDCARD_EMMC), updateCache = false;
+        u64 languageCode = 0;
+        
+        if (useCache)
+        {
+            languageCode = getSystemLanguageCode();
+            loadTitleMetadataCache(languageCode);
+        }
         
         for(i = 0; i < titleAppCount; i++)
         {
-            // Retrieve base application name, author and icon
-            if (getCachedBaseApplicationNacpMetadata(baseAppEntries[i].titleId, baseAppEntries[i].name, MAX_CHARACTERS(baseAppEntries[i].name), baseAppEntries[i].author, MAX_CHARACTERS(baseAppEntries[i].author), &(baseAppEntries[i].icon)))
+            baseAppEntries[i].patchVersion = getHighestPatchVersionFromBaseApplication(i);
+            
+            title_cache_entry *cachedEntry = (useCache ? getTitleMetadataCacheEntry(baseAppEntries[i].titleId, baseAppEntries[i].version, baseAppEntries[i].patchVersion, baseAppEntries[i].storageId) : NULL);
+            
+            if (cachedEntry)
             {
-                strtrim(baseAppEntries[i].name);
-                strtrim(baseAppEntries[i].author);
+                snprintf(baseAppEntries[i].name, MAX_CHARACTERS(baseAppEntries[i].name), "%s", cachedEntry->name);
+                snprintf(baseAppEntries[i].author, MAX_CHARACTERS(baseAppEntries[i].author), "%s", cachedEntry->author);
                 snprintf(baseAppEntries[i].fixedName, MAX_CHARACTERS(baseAppEntries[i].fixedName), baseAppEntries[i].name);
                 removeIllegalCharacters(baseAppEntries[i].fixedName);
+                
+                baseAppEntries[i].contentSize = cachedEntry->contentSize;
+                
+                cachedTitleCount++;
+            } else {
+                // Retrieve base application name and author
+                // Icons are decoded later by the icon worker threads, and only for the titles that get displayed
+                if (getCachedBaseApplicationNacpMetadata(baseAppEntries[i].titleId, baseAppEntries[i].name, MAX_CHARACTERS(baseAppEntries[i].name), baseAppEntries[i].author, MAX_CHARACTERS(baseAppEntries[i].author), NULL))
+                {
+                    strtrim(baseAppEntries[i].name);
+                    strtrim(baseAppEntries[i].author);
+                    snprintf(baseAppEntries[i].fixedName, MAX_CHARACTERS(baseAppEntries[i].fixedName), baseAppEntries[i].name);
+                    removeIllegalCharacters(baseAppEntries[i].fixedName);
+                }
+                
+                // Retrieve base application content size
+                ncmTitleCount = (baseAppEntries[i].storageId == NcmStorageId_GameCard ? titleAppCount : (baseAppEntries[i].storageId == NcmStorageId_SdCard ? sdCardTitleAppCount : emmcTitleAppCount));
+                baseAppEntries[i].contentSize = calculateSizeFromContentRecords(baseAppEntries[i].storageId, NcmContentMetaType_Application, ncmTitleCount, baseAppEntries[i].ncmIndex);
+                
+                updateCache = true;
             }
             
-            // Retrieve base application content size
-            ncmTitleCount = (baseAppEntries[i].storageId == NcmStorageId_GameCard ? titleAppCount : (baseAppEntries[i].storageId == NcmStorageId_SdCard ? sdCardTitleAppCount : emmcTitleAppCount));
-            baseAppEntries[i].contentSize = calculateSizeFromContentRecords(baseAppEntries[i].storageId, NcmContentMetaType_Application, ncmTitleCount, baseAppEntries[i].ncmIndex);
             convertSize(baseAppEntries[i].contentSize, baseAppEntries[i].contentSizeStr, MAX_CHARACTERS(baseAppEntries[i].contentSizeStr));
         }
         
+        if (useCache)
+        {
+            // Also rewrite the cache if titles were removed since it was last saved
+            if (updateCache || cachedTitleCount != titleCacheEntryCount) saveTitleMetadataCache(languageCode);
+            freeTitleMetadataCache();
+        }
+        
         // Sort base applications by name
         if (titleAppCount) qsort(baseAppEntries, titleAppCount, sizeof(base_app_ctx_t), baseAppCmp);
         
+        // Map each base application to its patches and add-ons
+        freeTitleIndex();
+        loadTitleIndex();
+        
         for(i = 0; i < titlePatchCount; i++)
         {
             // Retrieve patch content size
@@ -2130,6 +3187,31 @@ bool getHfs0FileList(u32 partition)
     return true;
 }
 
+// Looks up a Secure HFS0 partition file entry through the filename index
+bool getSecureHfs0FileEntryByName(const char *filename, hfs0_file_entry *outEntry)
+{
+    if (!gameCardInfo.hfs0PartitionCnt || !gameCardInfo.hfs0Partitions || !gameCardInfo.hfs0Partitions[gameCardInfo.hfs0PartitionCnt - 1].header || !gameCardInfo.secureHfs0Index.buckets || !gameCardInfo.secureHfs0Index.bucket_cnt || !filename || !strlen(filename) || !outEntry) return false;
+    
+    u32 partition = (gameCardInfo.hfs0PartitionCnt - 1); // Select the Secure HFS0 partition
+    u32 file_cnt = gameCardInfo.hfs0Partitions[partition].file_cnt;
+    
+    u8 *entry_table = (gameCardInfo.hfs0Partitions[partition].header + sizeof(hfs0_header));
+    char *str_table = (char*)(entry_table + (file_cnt * sizeof(hfs0_file_entry)));
+    
+    hfs0_filename_index *index = &(gameCardInfo.secureHfs0Index);
+    u32 bucket = (hashFilename(filename) & (index->bucket_cnt - 1));
+    
+    while(index->buckets[bucket])
+    {
+        memcpy(outEntry, entry_table + ((index->buckets[bucket] - 1) * sizeof(hfs0_file_entry)), sizeof(hfs0_file_entry));
+        if (!strcasecmp(str_table + outEntry->filename_offset, filename)) return true;
+        
+        bucket = ((bucket + 1) & (index->bucket_cnt - 1));
+    }
+    
+    return false;
+}
+
 // Used to retrieve data from files in the HFS0 Secure partition
 // An IStorage instance must have been opened beforehand
 bool readFileFromSecureHfs0PartitionByName(const char *filename, u64 offset, void *outBuf, size_t bufSize)
@@ -2140,49 +3222,199 @@ bool readFileFromSecureHfs0PartitionByName(const char *filename, u64 offset, voi
         return false;
     }
     
-    u32 i;
     Result result;
     hfs0_file_entry entry;
     
-    bool proceed = true, found = false;
-    
     u32 partition = (gameCardInfo.hfs0PartitionCnt - 1); // Select the Secure HFS0 partition
     
-    for(i = 0; i < gameCardInfo.hfs0Partitions[partition].file_cnt; i++)
+    if (!getSecureHfs0FileEntryByName(filename, &entry))
     {
-        memcpy(&entry, gameCardInfo.hfs0Partitions[partition].header + sizeof(hfs0_header) + (i * sizeof(hfs0_file_entry)), sizeof(hfs0_file_entry));
-        
-        char *cur_filename = (char*)(gameCardInfo.hfs0Partitions[partition].header + sizeof(hfs0_header) + (gameCardInfo.hfs0Partitions[partition].file_cnt * sizeof(hfs0_file_entry)) + entry.filename_offset);
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to find file \"%s\" in Secure HFS0 partition!", __func__, filename);
+        return false;
+    }
+    
+    if (!entry.file_size || (offset + bufSize) > entry.file_size)
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: invalid file size for \"%s\"!", __func__, filename);
+        return false;
+    }
+    
+    result = readGameCardStoragePartition(gameCardInfo.hfs0Partitions[partition].header_size + entry.file_offset + offset, outBuf, bufSize);
+    if (R_FAILED(result))
+    {
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: failed to read file \"%s\"! (0x%08X)", __func__, filename, result);
+        return false;
+    }
+    
+    return true;
+}
+
+static bool checkHfs0HeaderHash(openIStoragePartition storageIndex, u64 offset, const u8 *data, u64 dataSize, u64 hashedSize, const u8 *expectedHash)
+{
+    Result result;
+    Sha256Context sha_ctx;
+    u8 hash[SHA256_HASH_SIZE];
+    u8 *buf = NULL;
+    u64 off, n = GAMECARD_READ_AHEAD_WINDOW_SIZE;
+    
+    if (!hashedSize || !expectedHash) return false;
+    
+    // Use the header we already have in memory if it covers the whole hashed region
+    if (data && hashedSize <= dataSize)
+    {
+        sha256CalculateHash(hash, data, hashedSize);
+        return !memcmp(hash, expectedHash, SHA256_HASH_SIZE);
+    }
+    
+    result = openGameCardStoragePartition(storageIndex);
+    if (R_FAILED(result)) return false;
+    
+    buf = malloc(hashedSize > n ? n : hashedSize);
+    if (!buf) return false;
+    
+    sha256ContextCreate(&sha_ctx);
+    
+    for(off = 0; off < hashedSize; off += n)
+    {
+        if (n > (hashedSize - off)) n = (hashedSize - off);
         
-        if (strncasecmp(cur_filename, filename, strlen(filename)) != 0) continue;
+        result = readGameCardStoragePartition(offset + off, buf, n);
+        if (R_FAILED(result)) break;
         
-        found = true;
+        sha256ContextUpdate(&sha_ctx, buf, n);
+    }
+    
+    free(buf);
+    
+    if (off < hashedSize) return false;
+    
+    sha256ContextGetHash(&sha_ctx, hash);
+    
+    return !memcmp(hash, expectedHash, SHA256_HASH_SIZE);
+}
+
+// Checks the root HFS0 header and every partition header against their hashes
+// If readFromGameCard is false, the headers read by retrieveGameCardInfo() are used whenever possible
+bool checkHfs0HeaderHashes(bool readFromGameCard)
+{
+    if (!gameCardInfo.rootHfs0Header || !gameCardInfo.hfs0PartitionCnt || !gameCardInfo.hfs0Partitions) return false;
+    
+    u32 i;
+    hfs0_file_entry entry;
+    bool success = true;
+    openIStoragePartition prevStorageIndex = gameCardInfo.curIStorageIndex;
+    
+    gameCardInfo.rootHfs0HeaderHashValid = checkHfs0HeaderHash(ISTORAGE_PARTITION_NORMAL, gameCardInfo.header.rootHfs0HeaderOffset, (readFromGameCard ? NULL : gameCardInfo.rootHfs0Header), gameCardInfo.header.rootHfs0HeaderSize, gameCardInfo.header.rootHfs0HeaderSize, gameCardInfo.header.rootHfs0HeaderHash);
+    if (!gameCardInfo.rootHfs0HeaderHashValid) success = false;
+    
+    for(i = 0; i < gameCardInfo.hfs0PartitionCnt; i++)
+    {
+        memcpy(&entry, gameCardInfo.rootHfs0Header + sizeof(hfs0_header) + (i * sizeof(hfs0_file_entry)), sizeof(hfs0_file_entry));
         
-        if (!entry.file_size || (offset + bufSize) > entry.file_size)
-        {
-            uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: invalid file size for \"%s\"!", __func__, filename);
-            proceed = false;
-        }
+        // The secure HFS0 partition is stored at the start of the secure IStorage partition
+        openIStoragePartition storageIndex = (i == (gameCardInfo.hfs0PartitionCnt - 1) ? ISTORAGE_PARTITION_SECURE : ISTORAGE_PARTITION_NORMAL);
         
-        break;
+        gameCardInfo.hfs0Partitions[i].header_hash_valid = checkHfs0HeaderHash(storageIndex, gameCardInfo.hfs0Partitions[i].offset, (readFromGameCard ? NULL : gameCardInfo.hfs0Partitions[i].header), gameCardInfo.hfs0Partitions[i].header_size, entry.hashed_region_size, entry.hashed_region_sha256);
+        if (!gameCardInfo.hfs0Partitions[i].header_hash_valid) success = false;
     }
     
-    if (!proceed || !found)
+    // Restore the IStorage partition the caller was using
+    if (prevStorageIndex && prevStorageIndex < ISTORAGE_PARTITION_INVALID && gameCardInfo.curIStorageIndex != prevStorageIndex) openGameCardStoragePartition(prevStorageIndex);
+    
+    return success;
+}
+
+static void finishHfs0FileHash(hfs0_hash_ctx_t *ctx, u32 fileIndex, const hfs0_file_entry *entry)
+{
+    u8 hash[SHA256_HASH_SIZE];
+    
+    sha256ContextGetHash(&(ctx->files[fileIndex].sha_ctx), hash);
+    
+    if (!memcmp(hash, entry->hashed_region_sha256, SHA256_HASH_SIZE))
+    {
+        ctx->files[fileIndex].status = HFS0_HASH_VALID;
+        ctx->verified_cnt++;
+    } else {
+        ctx->files[fileIndex].status = HFS0_HASH_INVALID;
+        if (!ctx->failed_cnt) ctx->first_failed_index = fileIndex;
+        ctx->failed_cnt++;
+    }
+}
+
+bool initHfs0HashContext(u32 partition, hfs0_hash_ctx_t *ctx)
+{
+    if (!gameCardInfo.hfs0PartitionCnt || partition >= gameCardInfo.hfs0PartitionCnt || !gameCardInfo.hfs0Partitions || !gameCardInfo.hfs0Partitions[partition].header || !gameCardInfo.hfs0Partitions[partition].file_cnt || !ctx)
     {
-        if (proceed && !found) uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to find file \"%s\" in Secure HFS0 partition!", __func__, filename);
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: invalid parameters to initialize HFS0 hash context!", __func__);
         return false;
     }
     
-    result = readGameCardStoragePartition(gameCardInfo.hfs0Partitions[partition].header_size + entry.file_offset + offset, outBuf, bufSize);
-    if (R_FAILED(result))
+    u32 i;
+    hfs0_file_entry entry;
+    
+    memset(ctx, 0, sizeof(hfs0_hash_ctx_t));
+    
+    ctx->files = calloc(gameCardInfo.hfs0Partitions[partition].file_cnt, sizeof(hfs0_hash_file_ctx_t));
+    if (!ctx->files)
     {
-        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: failed to read file \"%s\"! (0x%08X)", __func__, filename, result);
+        uiDrawString(STRING_X_POS, STRING_Y_POS(breaks), FONT_COLOR_ERROR_RGB, "%s: unable to allocate memory for the HFS0 hash context!", __func__);
         return false;
     }
     
+    ctx->partition = partition;
+    ctx->file_cnt = gameCardInfo.hfs0Partitions[partition].file_cnt;
+    
+    for(i = 0; i < ctx->file_cnt; i++)
+    {
+        sha256ContextCreate(&(ctx->files[i].sha_ctx));
+        
+        // Empty hashed regions can be checked right away
+        memcpy(&entry, gameCardInfo.hfs0Partitions[partition].header + sizeof(hfs0_header) + (i * sizeof(hfs0_file_entry)), sizeof(hfs0_file_entry));
+        if (!entry.hashed_region_size) finishHfs0FileHash(ctx, i, &entry);
+    }
+    
     return true;
 }
 
+// 'offset' is relative to the start of the HFS0 partition (header included)
+// Data for each hashed region must be fed in order. Chunks that skip part of a hashed region leave it unchecked
+void updateHfs0HashContext(hfs0_hash_ctx_t *ctx, u64 offset, const u8 *data, u64 size)
+{
+    if (!ctx || !ctx->files || !data || !size) return;
+    
+    u32 i;
+    hfs0_file_entry entry;
+    hfs0_partition_info *partition = &(gameCardInfo.hfs0Partitions[ctx->partition]);
+    
+    for(i = 0; i < ctx->file_cnt; i++)
+    {
+        if (ctx->files[i].status != HFS0_HASH_PENDING) continue;
+        
+        memcpy(&entry, partition->header + sizeof(hfs0_header) + (i * sizeof(hfs0_file_entry)), sizeof(hfs0_file_entry));
+        
+        u64 region_end = (partition->header_size + entry.file_offset + entry.hashed_region_size);
+        u64 region_pos = (partition->header_size + entry.file_offset + ctx->files[i].hashed_size);
+        
+        if (region_pos < offset || region_pos >= (offset + size)) continue;
+        
+        u64 hash_size = (((offset + size) < region_end ? (offset + size) : region_end) - region_pos);
+        
+        sha256ContextUpdate(&(ctx->files[i].sha_ctx), data + (region_pos - offset), hash_size);
+        ctx->files[i].hashed_size += hash_size;
+        
+        if (ctx->files[i].hashed_size >= entry.hashed_region_size) finishHfs0FileHash(ctx, i, &entry);
+    }
+}
+
+void freeHfs0HashContext(hfs0_hash_ctx_t *ctx)
+{
+    if (!ctx) return;
+    
+    if (ctx->files) free(ctx->files);
+    
+    memset(ctx, 0, sizeof(hfs0_hash_ctx_t));
+}
+
 bool calculateExeFsExtractedDataSize(u64 *out)
 {
     if (!exeFsContext.exefs_header.file_cnt || !exeFsContext.exefs_entries || !out)
@@ -2715,6 +3947,9 @@ bool readNcaExeFsSection(u32 titleIndex, bool usePatch)
         goto out;
     }
     
+    // Content paths resolved through a previous storage session can't be reused
+    invalidateNcaContentPathCache();
+    
     if (!readNcaDataByContentId(&ncmStorage, &ncaId, 0, ncaHeader, NCA_FULL_HEADER_LENGTH))
     {
         breaks++;
@@ -2884,6 +4119,9 @@ int readNcaRomFsSection(u32 titleIndex, selectedRomFsType curRomFsType, int desi
         goto out;
     }
     
+    // Content paths resolved through a previous storage session can't be reused
+    invalidateNcaContentPathCache();
+    
     if (!readNcaDataByContentId(&ncmStorage, &ncaId, 0, ncaHeader, NCA_FULL_HEADER_LENGTH))
     {
         breaks++;
@@ -3475,29 +4713,9 @@ u32 calculateOrphanPatchOrAddOnCount(bool addOn)
     
     if ((!titleAppCount || !baseAppEntries) && ((!addOn && titlePatchCount && patchEntries) || (addOn && titleAddOnCount && addOnEntries))) return (!addOn ? titlePatchCount : titleAddOnCount);
     
-    u32 i, j;
-    u32 titleCount = (!addOn ? titlePatchCount : titleAddOnCount);
-    u32 orphanCnt = 0;
-    
-    for(i = 0; i < titleCount; i++)
-    {
-        bool foundMatch = false;
-        
-        for(j = 0; j < titleAppCount; j++)
-        {
-            if ((!addOn && patchEntries[i].titleId == (baseAppEntries[j].titleId | APPLICATION_PATCH_BITMASK)) || (addOn && (addOnEntries[i].titleId & APPLICATION_ADDON_BITMASK) == (baseAppEntries[j].titleId & APPLICATION_ADDON_BITMASK)))
-            {
-                foundMatch = true;
-                break;
-            }
-        }
-        
-        if (foundMatch) continue;
-        
-        orphanCnt++;
-    }
+    if (!loadTitleIndex()) return 0;
     
-    return orphanCnt;
+    return (!addOn ? orphanPatchCnt : orphanAddOnCnt);
 }
 
 void generateOrphanPatchOrAddOnList()
@@ -3505,7 +4723,6 @@ void generateOrphanPatchOrAddOnList()
     Result result;
     u32 nsAppRecordCnt = 0;
     
-    bool foundMatch;
     u32 i, j, k;
     
     u32 orphanEntryIndex = 0;
@@ -3544,21 +4761,7 @@ void generateOrphanPatchOrAddOnList()
         
         for(j = 0; j < titleCount; j++)
         {
-            foundMatch = false;
-            
-            if (titleAppCount && baseAppEntries)
-            {
-                for(k = 0; k < titleAppCount; k++)
-                {
-                    if (checkIfPatchOrAddOnBelongsToBaseApplication(j, k, (i == 1)))
-                    {
-                        foundMatch = true;
-                        break;
-                    }
-                }
-            }
-            
-            if (foundMatch) continue;
+            if (checkIfPatchOrAddOnHasBaseApplication(j, (i == 1))) continue;
             
             patch_addon_ctx_t *ptr = (i == 0 ? &(patchEntries[j]) : &(addOnEntries[j]));
             
@@ -3610,17 +4813,7 @@ out:
 
 bool checkIfBaseApplicationHasPatchOrAddOn(u32 appIndex, bool addOn)
 {
-    if (!titleAppCount || !baseAppEntries || appIndex >= titleAppCount || (!addOn && (!titlePatchCount || !patchEntries)) || (addOn && (!titleAddOnCount || !addOnEntries))) return false;
-    
-    u32 i;
-    u32 count = (!addOn ? titlePatchCount : titleAddOnCount);
-    
-    for(i = 0; i < count; i++)
-    {
-        if ((!addOn && (baseAppEntries[appIndex].titleId | APPLICATION_PATCH_BITMASK) == patchEntries[i].titleId) || (addOn && (baseAppEntries[appIndex].titleId & APPLICATION_ADDON_BITMASK) == (addOnEntries[i].titleId & APPLICATION_ADDON_BITMASK))) return true;
-    }
-    
-    return false;
+    return (getPatchOrAddOnIndexRange(appIndex, addOn) != NULL);
 }
 
 bool checkIfPatchOrAddOnBelongsToBaseApplication(u32 titleIndex, u32 appIndex, bool addOn)
@@ -3634,72 +4827,74 @@ bool checkIfPatchOrAddOnBelongsToBaseApplication(u32 titleIndex, u32 appIndex, b
 
 u32 retrieveFirstPatchOrAddOnIndexFromBaseApplication(u32 appIndex, bool addOn)
 {
-    if (!titleAppCount || !baseAppEntries || appIndex >= titleAppCount || (!addOn && (!titlePatchCount || !patchEntries)) || (addOn && (!titleAddOnCount || !addOnEntries))) return 0;
+    title_index_range *range = getPatchOrAddOnIndexRange(appIndex, addOn);
+    if (!range) return 0;
     
-    u32 titleIndex;
-    u32 count = (!addOn ? titlePatchCount : titleAddOnCount);
-    
-    for(titleIndex = 0; titleIndex < count; titleIndex++)
-    {
-        if (checkIfPatchOrAddOnBelongsToBaseApplication(titleIndex, appIndex, addOn)) return titleIndex;
-    }
-    
-    return 0;
+    return (!addOn ? patchIndexEntries[range->start].index : addOnIndexEntries[range->start].index);
 }
 
 u32 retrievePreviousPatchOrAddOnIndexFromBaseApplication(u32 startTitleIndex, u32 appIndex, bool addOn)
 {
     u32 count = (!addOn ? titlePatchCount : titleAddOnCount);
-    u32 retTitleIndex = startTitleIndex;
-    u32 curTitleIndex = 0;
     
-    if (!startTitleIndex || startTitleIndex >= count || !titleAppCount || !baseAppEntries || appIndex >= titleAppCount || (!addOn && (!titlePatchCount || !patchEntries)) || (addOn && (!titleAddOnCount || !addOnEntries))) return retTitleIndex;
+    if (!startTitleIndex || startTitleIndex >= count) return startTitleIndex;
+    
+    title_index_range *range = getPatchOrAddOnIndexRange(appIndex, addOn);
+    if (!range) return startTitleIndex;
+    
+    title_index_entry *indexEntries = (!addOn ? patchIndexEntries : addOnIndexEntries);
+    u32 low = range->start, high = (range->start + range->count), mid;
     
-    for(curTitleIndex = startTitleIndex; curTitleIndex > 0; curTitleIndex--)
+    // Entries within a range are sorted by their index, so look for the first one at or past startTitleIndex
+    while(low < high)
     {
-        if (checkIfPatchOrAddOnBelongsToBaseApplication(curTitleIndex - 1, appIndex, addOn))
+        mid = (low + ((high - low) / 2));
+        
+        if (indexEntries[mid].index < startTitleIndex)
         {
-            retTitleIndex = (curTitleIndex - 1);
-            break;
+            low = (mid + 1);
+        } else {
+            high = mid;
         }
     }
     
-    return retTitleIndex;
+    return (low > range->start ? indexEntries[low - 1].index : startTitleIndex);
 }
 
 u32 retrieveNextPatchOrAddOnIndexFromBaseApplication(u32 startTitleIndex, u32 appIndex, bool addOn)
 {
     u32 count = (!addOn ? titlePatchCount : titleAddOnCount);
-    u32 retTitleIndex = startTitleIndex;
-    u32 curTitleIndex = 0;
     
-    if (startTitleIndex >= count || !titleAppCount || !baseAppEntries || appIndex >= titleAppCount || (!addOn && (!titlePatchCount || !patchEntries)) || (addOn && (!titleAddOnCount || !addOnEntries))) return retTitleIndex;
+    if (startTitleIndex >= count) return startTitleIndex;
+    
+    title_index_range *range = getPatchOrAddOnIndexRange(appIndex, addOn);
+    if (!range) return startTitleIndex;
     
-    for(curTitleIndex = (startTitleIndex + 1); curTitleIndex < count; curTitleIndex++)
+    title_index_entry *indexEntries = (!addOn ? patchIndexEntries : addOnIndexEntries);
+    u32 low = range->start, high = (range->start + range->count), mid;
+    
+    // Look for the first entry past startTitleIndex
+    while(low < high)
     {
-        if (checkIfPatchOrAddOnBelongsToBaseApplication(curTitleIndex, appIndex, addOn))
+        mid = (low + ((high - low) / 2));
+        
+        if (indexEntries[mid].index <= startTitleIndex)
         {
-            retTitleIndex = curTitleIndex;
-            break;
+            low = (mid + 1);
+        } else {
+            high = mid;
         }
     }
     
-    return retTitleIndex;
+    return (low < (range->start + range->count) ? indexEntries[low].index : startTitleIndex);
 }
 
 u32 retrieveLastPatchOrAddOnIndexFromBaseApplication(u32 appIndex, bool addOn)
 {
-    if (!titleAppCount || !baseAppEntries || appIndex >= titleAppCount || (!addOn && (!titlePatchCount || !patchEntries)) || (addOn && (!titleAddOnCount || !addOnEntries))) return 0;
+    title_index_range *range = getPatchOrAddOnIndexRange(appIndex, addOn);
+    if (!range) return 0;
     
-    u32 titleIndex;
-    u32 count = (!addOn ? titlePatchCount : titleAddOnCount);
-    
-    for(titleIndex = count; titleIndex > 0; titleIndex--)
-    {
-        if (checkIfPatchOrAddOnBelongsToBaseApplication(titleIndex - 1, appIndex, addOn)) return (titleIndex - 1);
-    }
-    
-    return 0;
+    return (!addOn ? patchIndexEntries[range->start + range->count - 1].index : addOnIndexEntries[range->start + range->count - 1].index);
 }
 
 void waitForButtonPress()
@@ -3834,6 +5029,20 @@ bool checkIfFileExists(const char *path)
     return false;
 }
 
+bool checkIfDirectoryExists(const char *path)
+{
+    if (!path || !strlen(path)) return false;
+    
+    DIR *chkdir = opendir(path);
+    if (chkdir)
+    {
+        closedir(chkdir);
+        return true;
+    }
+    
+    return false;
+}
+
 bool yesNoPrompt(const char *message)
 {
     if (message && strlen(message))
@@ -15,9 +15,13 @@
 #define ROMFS_DUMP_PATH                 APP_BASE_PATH "RomFS/"
 #define CERT_DUMP_PATH                  APP_BASE_PATH "Certificate/"
 #define BATCH_OVERRIDES_PATH            NSP_DUMP_PATH "BatchOverrides/"
+#define NCA_STORE_PATH                  NSP_DUMP_PATH "NCAStore/"
 #define TICKET_PATH                     APP_BASE_PATH "Ticket/"
+#define SAVE_DUMP_PATH                  APP_BASE_PATH "Save/"
 
 #define CONFIG_PATH                     APP_BASE_PATH "config.bin"
+#define TITLE_CACHE_PATH                APP_BASE_PATH "titlecache.bin"
+#define ICON_CACHE_PATH                 APP_BASE_PATH "IconCache/"
 #define NRO_NAME                        APP_TITLE ".nro"
 #define NRO_PATH                        APP_BASE_PATH NRO_NAME
 #define NSWDB_XML_PATH                  APP_BASE_PATH "NSWreleases.xml"
@@ -56,9 +60,10 @@
 
 #define GAMECARD_READ_BUFFER_SIZE       DUMP_BUFFER_SIZE                        // 4 MiB (4194304 bytes)
 
-#define NCA_CTR_BUFFER_SIZE             DUMP_BUFFER_SIZE                        // 4 MiB (4194304 bytes)
+#define GAMECARD_READ_AHEAD_WINDOW_SIZE (u64)0x10000                          // 64 KiB (65536 bytes)
+#define GAMECARD_READ_AHEAD_WINDOW_CNT  4
 
-#define NSP_XML_BUFFER_SIZE             (u64)0xA00000                           // 10 MiB (10485760 bytes)
+#define NCA_CTR_BUFFER_SIZE             DUMP_BUFFER_SIZE                        // 4 MiB (4194304 bytes)
 
 #define APPLICATION_PATCH_BITMASK       (u64)0x800
 #define APPLICATION_ADDON_BITMASK       (u64)0xFFFFFFFFFFFF0000
@@ -100,6 +105,16 @@
 
 #define NACP_ICON_SQUARE_DIMENSION      256
 #define NACP_ICON_DOWNSCALED            96
+#define NACP_ICON_DOWNSCALED_SIZE       (NACP_ICON_DOWNSCALED * NACP_ICON_DOWNSCALED * 3)      // RGB
+
+#define TITLE_CACHE_MAGIC               (u32)0x54434845                         // "TCHE"
+#define TITLE_CACHE_VERSION             3
+
+#define ICON_CACHE_MAGIC                (u32)0x49434845                         // "ICHE"
+
+#define ICON_CACHE_SLOT_CNT             32                                      // Decoded icons kept in memory (LRU)
+#define ICON_WORKER_THREAD_CNT          2
+#define ICON_LOOKAHEAD_ROWS             3                                       // Title list rows above/below the visible ones to decode in advance
 
 #define round_up(x, y)                  ((x) + (((y) - ((x) % (y))) % (y)))			// Aligns 'x' bytes to a 'y' bytes boundary
 
@@ -110,6 +125,7 @@
 #define MAX_CHARACTERS(x)               (MAX_ELEMENTS((x)) - 1)                     // Returns the max number of characters that can be stored in char array while also leaving space for a NULL terminator
 
 #define BIS_MOUNT_NAME                  "sys:"
+#define BIS_SAVE_DIR_NAME               BIS_MOUNT_NAME "/save"
 #define BIS_CERT_SAVE_NAME              BIS_MOUNT_NAME "/save/80000000000000e0"
 #define BIS_COMMON_TIK_SAVE_NAME        BIS_MOUNT_NAME "/save/80000000000000e1"
 #define BIS_PERSONALIZED_TIK_SAVE_NAME  BIS_MOUNT_NAME "/save/80000000000000e2"
@@ -148,6 +164,7 @@ typedef struct {
     u64 header_size;
     u32 file_cnt;
     u32 str_table_size;
+    bool header_hash_valid; // Partition header hashed region checked against its root HFS0 file entry
 } PACKED hfs0_partition_info;
 
 typedef enum {
@@ -157,6 +174,30 @@ typedef enum {
     ISTORAGE_PARTITION_INVALID
 } openIStoragePartition;
 
+// Open addressing hash table used to look up HFS0 file entries by name
+typedef struct {
+    u32 *buckets; // Holds file entry indexes plus one. Zero marks an empty bucket
+    u32 bucket_cnt; // Always a power of two
+} hfs0_filename_index;
+
+// Open addressing hash table used to look up directory entries by name
+typedef struct {
+    char *names; // NULL terminated names, stored back to back
+    u32 *name_offsets;
+    u32 name_cnt;
+    u32 *buckets; // Holds name indexes plus one. Zero marks an empty bucket
+    u32 bucket_cnt; // Always a power of two
+} dir_filename_index;
+
+// Cached MEDIA_UNIT_SIZE aligned window from the currently opened gamecard IStorage partition
+typedef struct {
+    bool valid;
+    u64 offset; // Always a multiple of GAMECARD_READ_AHEAD_WINDOW_SIZE
+    u64 size; // Smaller than GAMECARD_READ_AHEAD_WINDOW_SIZE only for the last window in the partition
+    u64 last_used;
+    u8 data[GAMECARD_READ_AHEAD_WINDOW_SIZE];
+} gamecard_read_ahead_window;
+
 typedef struct {
     FsDeviceOperator fsOperatorInstance;
     FsEventNotifier fsGameCardEventNotifier;
@@ -167,8 +208,10 @@ typedef struct {
     volatile bool isInserted;
     gamecard_header_t header;
     u8 *rootHfs0Header;
+    bool rootHfs0HeaderHashValid;
     u32 hfs0PartitionCnt;
     hfs0_partition_info *hfs0Partitions;
+    hfs0_filename_index secureHfs0Index;
     u64 size;
     char sizeStr[32];
     u64 trimmedSize;
@@ -182,17 +225,63 @@ typedef struct {
 typedef struct {
     u64 titleId;
     u32 version;
+    u32 patchVersion;               // Highest installed patch version, 0 if there's none
     u32 ncmIndex;
     NcmStorageId storageId;
     char name[NACP_APPNAME_LEN];
     char fixedName[NACP_APPNAME_LEN];
     char author[NACP_AUTHOR_LEN];
     char versionStr[VERSION_STR_LEN];
-    u8 *icon;
     u64 contentSize;
     char contentSizeStr[32];
 } base_app_ctx_t;
 
+typedef struct {
+    u32 magic;
+    u32 version;
+    u64 languageCode;
+    u32 entryCount;
+    u8 reserved[0xC];
+} PACKED title_cache_header;
+
+typedef struct {
+    u64 titleId;
+    u32 version;
+    u32 patchVersion;               // ns returns the NACP from the installed patch, if available
+    u8 storageId;
+    u8 reserved[0x7];
+    u64 contentSize;
+    char name[NACP_APPNAME_LEN];
+    char author[NACP_AUTHOR_LEN];
+} PACKED title_cache_entry;
+
+// Header for each decoded icon file in ICON_CACHE_PATH, followed by NACP_ICON_DOWNSCALED_SIZE bytes
+// Icons are keyed like title cache entries, but kept in separate files so only the displayed ones have to be read
+typedef struct {
+    u32 magic;
+    u32 version;
+    u32 patchVersion;
+    u32 reserved;
+    u64 languageCode;
+} PACKED icon_cache_header;
+
+typedef enum {
+    ICON_SLOT_EMPTY = 0,
+    ICON_SLOT_PENDING,
+    ICON_SLOT_LOADING,
+    ICON_SLOT_READY,
+    ICON_SLOT_FAILED
+} iconSlotState;
+
+typedef struct {
+    u64 titleId;
+    u32 version;
+    u32 patchVersion;
+    iconSlotState state;
+    u64 lastUsed;
+    u8 *icon;                       // NACP_ICON_DOWNSCALED_SIZE bytes, allocated once
+} icon_cache_slot;
+
 typedef struct {
     u64 titleId;
     u32 version;
@@ -211,6 +300,16 @@ typedef struct {
     char orphanListStr[NACP_APPNAME_LEN * 2];
 } orphan_patch_addon_entry;
 
+typedef struct {
+    u64 key;    // Patch Title ID or masked add-on Title ID
+    u32 index;  // Index into patchEntries / addOnEntries
+} title_index_entry;
+
+typedef struct {
+    u32 start;
+    u32 count;
+} title_index_range;
+
 typedef struct {
     u32 magic;
     u32 file_cnt;
@@ -227,6 +326,28 @@ typedef struct {
     u8 hashed_region_sha256[0x20];
 } PACKED hfs0_file_entry;
 
+typedef enum {
+    HFS0_HASH_PENDING = 0,
+    HFS0_HASH_VALID,
+    HFS0_HASH_INVALID
+} hfs0HashStatus;
+
+typedef struct {
+    Sha256Context sha_ctx;
+    u64 hashed_size; // Hashed region bytes fed so far
+    hfs0HashStatus status;
+} hfs0_hash_file_ctx_t;
+
+// Checks the hashed region of every file in a HFS0 partition as its data is fed in order
+typedef struct {
+    u32 partition;
+    u32 file_cnt;
+    hfs0_hash_file_ctx_t *files;
+    u32 verified_cnt;
+    u32 failed_cnt;
+    u32 first_failed_index;
+} hfs0_hash_ctx_t;
+
 typedef struct {
     int line_offset;
     u64 totalSize;
@@ -309,6 +430,7 @@ typedef struct {
 typedef struct {
     bool isFat32;
     bool useLayeredFSDir;
+    bool verifyHashes;
 } PACKED ncaFsOptions;
 
 typedef struct {
@@ -320,6 +442,21 @@ typedef struct {
     ncaFsOptions romFsDumpCfg;
 } PACKED dumpOptions;
 
+// ncaFsOptions layout used before the verifyHashes field was added, kept to migrate older configuration files
+typedef struct {
+    bool isFat32;
+    bool useLayeredFSDir;
+} PACKED legacyNcaFsOptions;
+
+typedef struct {
+    xciOptions xciDumpCfg;
+    nspOptions nspDumpCfg;
+    batchOptions batchDumpCfg;
+    ticketOptions tikDumpCfg;
+    legacyNcaFsOptions exeFsDumpCfg;
+    legacyNcaFsOptions romFsDumpCfg;
+} PACKED legacyDumpOptions;
+
 void loadConfig();
 void saveConfig();
 
@@ -371,12 +508,23 @@ void strtrim(char *str);
 
 void loadTitleInfo();
 
+u8 *getBaseApplicationIcon(u32 appIndex);
+bool checkIfBaseApplicationIconsUpdated();
+
 void truncateBrowserEntryName(char *str);
 
 bool getHfs0FileList(u32 partition);
 
+bool getSecureHfs0FileEntryByName(const char *filename, hfs0_file_entry *outEntry);
+
 bool readFileFromSecureHfs0PartitionByName(const char *filename, u64 offset, void *outBuf, size_t bufSize);
 
+bool checkHfs0HeaderHashes(bool readFromGameCard);
+
+bool initHfs0HashContext(u32 partition, hfs0_hash_ctx_t *ctx);
+void updateHfs0HashContext(hfs0_hash_ctx_t *ctx, u64 offset, const u8 *data, u64 size);
+void freeHfs0HashContext(hfs0_hash_ctx_t *ctx);
+
 bool calculateExeFsExtractedDataSize(u64 *out);
 
 bool calculateRomFsFullExtractedSize(bool usePatch, u64 *out);
@@ -429,6 +577,14 @@ void convertDataToHexString(const u8 *data, const u32 dataSize, char *outBuf, co
 
 bool checkIfFileExists(const char *path);
 
+bool checkIfDirectoryExists(const char *path);
+
+bool buildDirectoryFilenameIndex(const char *path, dir_filename_index *index);
+
+bool checkDirectoryFilenameIndex(const dir_filename_index *index, const char *filename);
+
+void freeDirectoryFilenameIndex(dir_filename_index *index);
+
 bool yesNoPrompt(const char *message);
 
 bool checkIfDumpedXciContainsCertificate(const char *xciPath);
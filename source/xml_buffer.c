@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+
+#include "xml_buffer.h"
+
+static bool xmlBufferReserve(xml_buffer_t *buf, u64 len)
+{
+    if (!buf || buf->error) return false;
+    
+    // Always leave room for the NULL terminator
+    u64 required = (buf->size + len + 1);
+    if (required <= buf->capacity) return true;
+    
+    u64 newCapacity = (buf->capacity ? buf->capacity : XML_BUFFER_INITIAL_SIZE);
+    while(newCapacity < required) newCapacity *= 2;
+    
+    char *tmpData = realloc(buf->data, newCapacity);
+    if (!tmpData)
+    {
+        buf->error = true;
+        return false;
+    }
+    
+    buf->data = tmpData;
+    buf->capacity = newCapacity;
+    
+    return true;
+}
+
+bool xmlBufferInit(xml_buffer_t *buf)
+{
+    if (!buf) return false;
+    
+    memset(buf, 0, sizeof(xml_buffer_t));
+    
+    if (!xmlBufferReserve(buf, XML_BUFFER_INITIAL_SIZE - 1)) return false;
+    
+    buf->data[0] = '\0';
+    
+    return true;
+}
+
+void xmlBufferFree(xml_buffer_t *buf)
+{
+    if (!buf) return;
+    
+    if (buf->data) free(buf->data);
+    
+    memset(buf, 0, sizeof(xml_buffer_t));
+}
+
+void xmlBufferClear(xml_buffer_t *buf)
+{
+    if (!buf) return;
+    
+    buf->size = 0;
+    buf->error = false;
+    
+    if (buf->data) buf->data[0] = '\0';
+}
+
+void xmlBufferAppendData(xml_buffer_t *buf, const char *str, u64 len)
+{
+    if (!str || !len || !xmlBufferReserve(buf, len)) return;
+    
+    memcpy(buf->data + buf->size, str, len);
+    buf->size += len;
+    buf->data[buf->size] = '\0';
+}
+
+void xmlBufferAppend(xml_buffer_t *buf, const char *str)
+{
+    if (!str) return;
+    xmlBufferAppendData(buf, str, strlen(str));
+}
+
+void xmlBufferAppendFormatted(xml_buffer_t *buf, const char *fmt, ...)
+{
+    if (!fmt || !xmlBufferReserve(buf, 0)) return;
+    
+    int len;
+    u64 available = (buf->capacity - buf->size);
+    
+    va_list args;
+    
+    // Try to print straight into the free space first, and only grow the buffer if it wasn't enough
+    va_start(args, fmt);
+    len = vsnprintf(buf->data + buf->size, available, fmt, args);
+    va_end(args);
+    
+    if (len < 0)
+    {
+        buf->data[buf->size] = '\0';
+        buf->error = true;
+        return;
+    }
+    
+    if ((u64)len >= available)
+    {
+        if (!xmlBufferReserve(buf, (u64)len))
+        {
+            buf->data[buf->size] = '\0';
+            return;
+        }
+        
+        va_start(args, fmt);
+        vsnprintf(buf->data + buf->size, buf->capacity - buf->size, fmt, args);
+        va_end(args);
+    }
+    
+    buf->size += (u64)len;
+}
+
+void xmlBufferAppendEscaped(xml_buffer_t *buf, const char *str, u64 len)
+{
+    if (!str || !len) return;
+    
+    u64 i, start = 0;
+    const char *entity;
+    
+    for(i = 0; i < len && str[i] != '\0'; i++)
+    {
+        switch(str[i])
+        {
+            case '&':
+                entity = "&amp;";
+                break;
+            case '<':
+                entity = "&lt;";
+                break;
+            case '>':
+                entity = "&gt;";
+                break;
+            case '"':
+                entity = "&quot;";
+                break;
+            case '\'':
+                entity = "&apos;";
+                break;
+            default:
+                continue;
+        }
+        
+        xmlBufferAppendData(buf, str + start, i - start);
+        xmlBufferAppend(buf, entity);
+        start = (i + 1);
+    }
+    
+    xmlBufferAppendData(buf, str + start, i - start);
+}
+
+char *xmlBufferDetach(xml_buffer_t *buf, u64 *outSize)
+{
+    if (!buf || buf->error || !buf->data) return NULL;
+    
+    char *data = buf->data;
+    if (outSize) *outSize = buf->size;
+    
+    memset(buf, 0, sizeof(xml_buffer_t));
+    
+    return data;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#ifndef __XML_BUFFER_H__
+#define __XML_BUFFER_H__
+
+#include <switch/types.h>
+
+#define XML_BUFFER_INITIAL_SIZE     (u64)0x10000    // 64 KiB (65536 bytes). Doubled every time more room is needed
+
+// Length-tracking append buffer used to generate XML files
+// Appends never rescan the existing data. Allocation errors are sticky, so callers can check "error" once after generating the whole file
+typedef struct {
+    char *data;
+    u64 size;
+    u64 capacity;
+    bool error;
+} xml_buffer_t;
+
+bool xmlBufferInit(xml_buffer_t *buf);
+
+void xmlBufferFree(xml_buffer_t *buf);
+
+void xmlBufferClear(xml_buffer_t *buf);
+
+void xmlBufferAppendData(xml_buffer_t *buf, const char *str, u64 len);
+
+void xmlBufferAppend(xml_buffer_t *buf, const char *str);
+
+void xmlBufferAppendFormatted(xml_buffer_t *buf, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+// Replaces '&', '<', '>', '"' and '\'' with their XML entities. Stops at "len" bytes or at the first NULL terminator, whichever comes first
+void xmlBufferAppendEscaped(xml_buffer_t *buf, const char *str, u64 len);
+
+// Hands the generated data over to the caller, who becomes responsible for freeing it
+char *xmlBufferDetach(xml_buffer_t *buf, u64 *outSize);
+
+#endif